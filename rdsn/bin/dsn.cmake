@@ -55,6 +55,10 @@ message(STATUS "ENABLE_GPERF = ${ENABLE_GPERF}")
 option(USE_JEMALLOC "Use jemalloc" OFF)
 message(STATUS "USE_JEMALLOC = ${USE_JEMALLOC}")
 
+# Build the io_uring based aio provider, which requires liburing.
+option(ENABLE_IO_URING "Enable io_uring_aio_provider" OFF)
+message(STATUS "ENABLE_IO_URING = ${ENABLE_IO_URING}")
+
 if(ENABLE_GPERF AND USE_JEMALLOC)
     message(FATAL_ERROR "cannot enable both gperftools and jemalloc simultaneously")
 endif()
@@ -347,6 +351,16 @@ function(dsn_setup_system_libs)
         add_definitions(-DDSN_USE_JEMALLOC)
     endif()
 
+    if(ENABLE_IO_URING)
+        find_library(URING_LIB NAMES uring)
+        if(URING_LIB)
+            set(DSN_SYSTEM_LIBS ${DSN_SYSTEM_LIBS} ${URING_LIB})
+            add_definitions(-DDSN_HAS_IO_URING)
+        else()
+            message(WARNING "liburing is not found, io_uring_aio_provider is disabled")
+        endif()
+    endif()
+
     set(DSN_SYSTEM_LIBS
         ${DSN_SYSTEM_LIBS}
         ${CMAKE_THREAD_LIBS_INIT} # the thread library found by FindThreads
@@ -122,6 +122,12 @@ private:
         _last_write_next_committed = false;
     }
 
+    virtual void append_new_buffer(const blob &bb) override
+    {
+        commit_buffer();
+        _msg->write_append(bb);
+    }
+
 private:
     message_ex *_msg;
     bool _last_write_next_committed;
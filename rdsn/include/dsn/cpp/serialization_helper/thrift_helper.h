@@ -71,6 +71,8 @@ public:
         return (uint32_t)l;
     }
 
+    binary_reader &reader() { return _reader; }
+
 private:
     binary_reader &_reader;
 };
@@ -91,6 +93,8 @@ public:
         _writer.write((const char *)buf, static_cast<int>(len));
     }
 
+    binary_writer &writer() { return _writer; }
+
 private:
     binary_writer &_writer;
 };
@@ -454,6 +458,35 @@ inline uint32_t blob::read(apache::thrift::protocol::TProtocol *iprot)
     // for optimization, it is dangerous if the oprot is not a binary proto
     apache::thrift::protocol::TBinaryProtocol *binary_proto =
         static_cast<apache::thrift::protocol::TBinaryProtocol *>(iprot);
+
+    // a large blob read from a binary_reader is sliced out of the reader's buffer (usually the
+    // received message) rather than copied
+    auto reader_trans = dynamic_cast<binary_reader_transport *>(iprot->getTransport().get());
+    if (reader_trans != nullptr &&
+        dynamic_cast<apache::thrift::protocol::TBinaryProtocol *>(iprot) != nullptr) {
+        int32_t size = 0;
+        uint32_t xfer = binary_proto->readI32(size);
+        if (dsn_unlikely(size < 0)) {
+            throw apache::thrift::protocol::TProtocolException(
+                apache::thrift::protocol::TProtocolException::NEGATIVE_SIZE);
+        }
+        binary_reader &reader = reader_trans->reader();
+        if (dsn_unlikely(size > reader.get_remaining_size())) {
+            throw TTransportException(TTransportException::END_OF_FILE,
+                                      "no more data to read after end-of-buffer");
+        }
+        blob_string str(*this);
+        if (size >= binary_writer::nocopy_min_bytes) {
+            reader.read(*this, size);
+        } else if (size == 0) {
+            str.clear();
+        } else {
+            str.resize(size);
+            reader.read(&str[0], size);
+        }
+        return xfer + static_cast<uint32_t>(size);
+    }
+
     blob_string str(*this);
     return binary_proto->readString<blob_string>(str);
 }
@@ -462,6 +495,18 @@ inline uint32_t blob::write(apache::thrift::protocol::TProtocol *oprot) const
 {
     apache::thrift::protocol::TBinaryProtocol *binary_proto =
         static_cast<apache::thrift::protocol::TBinaryProtocol *>(oprot);
+
+    // a large blob written to a binary_writer is linked into the writer's buffers (usually the
+    // message to send) rather than copied
+    if (static_cast<int>(_length) >= binary_writer::nocopy_min_bytes) {
+        auto writer_trans = dynamic_cast<binary_writer_transport *>(oprot->getTransport().get());
+        if (writer_trans != nullptr &&
+            dynamic_cast<apache::thrift::protocol::TBinaryProtocol *>(oprot) != nullptr) {
+            uint32_t xfer = binary_proto->writeI32(static_cast<int32_t>(_length));
+            writer_trans->writer().write_nocopy(*this);
+            return xfer + _length;
+        }
+    }
     return binary_proto->writeString<blob_string>(blob_string(const_cast<blob &>(*this)));
 }
 
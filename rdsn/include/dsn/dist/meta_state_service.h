@@ -55,6 +55,11 @@ typedef std::function<void(error_code ec, const blob &val)> err_value_callback;
 typedef future_task<error_code, blob> err_value_future;
 typedef dsn::ref_ptr<err_value_future> err_value_future_ptr;
 
+typedef std::function<void(const std::vector<error_code> &ecs, const std::vector<blob> &vals)>
+    err_values_callback;
+typedef future_task<std::vector<error_code>, std::vector<blob>> err_values_future;
+typedef dsn::ref_ptr<err_values_future> err_values_future_ptr;
+
 typedef std::function<void(error_code ec, const std::vector<std::string> &ret_strv)>
     err_stringv_callback;
 typedef future_task<error_code, std::vector<std::string>> err_stringv_future;
@@ -161,6 +166,18 @@ public:
                               task_code cb_code,
                               const err_value_callback &cb_get_data,
                               dsn::task_tracker *tracker = nullptr) = 0;
+    /*
+     * get the data in many nodes, the reads are pipelined and the callback is
+     * called once for all of them
+     * nodes: dir names with full path
+     * cb_code: the task code specifies where to execute the callback
+     * cb_get_data: callback. ecs[i] and vals[i] are the result of nodes[i],
+     *              as what get_data gives
+     */
+    virtual task_ptr get_data_batch(const std::vector<std::string> &nodes,
+                                    task_code cb_code,
+                                    const err_values_callback &cb_get_data,
+                                    dsn::task_tracker *tracker = nullptr) = 0;
     /*
      * set the data of the node
      * node: dir name with full path
@@ -83,6 +83,10 @@ public:
                                    aio_handler &&callback,
                                    int hash = 0);
 
+    // Path of the manifest that records the progress of copying `dest_file`. It's left only
+    // by an unfinished copy, and a later copy of the same remote file resumes from it.
+    static std::string copy_manifest_path(const std::string &dest_file);
+
     nfs_node() {}
     virtual ~nfs_node() {}
     virtual error_code start() = 0;
@@ -73,6 +73,21 @@ public:
 
     dsn::rpc_address get_meta_server() const { return _meta_server; }
 
+    /**
+     * get the partition index which partition_hash is currently routed to, this lets callers
+     * group keys of one partition into a single batched request
+     *
+     * \return zero-based partition index, or -1 if the partition count is still unknown.
+     */
+    int get_current_partition_index(uint64_t partition_hash)
+    {
+        int partition_count = get_partition_count();
+        if (partition_count <= 0) {
+            return -1;
+        }
+        return get_partition_index(partition_count, partition_hash);
+    }
+
 protected:
     partition_resolver(rpc_address meta_server, const char *app_name)
         : _app_name(app_name), _meta_server(meta_server)
@@ -128,6 +143,13 @@ protected:
 
     virtual int get_partition_index(int partition_count, uint64_t partition_hash) = 0;
 
+    /**
+     * get the partition count of the app
+     *
+     * \return number of partitions, or -1 if it hasn't been queried from meta server yet.
+     */
+    virtual int get_partition_count() const = 0;
+
     std::string _cluster_name;
     std::string _app_name;
     rpc_address _meta_server;
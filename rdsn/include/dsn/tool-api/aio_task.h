@@ -57,6 +57,8 @@ public:
     void *buffer;
     uint64_t buffer_size;
     uint64_t file_offset;
+    // if not empty, they are written in order instead of `buffer`, see `file::write_vector`
+    std::vector<dsn_file_buffer_t> write_buffers;
 
     // filled by frameworks
     aio_type type;
@@ -92,10 +94,6 @@ public:
     // The ownership of `aio_context` is held by `aio_task`.
     aio_context *get_aio_context() { return _aio_ctx.get(); }
 
-    // merge buffers in _unmerged_write_buffers to a single merged buffer.
-    // and store it in _merged_write_buffer_holder.
-    void collapse();
-
     // invoked on aio completed
     virtual void exec() override
     {
@@ -104,8 +102,6 @@ public:
         }
     }
 
-    std::vector<dsn_file_buffer_t> _unmerged_write_buffers;
-    blob _merged_write_buffer_holder;
     std::shared_ptr<dsn::utils::latency_tracer> _tracer;
 
 protected:
@@ -173,6 +173,13 @@ public:
     // called by rpc engine
     DSN_API virtual void inject_drop_message(message_ex *msg, bool is_send) override;
 
+    // called by the sessions when a batch of messages is written to the socket
+    void on_messages_sent(uint64_t bytes, uint64_t message_count)
+    {
+        _send_bytes_per_flush->set(bytes);
+        _send_messages_per_flush->set(message_count);
+    }
+
     // to be defined
     virtual rpc_session_ptr create_client_session(::dsn::rpc_address server_addr) = 0;
 
@@ -189,6 +196,8 @@ protected:
 
     uint32_t _cfg_conn_threshold_per_ip;
     perf_counter_wrapper _client_session_count;
+    perf_counter_wrapper _send_bytes_per_flush;
+    perf_counter_wrapper _send_messages_per_flush;
 };
 
 /*!
@@ -269,6 +278,10 @@ public:
     // return whether there are messages for sending;
     // should always be called in lock
     bool unlink_message_for_send();
+    // copy the small ones of _sending_buffers[start, start + count) into _coalesce_buffer, so
+    // that adjacent small buffers are sent as one block; returns the block count after that.
+    // should always be called in lock
+    int coalesce_send_buffers(int start, int count);
     virtual void send(uint64_t signature) = 0;
     void on_send_completed(uint64_t signature = 0);
     virtual void on_failure(bool is_write = false);
@@ -304,6 +317,9 @@ protected:
 
     std::vector<message_ex *> _sending_msgs;
     std::vector<message_parser::send_buf> _sending_buffers;
+    // small buffers of _sending_msgs are copied here, see coalesce_send_buffers()
+    std::unique_ptr<char[]> _coalesce_buffer;
+    size_t _coalesce_buffer_used;
 
     uint64_t _message_sent;
     // ]
@@ -338,6 +354,8 @@ private:
     // _client_username is only valid if it is a server rpc_session.
     // it represents the name of the corresponding client
     std::string _client_username;
+
+    friend class rpc_session_test;
 };
 
 // --------- inline implementation --------------
@@ -180,6 +180,9 @@ public:
     // for other tasks - allow-inline allows a task being execution in io-thread
     bool allow_inline;
     bool randomize_timer_delay_if_zero; // to avoid many timers executing at the same time
+    // allow task executed by any worker of a partitioned pool rather than the one selected by its
+    // hash, which requires a queue provider supporting work stealing
+    bool allow_steal;
     network_header_format rpc_call_header_format;
     dsn_msg_serialize_format rpc_msg_payload_serialize_default_format;
     rpc_channel rpc_call_channel;
@@ -270,6 +273,13 @@ CONFIG_FLD(bool,
            "initial delay is zero, to avoid "
            "multiple timers executing at the "
            "same time (e.g., checkpointing)")
+CONFIG_FLD(bool,
+           bool,
+           allow_steal,
+           false,
+           "whether the task can be stolen by other workers of its partitioned thread pool, "
+           "only honored by dsn::tools::work_stealing_task_queue; never enable it for tasks "
+           "which must be executed in order on the thread selected by their hash")
 CONFIG_FLD_ID(network_header_format,
               rpc_call_header_format,
               NET_HDR_DSN,
@@ -62,6 +62,13 @@ public:
     void write(const char *buffer, int sz);
     void write(const blob &val);
     void write_empty(int sz);
+    // Append the content of `val` (without a length prefix) as a buffer of its own, sharing
+    // its memory instead of copying. It saves a memcpy for large blobs such as file chunks, but
+    // the content must not be modified until the writer's buffers are released. Blobs smaller
+    // than `nocopy_min_bytes`, or not owning their memory, are copied as usual.
+    void write_nocopy(const blob &val);
+
+    static const int nocopy_min_bytes = 4096;
 
     bool next(void **data, int *size);
     bool backup(int count);
@@ -79,6 +86,8 @@ protected:
     void create_buffer(size_t size);
     void commit();
     virtual void create_new_buffer(size_t size, /*out*/ blob &bb);
+    // called before `bb` is appended by write_nocopy
+    virtual void append_new_buffer(const blob &bb) {}
 
 private:
     std::vector<blob> _buffers;
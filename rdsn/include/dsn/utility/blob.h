@@ -27,6 +27,7 @@
 #pragma once
 
 #include <memory>
+#include <dsn/utility/buffer_pool.h>
 #include <thrift/protocol/TProtocol.h>
 
 namespace dsn {
@@ -64,7 +65,7 @@ public:
     /// NOTE: this operation is not efficient since it involves a memory copy.
     static blob create_from_bytes(const char *s, size_t len)
     {
-        std::shared_ptr<char> s_arr(new char[len], std::default_delete<char[]>());
+        std::shared_ptr<char> s_arr(utils::buffer_pool::make_shared(len));
         memcpy(s_arr.get(), s, len);
         return blob(std::move(s_arr), 0, static_cast<unsigned int>(len));
     }
@@ -0,0 +1,137 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace dsn {
+namespace utils {
+
+/// A size-classed buffer pool with a free list cache per thread, serving the small buffers
+/// that are allocated and released for every rpc message, e.g. by binary_writer, message_ex
+/// and blob.
+///
+/// A buffer is returned to the cache of the thread that releases it, so no lock is taken on
+/// the common paths. Each size class of a thread cache holds at most
+/// [core] buffer_pool_max_cached_bytes_per_class, and the whole cache at most
+/// [core] buffer_pool_max_cached_bytes_per_thread or its share of
+/// [core] buffer_pool_max_cached_bytes. Beyond that, a batch of the buffers is moved to a
+/// central list of the size class, from which the threads with an empty cache refill theirs.
+/// So the buffers released by one thread, e.g. the responses sent by the io threads, go back
+/// to the threads allocating them. The central lists are bounded by
+/// [core] buffer_pool_max_central_cached_bytes. The buffers cached but not used for a while
+/// by a thread are moved to the central lists too.
+///
+/// Buffers larger than the largest size class, or released when the caches are full, are left
+/// to the general allocator.
+class buffer_pool
+{
+public:
+    /// Size classes are in [kMinClassSize, kMaxClassSize], with kStepsPerDoubling classes
+    /// between two powers of two, so a buffer wastes less than a quarter of its size.
+    static const size_t kMinClassSize = 64;
+    static const size_t kMaxClassSize = 64 * 1024;
+    static const int kMinClassShift = 6;
+    static const int kStepsPerDoubling = 4;
+    static const int kClassCount = 41;
+
+    struct stats
+    {
+        uint64_t alloc_count = 0;          // all allocations, including the oversize ones
+        uint64_t hit_count = 0;            // allocations served from a thread cache
+        uint64_t central_hit_count = 0;    // allocations served from the central lists
+        uint64_t oversize_count = 0;       // allocations larger than kMaxClassSize
+        uint64_t free_count = 0;           // all releases
+        uint64_t cached_count = 0;         // releases kept in a thread cache
+        uint64_t cached_bytes = 0;         // bytes held by the thread caches now
+        uint64_t central_cached_bytes = 0; // bytes held by the central lists now
+        uint64_t thread_count = 0;         // threads that have a cache now
+
+        std::string to_string() const;
+    };
+
+    /// Returns a buffer of at least `size` bytes. The shared_ptr control block is drawn from
+    /// the pool too, so there is no separate allocation for it.
+    static std::shared_ptr<char> make_shared(size_t size);
+
+    /// Raw interface, `size` must be the same for both.
+    static void *allocate(size_t size);
+    static void deallocate(void *p, size_t size);
+
+    /// Statistics summed over all the threads, including the exited ones.
+    static stats get_stats();
+
+    /// Index of the size class serving `size`, or -1 if it's oversize.
+    static int size_class(size_t size)
+    {
+        if (size <= kMinClassSize) {
+            return 0;
+        }
+        if (size > kMaxClassSize) {
+            return -1;
+        }
+        // `size` is in (base, 2 * base]
+        size_t s = size - 1;
+        int shift = 63 - __builtin_clzll(s);
+        size_t base = static_cast<size_t>(1) << shift;
+        int step = static_cast<int>((s - base) / (base / kStepsPerDoubling)) + 1;
+        return (shift - kMinClassShift) * kStepsPerDoubling + step;
+    }
+
+    /// Size of the buffers of the size class.
+    static size_t class_size(int cls)
+    {
+        size_t base = kMinClassSize << (cls / kStepsPerDoubling);
+        return base + base / kStepsPerDoubling * (cls % kStepsPerDoubling);
+    }
+};
+
+/// Allocator of std containers and smart pointers drawing from buffer_pool.
+template <typename T>
+class pool_allocator
+{
+public:
+    typedef T value_type;
+
+    pool_allocator() = default;
+    template <typename U>
+    pool_allocator(const pool_allocator<U> &)
+    {
+    }
+
+    T *allocate(size_t n) { return static_cast<T *>(buffer_pool::allocate(n * sizeof(T))); }
+    void deallocate(T *p, size_t n) { buffer_pool::deallocate(p, n * sizeof(T)); }
+};
+
+template <typename T, typename U>
+bool operator==(const pool_allocator<T> &, const pool_allocator<U> &)
+{
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const pool_allocator<T> &, const pool_allocator<U> &)
+{
+    return false;
+}
+
+} // namespace utils
+} // namespace dsn
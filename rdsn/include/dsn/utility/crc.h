@@ -34,6 +34,9 @@
 namespace dsn {
 namespace utils {
 
+// crc32_calc and crc64_calc use the hardware CRC instructions (SSE4.2/PCLMULQDQ on x86_64,
+// CRC32 on aarch64) if the cpu supports them, and they are bit-identical to the table-driven
+// implementations below.
 uint32_t crc32_calc(const void *ptr, size_t size, uint32_t init_crc);
 
 //
@@ -71,5 +74,9 @@ uint64_t crc64_concat(uint32_t xy_init,
                       uint64_t y_init,
                       uint64_t y_final,
                       size_t y_size);
+
+// The portable table-driven implementations, exposed for tests and benchmarks.
+uint32_t crc32_calc_portable(const void *ptr, size_t size, uint32_t init_crc);
+uint64_t crc64_calc_portable(const void *ptr, size_t size, uint64_t init_crc);
 }
 }
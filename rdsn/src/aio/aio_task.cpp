@@ -42,24 +42,6 @@ aio_task::aio_task(dsn::task_code code, aio_handler &&cb, int hash, service_node
     _tracer = std::make_shared<dsn::utils::latency_tracer>(true, "aio_task", 0, code);
 }
 
-void aio_task::collapse()
-{
-    if (!_unmerged_write_buffers.empty()) {
-        std::shared_ptr<char> buffer(dsn::utils::make_shared_array<char>(_aio_ctx->buffer_size));
-        char *dest = buffer.get();
-        for (const dsn_file_buffer_t &b : _unmerged_write_buffers) {
-            ::memcpy(dest, b.buffer, b.size);
-            dest += b.size;
-        }
-        dassert(dest - buffer.get() == _aio_ctx->buffer_size,
-                "%u VS %u",
-                dest - buffer.get(),
-                _aio_ctx->buffer_size);
-        _aio_ctx->buffer = buffer.get();
-        _merged_write_buffer_holder.assign(std::move(buffer), 0, _aio_ctx->buffer_size);
-    }
-}
-
 void aio_task::enqueue(error_code err, size_t transferred_size)
 {
     set_error_code(err);
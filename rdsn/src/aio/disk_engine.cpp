@@ -31,6 +31,7 @@
 #include "disk_engine.h"
 #include "runtime/service_engine.h"
 #include "native_linux_aio_provider.h"
+#include "io_uring_aio_provider.h"
 
 using namespace dsn::utils;
 
@@ -40,6 +41,17 @@ DEFINE_TASK_CODE_AIO(LPC_AIO_BATCH_WRITE, TASK_PRIORITY_COMMON, THREAD_POOL_DEFA
 const char *native_aio_provider = "dsn::tools::native_aio_provider";
 DSN_REGISTER_COMPONENT_PROVIDER(native_linux_aio_provider, native_aio_provider);
 
+#ifdef DSN_HAS_IO_URING
+const char *io_uring_aio_provider_name = "dsn::tools::io_uring_aio_provider";
+DSN_REGISTER_COMPONENT_PROVIDER(io_uring_aio_provider, io_uring_aio_provider_name);
+#endif
+
+DSN_DEFINE_string("core",
+                  aio_factory_name,
+                  "dsn::tools::native_aio_provider",
+                  "the aio provider, can be dsn::tools::native_aio_provider or "
+                  "dsn::tools::io_uring_aio_provider (if built with io_uring)");
+
 struct disk_engine_initializer
 {
     disk_engine_initializer() { disk_engine::instance(); }
@@ -49,9 +61,18 @@ struct disk_engine_initializer
 // because service_engine relies on the former to close files.
 static disk_engine_initializer disk_engine_init;
 
+DSN_DEFINE_uint32("core",
+                  aio_max_batch_write_bytes,
+                  1024 * 1024,
+                  "the max bytes of the adjacent writes to a file that are batched into one "
+                  "vectored write");
+DSN_TAG_VARIABLE(aio_max_batch_write_bytes, FT_MUTABLE);
+
 //----------------- disk_file ------------------------
 aio_task *disk_write_queue::unlink_next_workload(void *plength)
 {
+    // the flag is mutable, it takes effect from the next batch
+    const uint64_t max_batch_bytes = FLAGS_aio_max_batch_write_bytes;
     uint64_t next_offset = 0;
     uint64_t &sz = *(uint64_t *)plength;
     sz = 0;
@@ -64,7 +85,7 @@ aio_task *disk_write_queue::unlink_next_workload(void *plength)
             next_offset = io->file_offset + sz;
         } else {
             // batch condition
-            if (next_offset == io->file_offset && sz + io->buffer_size <= _max_batch_bytes) {
+            if (next_offset == io->file_offset && sz + io->buffer_size <= max_batch_bytes) {
                 sz += io->buffer_size;
                 next_offset += io->buffer_size;
             }
@@ -145,11 +166,24 @@ aio_task *disk_file::on_write_completed(aio_task *wk, void *ctx, error_code err,
 }
 
 //----------------- disk_engine ------------------------
-disk_engine::disk_engine()
+aio_provider &disk_engine::provider()
 {
-    aio_provider *provider = utils::factory_store<aio_provider>::create(
-        native_aio_provider, dsn::PROVIDER_TYPE_MAIN, this);
-    _provider.reset(provider);
+    disk_engine &engine = instance();
+    // disk_engine is created during static initialization, before the configs are loaded,
+    // so the provider is created on its first use.
+    std::call_once(engine._provider_init_flag, [&engine]() {
+        aio_provider *provider = utils::factory_store<aio_provider>::create(
+            FLAGS_aio_factory_name, dsn::PROVIDER_TYPE_MAIN, &engine);
+        if (provider == nullptr) {
+            dwarn_f("aio provider {} is not supported, use {} instead",
+                    FLAGS_aio_factory_name,
+                    native_aio_provider);
+            provider = utils::factory_store<aio_provider>::create(
+                native_aio_provider, dsn::PROVIDER_TYPE_MAIN, &engine);
+        }
+        engine._provider.reset(provider);
+    });
+    return *engine._provider;
 }
 
 class batch_write_io_task : public aio_task
@@ -202,13 +236,12 @@ void disk_engine::process_write(aio_task *aio, uint64_t sz)
 
     // no batching
     if (dio->buffer_size == sz) {
-        aio->collapse();
-        _provider->submit_aio_task(aio);
+        provider().submit_aio_task(aio);
     }
 
     // batching
     else {
-        // setup io task
+        // setup io task, which writes the buffers of the batched tasks by one vectored write
         auto new_task = new batch_write_io_task(aio);
         auto new_dio = new_task->get_aio_context();
         new_dio->buffer_size = sz;
@@ -225,11 +258,11 @@ void disk_engine::process_write(aio_task *aio, uint64_t sz)
                 dsn_file_buffer_t buf;
                 buf.buffer = cur_dio->buffer;
                 buf.size = cur_dio->buffer_size;
-                new_task->_unmerged_write_buffers.push_back(std::move(buf));
+                new_dio->write_buffers.push_back(std::move(buf));
             } else {
-                new_task->_unmerged_write_buffers.insert(new_task->_unmerged_write_buffers.end(),
-                                                         cur_task->_unmerged_write_buffers.begin(),
-                                                         cur_task->_unmerged_write_buffers.end());
+                new_dio->write_buffers.insert(new_dio->write_buffers.end(),
+                                              cur_dio->write_buffers.begin(),
+                                              cur_dio->write_buffers.end());
             }
             cur_task = (aio_task *)cur_task->next;
         } while (cur_task);
@@ -260,7 +293,7 @@ void disk_engine::complete_io(aio_task *aio, error_code err, uint64_t bytes)
         if (aio->get_aio_context()->type == AIO_Read) {
             auto wk = df->on_read_completed(aio, err, (size_t)bytes);
             if (wk) {
-                _provider->submit_aio_task(wk);
+                provider().submit_aio_task(wk);
             }
         }
 
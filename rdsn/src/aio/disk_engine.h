@@ -31,22 +31,17 @@
 #include <dsn/tool_api.h>
 #include <dsn/utility/synchronize.h>
 #include <dsn/utility/work_queue.h>
+#include <mutex>
 
 namespace dsn {
 
 class disk_write_queue : public work_queue<aio_task>
 {
 public:
-    disk_write_queue() : work_queue(2)
-    {
-        _max_batch_bytes = 1024 * 1024; // 1 MB
-    }
+    disk_write_queue() : work_queue(2) {}
 
 private:
     virtual aio_task *unlink_next_workload(void *plength) override;
-
-private:
-    uint32_t _max_batch_bytes;
 };
 
 class disk_file
@@ -72,16 +67,17 @@ class disk_engine : public utils::singleton<disk_engine>
 {
 public:
     void write(aio_task *aio);
-    static aio_provider &provider() { return *instance()._provider.get(); }
+    static aio_provider &provider();
 
 private:
     // the object of disk_engine must be created by `singleton::instance`
-    disk_engine();
+    disk_engine() = default;
     ~disk_engine() = default;
 
     void process_write(aio_task *wk, uint64_t sz);
     void complete_io(aio_task *aio, error_code err, uint64_t bytes);
 
+    std::once_flag _provider_init_flag;
     std::unique_ptr<aio_provider> _provider;
 
     friend class aio_provider;
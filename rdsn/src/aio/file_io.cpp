@@ -124,7 +124,7 @@ namespace file {
     cb->get_aio_context()->type = AIO_Write;
     for (int i = 0; i < buffer_count; i++) {
         if (buffers[i].size > 0) {
-            cb->_unmerged_write_buffers.push_back(buffers[i]);
+            cb->get_aio_context()->write_buffers.push_back(buffers[i]);
             cb->get_aio_context()->buffer_size += buffers[i].size;
         }
     }
@@ -0,0 +1,202 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Microsoft Corporation
+ *
+ * -=- Robust Distributed System Nucleus (rDSN) -=-
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "io_uring_aio_provider.h"
+
+#ifdef DSN_HAS_IO_URING
+
+#include "runtime/service_engine.h"
+
+#include <dsn/dist/fmt_logging.h>
+#include <dsn/utility/flags.h>
+#include <dsn/utils/latency_tracer.h>
+
+namespace dsn {
+
+DSN_DEFINE_uint32("core",
+                  io_uring_queue_depth,
+                  256,
+                  "the number of entries of the submission queue of io_uring");
+
+struct io_uring_aio_provider::uring_request
+{
+    aio_task *tsk;
+    // bytes that have been processed, a request is resubmitted if it's incomplete
+    uint64_t processed_bytes;
+    std::vector<struct iovec> iovs;
+};
+
+io_uring_aio_provider::io_uring_aio_provider(disk_engine *disk)
+    : native_linux_aio_provider(disk), _ring_ready(false)
+{
+    int ret = io_uring_queue_init(FLAGS_io_uring_queue_depth, &_ring, 0);
+    if (ret < 0) {
+        dwarn_f("io_uring is not available ({}), fall back to the native aio", strerror(-ret));
+        return;
+    }
+
+    _ring_ready = true;
+    _reaper = std::thread([this]() { reap_completions(); });
+    ddebug_f("io_uring_aio_provider is ready, queue_depth = {}", FLAGS_io_uring_queue_depth);
+}
+
+io_uring_aio_provider::~io_uring_aio_provider()
+{
+    if (!_ring_ready) {
+        return;
+    }
+
+    // a nop with null user data tells the reaper to stop
+    {
+        utils::auto_lock<utils::ex_lock_nr> l(_sq_lock);
+        struct io_uring_sqe *sqe = io_uring_get_sqe(&_ring);
+        while (sqe == nullptr) {
+            io_uring_submit(&_ring);
+            sqe = io_uring_get_sqe(&_ring);
+        }
+        io_uring_prep_nop(sqe);
+        io_uring_sqe_set_data(sqe, nullptr);
+        io_uring_submit(&_ring);
+    }
+    _reaper.join();
+    io_uring_queue_exit(&_ring);
+}
+
+error_code io_uring_aio_provider::flush(dsn_handle_t fh)
+{
+    // the file size is flushed by fdatasync as well, only the other metadata is skipped.
+    if (fh == DSN_INVALID_FILE_HANDLE || ::fdatasync((int)(uintptr_t)(fh)) == 0) {
+        return ERR_OK;
+    } else {
+        derror("flush file failed, err = %s", strerror(errno));
+        return ERR_FILE_OPERATION_FAILED;
+    }
+}
+
+void io_uring_aio_provider::submit_aio_task(aio_task *aio_tsk)
+{
+    aio_context *aio_ctx = aio_tsk->get_aio_context();
+    if (!_ring_ready || dsn_unlikely(service_engine::instance().is_simulator()) ||
+        (aio_ctx->type != AIO_Read && aio_ctx->type != AIO_Write)) {
+        native_linux_aio_provider::submit_aio_task(aio_tsk);
+        return;
+    }
+
+    ADD_POINT(aio_tsk->_tracer);
+    auto req = new uring_request();
+    req->tsk = aio_tsk;
+    req->processed_bytes = 0;
+    submit_request(req);
+}
+
+void io_uring_aio_provider::submit_request(uring_request *req)
+{
+    aio_context *aio_ctx = req->tsk->get_aio_context();
+    fill_iovecs(*aio_ctx, req->processed_bytes, req->iovs);
+    int fd = static_cast<int>((ssize_t)aio_ctx->file);
+    uint64_t offset = aio_ctx->file_offset + req->processed_bytes;
+
+    utils::auto_lock<utils::ex_lock_nr> l(_sq_lock);
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&_ring);
+    while (sqe == nullptr) {
+        // the submission queue is full, hand the queued sqes to the kernel to make room
+        io_uring_submit(&_ring);
+        sqe = io_uring_get_sqe(&_ring);
+    }
+    if (aio_ctx->type == AIO_Read) {
+        io_uring_prep_readv(sqe, fd, req->iovs.data(), 1, offset);
+    } else {
+        io_uring_prep_writev(sqe, fd, req->iovs.data(), req->iovs.size(), offset);
+    }
+    io_uring_sqe_set_data(sqe, req);
+    int ret = io_uring_submit(&_ring);
+    dassert_f(ret >= 0, "io_uring_submit failed: {}", strerror(-ret));
+}
+
+void io_uring_aio_provider::reap_completions()
+{
+    task::set_tls_dsn_context(nullptr, nullptr);
+
+    while (true) {
+        struct io_uring_cqe *cqe = nullptr;
+        int ret = io_uring_wait_cqe(&_ring, &cqe);
+        if (ret < 0) {
+            if (ret != -EINTR) {
+                derror_f("io_uring_wait_cqe failed: {}", strerror(-ret));
+            }
+            continue;
+        }
+
+        auto req = static_cast<uring_request *>(io_uring_cqe_get_data(cqe));
+        int res = cqe->res;
+        io_uring_cqe_seen(&_ring, cqe);
+        if (req == nullptr) {
+            return;
+        }
+
+        aio_task *aio_tsk = req->tsk;
+        aio_context *aio_ctx = aio_tsk->get_aio_context();
+        if (res == -EINTR || res == -EAGAIN) {
+            submit_request(req);
+            continue;
+        }
+
+        error_code err = ERR_OK;
+        if (res < 0) {
+            err = ERR_FILE_OPERATION_FAILED;
+            derror_f("{} failed with errno={}, return {}.",
+                     aio_ctx->type == AIO_Read ? "read" : "write",
+                     strerror(-res),
+                     err);
+        } else if (aio_ctx->type == AIO_Read) {
+            if (res == 0) {
+                err = ERR_HANDLE_EOF;
+            }
+            req->processed_bytes = static_cast<uint64_t>(res);
+        } else {
+            req->processed_bytes += static_cast<uint64_t>(res);
+            if (dsn_unlikely(req->processed_bytes < aio_ctx->buffer_size)) {
+                dwarn_f("write incomplete, request_size={}, total_write_size={}, "
+                        "this_write_size={}, and will retry it.",
+                        aio_ctx->buffer_size,
+                        req->processed_bytes,
+                        res);
+                submit_request(req);
+                continue;
+            }
+        }
+
+        uint64_t processed_bytes = req->processed_bytes;
+        delete req;
+
+        ADD_CUSTOM_POINT(aio_tsk->_tracer, "completed");
+        complete_io(aio_tsk, err, processed_bytes);
+    }
+}
+
+} // namespace dsn
+
+#endif // DSN_HAS_IO_URING
@@ -0,0 +1,72 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Microsoft Corporation
+ *
+ * -=- Robust Distributed System Nucleus (rDSN) -=-
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "native_linux_aio_provider.h"
+
+#ifdef DSN_HAS_IO_URING
+
+#include <liburing.h>
+#include <thread>
+
+#include <dsn/utility/synchronize.h>
+
+namespace dsn {
+
+// An aio_provider that submits reads and writes to the kernel through io_uring, and reaps
+// their completions on a dedicated thread, so no worker thread is blocked on disk I/O.
+//
+// The synchronous interfaces (open/close/read/write/flush) are inherited from
+// native_linux_aio_provider. If io_uring is not supported by the kernel, or the process is
+// not allowed to use it, the aio tasks are also executed in the native way.
+class io_uring_aio_provider : public native_linux_aio_provider
+{
+public:
+    explicit io_uring_aio_provider(disk_engine *disk);
+    ~io_uring_aio_provider() override;
+
+    error_code flush(dsn_handle_t fh) override;
+
+    void submit_aio_task(aio_task *aio) override;
+
+private:
+    struct uring_request;
+
+    // Puts a sqe for the rest of `req` into the submission queue, and submits it.
+    void submit_request(uring_request *req);
+    void reap_completions();
+
+    bool _ring_ready;
+    struct io_uring _ring;
+    // protects the submission queue, which is shared by all the submitting threads
+    utils::ex_lock_nr _sq_lock;
+    std::thread _reaper;
+};
+
+} // namespace dsn
+
+#endif // DSN_HAS_IO_URING
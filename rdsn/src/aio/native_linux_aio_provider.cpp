@@ -27,6 +27,7 @@
 #include "native_linux_aio_provider.h"
 
 #include <fcntl.h>
+#include <limits.h>
 
 #include "runtime/service_engine.h"
 
@@ -76,12 +77,14 @@ error_code native_linux_aio_provider::write(const aio_context &aio_ctx,
 {
     dsn::error_code resp = ERR_OK;
     uint64_t buffer_offset = 0;
+    std::vector<struct iovec> iovs;
     do {
+        fill_iovecs(aio_ctx, buffer_offset, iovs);
         // ret is the written data size
-        auto ret = pwrite(static_cast<int>((ssize_t)aio_ctx.file),
-                          (char *)aio_ctx.buffer + buffer_offset,
-                          aio_ctx.buffer_size - buffer_offset,
-                          aio_ctx.file_offset + buffer_offset);
+        auto ret = pwritev(static_cast<int>((ssize_t)aio_ctx.file),
+                           iovs.data(),
+                           static_cast<int>(iovs.size()),
+                           aio_ctx.file_offset + buffer_offset);
         if (dsn_unlikely(ret < 0)) {
             if (errno == EINTR) {
                 dwarn_f("write failed with errno={} and will retry it.", strerror(errno));
@@ -130,6 +133,36 @@ error_code native_linux_aio_provider::read(const aio_context &aio_ctx,
     return ERR_OK;
 }
 
+/*static*/ void native_linux_aio_provider::fill_iovecs(const aio_context &aio_ctx,
+                                                       uint64_t skip_bytes,
+                                                       std::vector<struct iovec> &iovs)
+{
+    iovs.clear();
+    if (aio_ctx.write_buffers.empty()) {
+        struct iovec iov;
+        iov.iov_base = (char *)aio_ctx.buffer + skip_bytes;
+        iov.iov_len = aio_ctx.buffer_size - skip_bytes;
+        iovs.push_back(iov);
+        return;
+    }
+
+    for (const dsn_file_buffer_t &buf : aio_ctx.write_buffers) {
+        auto size = static_cast<uint64_t>(buf.size);
+        if (skip_bytes >= size) {
+            skip_bytes -= size;
+            continue;
+        }
+        struct iovec iov;
+        iov.iov_base = (char *)buf.buffer + skip_bytes;
+        iov.iov_len = size - skip_bytes;
+        iovs.push_back(iov);
+        skip_bytes = 0;
+        if (iovs.size() == IOV_MAX) {
+            break;
+        }
+    }
+}
+
 void native_linux_aio_provider::submit_aio_task(aio_task *aio_tsk)
 {
     // for the tests which use simulator need sync submit for aio
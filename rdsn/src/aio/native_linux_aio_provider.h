@@ -28,6 +28,8 @@
 
 #include "aio_provider.h"
 
+#include <sys/uio.h>
+
 namespace dsn {
 
 class native_linux_aio_provider : public aio_provider
@@ -47,6 +49,11 @@ public:
 
 protected:
     error_code aio_internal(aio_task *aio);
+
+    // Fills `iovs` with the buffers of `aio_ctx` that are after the first `skip_bytes` bytes,
+    // at most IOV_MAX of them, so a write may need to be issued more than once.
+    static void
+    fill_iovecs(const aio_context &aio_ctx, uint64_t skip_bytes, std::vector<struct iovec> &iovs);
 };
 
 } // namespace dsn
@@ -30,6 +30,7 @@
 #include <dsn/utility/fail_point.h>
 
 #include <gtest/gtest.h>
+#include <limits.h>
 
 using namespace ::dsn;
 
@@ -145,6 +146,39 @@ TEST(core, aio_share)
     utils::filesystem::remove_path("tmp");
 }
 
+TEST(core, aio_write_vector_over_iov_max)
+{
+    // more buffers than a single pwritev accepts
+    const int buffer_count = IOV_MAX * 2 + 1;
+    std::string content;
+    std::vector<dsn_file_buffer_t> buffers(buffer_count);
+    for (int i = 0; i < buffer_count; i++) {
+        content.push_back(static_cast<char>('a' + i % 26));
+    }
+    for (int i = 0; i < buffer_count; i++) {
+        buffers[i].buffer = static_cast<void *>(const_cast<char *>(content.data() + i));
+        buffers[i].size = 1;
+    }
+
+    auto fp = file::open("tmp", O_RDWR | O_CREAT | O_BINARY, 0666);
+    ASSERT_TRUE(fp != nullptr);
+    auto t = ::dsn::file::write_vector(
+        fp, buffers.data(), buffer_count, 0, LPC_AIO_TEST, nullptr, nullptr);
+    t->wait();
+    ASSERT_EQ(ERR_OK, t->error());
+    ASSERT_EQ(content.size(), t->get_transferred_size());
+
+    std::string read_buffer(content.size(), '\0');
+    t = ::dsn::file::read(
+        fp, &read_buffer[0], read_buffer.size(), 0, LPC_AIO_TEST, nullptr, nullptr);
+    t->wait();
+    ASSERT_EQ(ERR_OK, t->error());
+    ASSERT_EQ(content, read_buffer);
+
+    ASSERT_EQ(ERR_OK, file::close(fp));
+    utils::filesystem::remove_path("tmp");
+}
+
 TEST(core, operation_failed)
 {
     fail::setup();
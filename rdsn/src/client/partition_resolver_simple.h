@@ -50,7 +50,7 @@ public:
 
     virtual int get_partition_index(int partition_count, uint64_t partition_hash) override;
 
-    int get_partition_count() const { return _app_partition_count; }
+    virtual int get_partition_count() const override { return _app_partition_count; }
 
 private:
     struct partition_info
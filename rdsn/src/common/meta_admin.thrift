@@ -97,6 +97,11 @@ struct configuration_query_by_node_request
     1:dsn.rpc_address  node;
     2:optional list<metadata.replica_info> stored_replicas;
     3:optional replica_server_info info;
+
+    // The versions of the partitions last synced by the replica server. If set, meta server
+    // replies only the partitions whose versions changed, and moves their app_info into
+    // `configuration_query_by_node_response.apps`.
+    4:optional map<dsn.gpid, i64> partition_versions;
 }
 
 struct configuration_query_by_node_response
@@ -104,6 +109,14 @@ struct configuration_query_by_node_response
     1:dsn.error_code err;
     2:list<configuration_update_request> partitions;
     3:optional list<metadata.replica_info> gc_replicas;
+
+    // set if `partition_versions` is set in the request:
+    // - the app_info of the apps in `partitions`, whose own `info` is left empty
+    // - the current versions of `partitions`
+    // - the partitions still served by the node that are not changed
+    4:optional list<dsn.layer2.app_info> apps;
+    5:optional map<dsn.gpid, i64> partition_versions;
+    6:optional list<dsn.gpid> unchanged_partitions;
 }
 
 struct configuration_recovery_request
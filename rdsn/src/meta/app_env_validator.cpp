@@ -146,6 +146,16 @@ bool check_bool_value(const std::string &env_value, std::string &hint_message)
     return true;
 }
 
+bool check_log_block_compression(const std::string &env_value, std::string &hint_message)
+{
+    if (env_value != "none" && env_value != "lz4" && env_value != "zstd") {
+        hint_message =
+            fmt::format("invalid string {}, should be \"none\", \"lz4\" or \"zstd\"", env_value);
+        return false;
+    }
+    return true;
+}
+
 bool app_env_validator::validate_app_env(const std::string &env_name,
                                          const std::string &env_value,
                                          std::string &hint_message)
@@ -193,6 +203,8 @@ void app_env_validator::register_all_validators()
          std::bind(&check_bool_value, std::placeholders::_1, std::placeholders::_2)},
         {replica_envs::DENY_CLIENT_REQUEST,
          std::bind(&check_deny_client, std::placeholders::_1, std::placeholders::_2)},
+        {replica_envs::LOG_BLOCK_COMPRESSION,
+         std::bind(&check_log_block_compression, std::placeholders::_1, std::placeholders::_2)},
         // TODO(zhaoliwei): not implemented
         {replica_envs::BUSINESS_INFO, nullptr},
         {replica_envs::TABLE_LEVEL_DEFAULT_TTL, nullptr},
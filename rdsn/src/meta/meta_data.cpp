@@ -34,6 +34,7 @@
  */
 #include <boost/lexical_cast.hpp>
 
+#include <dsn/cpp/serialization.h>
 #include <dsn/dist/fmt_logging.h>
 #include <dsn/service_api_cpp.h>
 #include <dsn/utility/flags.h>
@@ -78,6 +79,41 @@ DSN_DEFINE_uint32("meta_server",
                   "max reserved number allowed for dropped replicas");
 DSN_TAG_VARIABLE(max_reserved_dropped_replicas, FT_MUTABLE);
 
+DSN_DEFINE_string("meta_server",
+                  partition_config_encoding,
+                  "json",
+                  "encoding of the partition configs on the remote storage: json or thrift, "
+                  "switch to thrift only when no meta server of older versions is left");
+DSN_DEFINE_validator(partition_config_encoding, [](const char *value) -> bool {
+    return strcmp(value, "json") == 0 || strcmp(value, "thrift") == 0;
+});
+
+// a json object starts with '{', so it never looks like the magic
+static const char PARTITION_CONFIG_THRIFT_MAGIC[] = {'P', 'C', 'T', '1'};
+
+blob encode_partition_config(const partition_configuration &pc)
+{
+    if (strcmp(FLAGS_partition_config_encoding, "thrift") != 0) {
+        return json::json_forwarder<partition_configuration>::encode(pc);
+    }
+    binary_writer writer;
+    writer.write(PARTITION_CONFIG_THRIFT_MAGIC, sizeof(PARTITION_CONFIG_THRIFT_MAGIC));
+    marshall(writer, pc, DSF_THRIFT_BINARY);
+    return writer.get_buffer();
+}
+
+bool decode_partition_config(const blob &value, partition_configuration &pc)
+{
+    const size_t magic_length = sizeof(PARTITION_CONFIG_THRIFT_MAGIC);
+    if (value.length() >= magic_length &&
+        memcmp(value.data(), PARTITION_CONFIG_THRIFT_MAGIC, magic_length) == 0) {
+        binary_reader reader(value.range(magic_length));
+        unmarshall(reader, pc, DSF_THRIFT_BINARY);
+        return true;
+    }
+    return json::json_forwarder<partition_configuration>::decode(value, pc);
+}
+
 void when_update_replicas(config_type::type t, const std::function<void(bool)> &func)
 {
     switch (t) {
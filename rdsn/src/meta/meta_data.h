@@ -561,6 +561,13 @@ bool construct_replica(meta_view view, const gpid &pid, int max_replica_count);
 //   WARNING: if false is returned, the replica on node may be garbage-collected
 bool collect_replica(meta_view view, const rpc_address &node, const replica_info &info);
 
+// Partition configs are stored on the remote storage in json, or in thrift binary which is
+// several times smaller and faster to decode if [meta_server] partition_config_encoding is
+// "thrift". Both are decoded, so the encoding can be switched once all meta servers are
+// upgraded, and the partition configs are converted as they are updated.
+blob encode_partition_config(const partition_configuration &pc);
+bool decode_partition_config(const blob &value, /*out*/ partition_configuration &pc);
+
 inline bool has_seconds_expired(uint64_t second_ts) { return second_ts * 1000 < dsn_now_ms(); }
 
 inline bool has_milliseconds_expired(uint64_t milliseconds_ts)
@@ -208,7 +208,7 @@ dsn::task_ptr meta_split_service::add_child_on_remote_storage(register_child_rpc
 {
     const auto &request = rpc.request();
     const std::string &partition_path = _state->get_partition_path(request.child_config.pid);
-    blob value = dsn::json::json_forwarder<partition_configuration>::encode(request.child_config);
+    blob value = encode_partition_config(request.child_config);
     if (create_new) {
         return _meta_svc->get_remote_storage()->create_node(
             partition_path,
@@ -460,6 +460,35 @@ task_ptr meta_state_service_simple::get_data(const std::string &node,
     }
 }
 
+task_ptr meta_state_service_simple::get_data_batch(const std::vector<std::string> &nodes,
+                                                   task_code cb_code,
+                                                   const err_values_callback &cb_get_data,
+                                                   dsn::task_tracker *tracker)
+{
+    std::vector<error_code> ecs;
+    std::vector<blob> vals;
+    ecs.reserve(nodes.size());
+    vals.reserve(nodes.size());
+    {
+        zauto_lock _(_state_lock);
+        for (const std::string &node : nodes) {
+            auto me_it = _quick_map.find(normalize_path(node));
+            if (me_it == _quick_map.end()) {
+                ecs.emplace_back(ERR_OBJECT_NOT_FOUND);
+                vals.emplace_back();
+            } else {
+                ecs.emplace_back(ERR_OK);
+                vals.emplace_back(me_it->second->data);
+            }
+        }
+    }
+    return tasking::enqueue(cb_code,
+                            tracker,
+                            [ cb_get_data, ecs = std::move(ecs), vals = std::move(vals) ]() {
+                                cb_get_data(ecs, vals);
+                            });
+}
+
 task_ptr meta_state_service_simple::set_data(const std::string &node,
                                              const blob &value,
                                              task_code cb_code,
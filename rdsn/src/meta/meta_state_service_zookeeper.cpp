@@ -36,6 +36,7 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
+#include <atomic>
 
 #include "meta_state_service_zookeeper.h"
 #include "zookeeper/zookeeper_session_mgr.h"
@@ -320,6 +321,56 @@ task_ptr meta_state_service_zookeeper::get_data(const std::string &node,
     return tsk;
 }
 
+task_ptr meta_state_service_zookeeper::get_data_batch(const std::vector<std::string> &nodes,
+                                                      task_code cb_code,
+                                                      const err_values_callback &cb_get_data,
+                                                      dsn::task_tracker *tracker)
+{
+    err_values_future_ptr tsk(new err_values_future(cb_code, cb_get_data, 0));
+    tsk->set_tracker(tracker);
+    dinfo("call batch get, node_count(%d)", (int)nodes.size());
+    if (nodes.empty()) {
+        tsk->enqueue_with(std::vector<error_code>(), std::vector<blob>());
+        return tsk;
+    }
+
+    // the gets are pipelined through the session, and their results are gathered in the
+    // completion thread of zookeeper, so a batch costs one callback task instead of one per node
+    struct batch_result
+    {
+        std::vector<error_code> ecs;
+        std::vector<blob> vals;
+        std::atomic<size_t> remaining;
+    };
+    auto result = std::make_shared<batch_result>();
+    result->ecs.resize(nodes.size());
+    result->vals.resize(nodes.size());
+    result->remaining = nodes.size();
+
+    ref_this self(this);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        zookeeper_session::zoo_opcontext *op = zookeeper_session::create_context();
+        // runs in zookeeper do-completion thread
+        op->_callback_function = [self, tsk, result, i](zookeeper_session::zoo_opcontext *op) {
+            if (ZOK == op->_output.error) {
+                std::shared_ptr<char> buf(
+                    dsn::utils::make_shared_array<char>(op->_output.get_op.value_length));
+                memcpy(buf.get(), op->_output.get_op.value, op->_output.get_op.value_length);
+                result->vals[i].assign(buf, 0, op->_output.get_op.value_length);
+            }
+            result->ecs[i] = from_zerror(op->_output.error);
+            if (--result->remaining == 0) {
+                tsk->enqueue_with(std::move(result->ecs), std::move(result->vals));
+            }
+        };
+        op->_optype = zookeeper_session::ZOO_OPERATION::ZOO_GET;
+        op->_input._path = nodes[i];
+        op->_input._is_set_watch = 0;
+        _session->visit(op);
+    }
+    return tsk;
+}
+
 task_ptr meta_state_service_zookeeper::set_data(const std::string &node,
                                                 const blob &value,
                                                 task_code cb_code,
@@ -85,6 +85,11 @@ public:
                               const err_value_callback &cb_get_data,
                               dsn::task_tracker *tracker = nullptr) override;
 
+    virtual task_ptr get_data_batch(const std::vector<std::string> &nodes,
+                                    task_code cb_code,
+                                    const err_values_callback &cb_get_data,
+                                    dsn::task_tracker *tracker = nullptr) override;
+
     virtual task_ptr set_data(const std::string &node,
                               const blob &value,
                               task_code cb_code,
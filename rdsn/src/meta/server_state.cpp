@@ -36,6 +36,7 @@
 
 #include <dsn/dist/fmt_logging.h>
 #include <dsn/dist/replication/replica_envs.h>
+#include <dsn/utility/crc.h>
 #include <dsn/utility/factory_store.h>
 #include <dsn/utility/string_conv.h>
 #include <dsn/utility/strings.h>
@@ -580,22 +581,38 @@ dsn::error_code server_state::sync_apps_from_remote_storage()
     dsn::task_tracker tracker;
 
     dist::meta_state_service *storage = _meta_svc->get_remote_storage();
-    auto sync_partition = [this, storage, &err, &tracker](
-        std::shared_ptr<app_state> &app, int partition_id, const std::string &partition_path) {
-        storage->get_data(
-            partition_path,
+    // all partitions of an app are fetched in one batch, and applied under one lock once the
+    // batch completes, so that loading a large cluster won't cost a callback per partition
+    auto sync_partitions = [this, storage, &err, &tracker](std::shared_ptr<app_state> &app,
+                                                           const std::string &app_path) {
+        std::vector<std::string> partition_paths;
+        partition_paths.reserve(app->partition_count);
+        for (int i = 0; i < app->partition_count; i++) {
+            partition_paths.emplace_back(app_path + "/" + boost::lexical_cast<std::string>(i));
+        }
+        storage->get_data_batch(
+            partition_paths,
             LPC_META_CALLBACK,
-            [this, app, partition_id, partition_path, &err](error_code ec,
-                                                            const blob &value) mutable {
-                if (ec == ERR_OK) {
-                    partition_configuration pc;
-                    dsn::json::json_forwarder<partition_configuration>::decode(value, pc);
+            [this, app, partition_paths, &err](const std::vector<error_code> &ecs,
+                                               const std::vector<blob> &values) mutable {
+                const int partition_count = static_cast<int>(ecs.size());
+                std::vector<partition_configuration> pcs(partition_count);
+                for (int partition_id = 0; partition_id < partition_count; ++partition_id) {
+                    if (ecs[partition_id] == ERR_OK) {
+                        partition_configuration &pc = pcs[partition_id];
+                        dassert(decode_partition_config(values[partition_id], pc),
+                                "invalid partition config data");
+                        dassert(pc.pid.get_app_id() == app->app_id &&
+                                    pc.pid.get_partition_index() == partition_id,
+                                "invalid partition config");
+                    }
+                }
 
-                    dassert(pc.pid.get_app_id() == app->app_id &&
-                                pc.pid.get_partition_index() == partition_id,
-                            "invalid partition config");
-                    {
-                        zauto_write_lock l(_lock);
+                zauto_write_lock l(_lock);
+                for (int partition_id = 0; partition_id < partition_count; ++partition_id) {
+                    const error_code &ec = ecs[partition_id];
+                    if (ec == ERR_OK) {
+                        const partition_configuration &pc = pcs[partition_id];
                         app->partitions[partition_id] = pc;
                         for (const dsn::rpc_address &addr : pc.last_drops) {
                             app->helpers->contexts[partition_id].record_drop_history(addr);
@@ -615,34 +632,33 @@ dsn::error_code server_state::sync_apps_from_remote_storage()
                             _meta_svc->get_bulk_load_service()) {
                             bool is_bulk_loading = app->is_bulk_loading;
                             _meta_svc->get_bulk_load_service()->check_app_bulk_load_states(
-                                std::move(app), is_bulk_loading);
+                                app, is_bulk_loading);
                         }
+                    } else if (ec == ERR_OBJECT_NOT_FOUND) {
+                        auto init_partition_count = app->init_partition_count > 0
+                                                        ? app->init_partition_count
+                                                        : app->partition_count;
+                        if (partition_id < init_partition_count) {
+                            dwarn_f("partition node {} not exist on remote storage, may half "
+                                    "create before",
+                                    partition_paths[partition_id]);
+                            init_app_partition_node(app, partition_id, nullptr);
+                        } else if (partition_id >= app->partition_count / 2) {
+                            dwarn_f("partition node {} not exist on remote storage, may half "
+                                    "split before",
+                                    partition_paths[partition_id]);
+                            app->helpers->split_states
+                                .status[partition_id - app->partition_count / 2] =
+                                split_status::SPLITTING;
+                            app->helpers->split_states.splitting_count++;
+                            app->partitions[partition_id].ballot = invalid_ballot;
+                            app->partitions[partition_id].pid = gpid(app->app_id, partition_id);
+                            process_one_partition(app);
+                        }
+                    } else {
+                        derror("get partition node failed, reason(%s)", ec.to_string());
+                        err = ec;
                     }
-                } else if (ec == ERR_OBJECT_NOT_FOUND) {
-                    auto init_partition_count = app->init_partition_count > 0
-                                                    ? app->init_partition_count
-                                                    : app->partition_count;
-                    if (partition_id < init_partition_count) {
-                        dwarn_f(
-                            "partition node {} not exist on remote storage, may half create before",
-                            partition_path);
-                        init_app_partition_node(app, partition_id, nullptr);
-                    } else if (partition_id >= app->partition_count / 2) {
-                        dwarn_f(
-                            "partition node {} not exist on remote storage, may half split before",
-                            partition_path);
-                        zauto_write_lock l(_lock);
-                        app->helpers->split_states.status[partition_id - app->partition_count / 2] =
-                            split_status::SPLITTING;
-                        app->helpers->split_states.splitting_count++;
-                        app->partitions[partition_id].ballot = invalid_ballot;
-                        app->partitions[partition_id].pid = gpid(app->app_id, partition_id);
-                        process_one_partition(app);
-                    }
-
-                } else {
-                    derror("get partition node failed, reason(%s)", ec.to_string());
-                    err = ec;
                 }
             },
             &tracker);
@@ -652,7 +668,7 @@ dsn::error_code server_state::sync_apps_from_remote_storage()
         storage->get_data(
             app_path,
             LPC_META_CALLBACK,
-            [this, app_path, &err, &sync_partition](error_code ec, const blob &value) {
+            [this, app_path, &err, &sync_partitions](error_code ec, const blob &value) {
                 if (ec == ERR_OK) {
                     app_info info;
                     dassert(dsn::json::json_forwarder<app_info>::decode(value, info),
@@ -674,11 +690,7 @@ dsn::error_code server_state::sync_apps_from_remote_storage()
                         }
                     }
                     app->helpers->split_states.splitting_count = 0;
-                    for (int i = 0; i < app->partition_count; i++) {
-                        std::string partition_path =
-                            app_path + "/" + boost::lexical_cast<std::string>(i);
-                        sync_partition(app, i, partition_path);
-                    }
+                    sync_partitions(app, app_path);
                 } else {
                     derror("get app info from meta state service failed, path = %s, err = %s",
                            app_path.c_str(),
@@ -797,6 +809,25 @@ void server_state::set_replica_migration_subscriber_for_test(
     _replica_migration_subscriber = subscriber;
 }
 
+uint64_t server_state::get_sync_version(const app_info &info)
+{
+    binary_writer writer;
+    dsn::marshall(writer, info, DSF_THRIFT_BINARY);
+    blob data = writer.get_buffer();
+    return utils::crc64_calc(data.data(), data.length(), 0);
+}
+
+int64_t server_state::get_sync_version(uint64_t app_version,
+                                       const partition_configuration &pc,
+                                       split_status::type meta_split_status)
+{
+    binary_writer writer;
+    dsn::marshall(writer, pc, DSF_THRIFT_BINARY);
+    writer.write(static_cast<int32_t>(meta_split_status));
+    blob data = writer.get_buffer();
+    return static_cast<int64_t>(utils::crc64_calc(data.data(), data.length(), app_version));
+}
+
 // partition server => meta server
 // this is done in meta_state_thread_pool
 void server_state::on_config_sync(configuration_query_by_node_rpc rpc)
@@ -820,8 +851,12 @@ void server_state::on_config_sync(configuration_query_by_node_rpc rpc)
             response.err = ERR_OBJECT_NOT_FOUND;
         } else {
             response.err = ERR_OK;
-            unsigned int i = 0;
-            response.partitions.resize(ns->partition_count());
+            // the replica server asks only for the changed partitions
+            bool is_delta = request.__isset.partition_versions;
+            std::unordered_map<int32_t, uint64_t> app_versions;
+            // the infos of the apps are sent only if some of their partitions are changed
+            std::set<int32_t> changed_app_ids;
+            response.partitions.reserve(ns->partition_count());
             ns->for_each_partition([&, this](const gpid &pid) {
                 std::shared_ptr<app_state> app = get_app(pid.get_app_id());
                 dassert(app != nullptr, "invalid app_id, app_id = %d", pid.get_app_id());
@@ -835,26 +870,60 @@ void server_state::on_config_sync(configuration_query_by_node_rpc rpc)
                     // when register child partition, stage is config_status::pending_remote_sync,
                     // but cc.pending_sync_request is not set, see more in function
                     // 'register_child_on_meta'
-                    if (req == nullptr || req->node == request.node)
+                    if (req == nullptr || req->node == request.node) {
+                        reject_this_request = true;
                         return false;
+                    }
                 }
 
-                response.partitions[i].info = *app;
-                response.partitions[i].config = app->partitions[pid.get_partition_index()];
-                response.partitions[i].host_node = request.node;
-                // set meta_split_status
+                split_status::type meta_split_status = split_status::NOT_SPLIT;
                 const split_state &app_split_states = app->helpers->split_states;
                 if (app->splitting()) {
                     auto iter = app_split_states.status.find(pid.get_partition_index());
                     if (iter != app_split_states.status.end()) {
-                        response.partitions[i].__set_meta_split_status(iter->second);
+                        meta_split_status = iter->second;
+                    }
+                }
+
+                int64_t version = 0;
+                if (is_delta) {
+                    auto app_version = app_versions.find(app->app_id);
+                    if (app_version == app_versions.end()) {
+                        app_version = app_versions.emplace(app->app_id, get_sync_version(*app))
+                                          .first;
                     }
+                    version = get_sync_version(app_version->second,
+                                               app->partitions[pid.get_partition_index()],
+                                               meta_split_status);
+                    auto known = request.partition_versions.find(pid);
+                    if (known != request.partition_versions.end() && known->second == version) {
+                        response.unchanged_partitions.push_back(pid);
+                        return true;
+                    }
+                }
+
+                response.partitions.emplace_back();
+                configuration_update_request &partition = response.partitions.back();
+                if (is_delta) {
+                    response.partition_versions.emplace(pid, version);
+                    changed_app_ids.insert(app->app_id);
+                } else {
+                    partition.info = *app;
+                }
+                partition.config = app->partitions[pid.get_partition_index()];
+                partition.host_node = request.node;
+                if (meta_split_status != split_status::NOT_SPLIT) {
+                    partition.__set_meta_split_status(meta_split_status);
                 }
-                ++i;
                 return true;
             });
-            if (i < response.partitions.size()) {
-                reject_this_request = true;
+            if (is_delta) {
+                for (int32_t app_id : changed_app_ids) {
+                    response.apps.push_back(*get_app(app_id));
+                }
+                response.__isset.apps = true;
+                response.__isset.partition_versions = true;
+                response.__isset.unchanged_partitions = true;
             }
         }
 
@@ -952,6 +1021,9 @@ void server_state::on_config_sync(configuration_query_by_node_rpc rpc)
     if (reject_this_request) {
         response.err = ERR_BUSY;
         response.partitions.clear();
+        response.apps.clear();
+        response.partition_versions.clear();
+        response.unchanged_partitions.clear();
     }
     ddebug_f("send config sync response to {}, err({}), partitions_count({}), "
              "gc_replicas_count({})",
@@ -1051,8 +1123,7 @@ void server_state::init_app_partition_node(std::shared_ptr<app_state> &app,
     };
 
     std::string app_partition_path = get_partition_path(*app, pidx);
-    dsn::blob value =
-        dsn::json::json_forwarder<partition_configuration>::encode(app->partitions[pidx]);
+    dsn::blob value = encode_partition_config(app->partitions[pidx]);
     _meta_svc->get_remote_storage()->create_node(
         app_partition_path, LPC_META_STATE_HIGH, on_create_app_partition, value);
 }
@@ -1601,10 +1672,10 @@ task_ptr server_state::update_configuration_on_remote(
     partition_configuration &pc = config_request->config;
     std::string storage_path = get_partition_path(pc.pid);
 
-    blob json_config = dsn::json::json_forwarder<partition_configuration>::encode(pc);
+    blob config = encode_partition_config(pc);
     return _meta_svc->get_remote_storage()->set_data(
         storage_path,
-        json_config,
+        config,
         LPC_META_STATE_HIGH,
         std::bind(&server_state::on_update_configuration_on_remote_reply,
                   this,
@@ -1694,10 +1765,10 @@ void server_state::recall_partition(std::shared_ptr<app_state> &app, int pidx)
     dassert((pc.partition_flags & pc_flags::dropped), "");
 
     pc.partition_flags = 0;
-    blob json_partition = dsn::json::json_forwarder<partition_configuration>::encode(pc);
+    blob value = encode_partition_config(pc);
     std::string partition_path = get_partition_path(pc.pid);
     _meta_svc->get_remote_storage()->set_data(
-        partition_path, json_partition, LPC_META_STATE_HIGH, on_recall_partition);
+        partition_path, value, LPC_META_STATE_HIGH, on_recall_partition);
 }
 
 void server_state::drop_partition(std::shared_ptr<app_state> &app, int pidx)
@@ -3630,11 +3701,10 @@ task_ptr server_state::update_partition_max_replica_count_on_remote(
              new_ballot);
 
     auto partition_path = get_partition_path(gpid);
-    auto json_config =
-        dsn::json::json_forwarder<partition_configuration>::encode(new_partition_config);
+    auto config = encode_partition_config(new_partition_config);
     return _meta_svc->get_remote_storage()->set_data(
         partition_path,
-        json_config,
+        config,
         LPC_META_STATE_HIGH,
         std::bind(&server_state::on_update_partition_max_replica_count_on_remote_reply,
                   this,
@@ -3833,7 +3903,7 @@ void server_state::recover_all_partitions_max_replica_count(std::shared_ptr<app_
         new_pc.max_replica_count = new_max_replica_count;
         ++(new_pc.ballot);
         auto partition_path = get_partition_path(new_pc.pid);
-        auto value = dsn::json::json_forwarder<partition_configuration>::encode(new_pc);
+        auto value = encode_partition_config(new_pc);
         _meta_svc->get_remote_storage()->set_data(
             partition_path,
             value,
@@ -155,6 +155,13 @@ public:
 
     // update configuration
     void on_config_sync(configuration_query_by_node_rpc rpc);
+    // The version of a partition in config sync is a checksum of everything synced for it,
+    // so it changes along with the partition config, the app_info or the split status, and
+    // needs no bookkeeping at the places changing them.
+    static uint64_t get_sync_version(const app_info &info);
+    static int64_t get_sync_version(uint64_t app_version,
+                                    const partition_configuration &pc,
+                                    split_status::type meta_split_status);
     void on_update_configuration(std::shared_ptr<configuration_update_request> &request,
                                  dsn::message_ex *msg);
 
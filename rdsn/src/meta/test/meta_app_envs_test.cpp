@@ -167,6 +167,14 @@ TEST_F(meta_app_envs_test, update_app_envs_test)
         {replica_envs::DENY_CLIENT_REQUEST, "timeout*all", ERR_OK, "", "timeout*all"},
         {replica_envs::DENY_CLIENT_REQUEST, "timeout*write", ERR_OK, "", "timeout*write"},
         {replica_envs::DENY_CLIENT_REQUEST, "timeout*read", ERR_OK, "", "timeout*read"},
+        {replica_envs::LOG_BLOCK_COMPRESSION, "lz4", ERR_OK, "", "lz4"},
+        {replica_envs::LOG_BLOCK_COMPRESSION, "zstd", ERR_OK, "", "zstd"},
+        {replica_envs::LOG_BLOCK_COMPRESSION, "none", ERR_OK, "", "none"},
+        {replica_envs::LOG_BLOCK_COMPRESSION,
+         "snappy",
+         ERR_INVALID_PARAMETERS,
+         "invalid string snappy, should be \"none\", \"lz4\" or \"zstd\"",
+         "none"},
         {"not_exist_env",
          "500",
          ERR_INVALID_PARAMETERS,
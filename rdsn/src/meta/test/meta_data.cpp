@@ -25,9 +25,16 @@
  */
 
 #include <gtest/gtest.h>
+#include <dsn/utility/flags.h>
 #include "misc/misc.h"
 #include "meta/meta_data.h"
 
+namespace dsn {
+namespace replication {
+DSN_DECLARE_string(partition_config_encoding);
+} // namespace replication
+} // namespace dsn
+
 using namespace dsn::replication;
 
 TEST(meta_data, dropped_cmp)
@@ -453,3 +460,29 @@ TEST(meta_data, construct_replica)
         ASSERT_EQ(2, cc.prefered_dropped);
     }
 }
+
+TEST(meta_data, partition_config_encoding)
+{
+    dsn::partition_configuration pc;
+    pc.pid = dsn::gpid(1, 2);
+    pc.ballot = 234;
+    pc.max_replica_count = 3;
+    pc.primary = dsn::rpc_address("127.0.0.1", 1);
+    pc.secondaries = {dsn::rpc_address("127.0.0.1", 2), dsn::rpc_address("127.0.0.1", 3)};
+    pc.last_drops = {dsn::rpc_address("127.0.0.1", 4)};
+    pc.last_committed_decree = 157;
+    pc.partition_flags = pc_flags::dropped;
+
+    const char *old_encoding = FLAGS_partition_config_encoding;
+    for (const char *encoding : {"json", "thrift"}) {
+        FLAGS_partition_config_encoding = encoding;
+        dsn::blob value = encode_partition_config(pc);
+        ASSERT_EQ(strcmp(encoding, "json") == 0, value.data()[0] == '{');
+
+        // both encodings can always be decoded, whatever the current one is
+        dsn::partition_configuration decoded;
+        ASSERT_TRUE(decode_partition_config(value, decoded));
+        ASSERT_EQ(pc, decoded);
+    }
+    FLAGS_partition_config_encoding = old_encoding;
+}
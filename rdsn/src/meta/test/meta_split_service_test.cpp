@@ -158,6 +158,15 @@ public:
         return rpc.response();
     }
 
+    configuration_query_by_node_response config_sync(configuration_query_by_node_request req)
+    {
+        auto request = make_unique<configuration_query_by_node_request>(req);
+        configuration_query_by_node_rpc rpc(std::move(request), RPC_CM_CONFIG_SYNC);
+        _ss->on_config_sync(rpc);
+        wait_all();
+        return rpc.response();
+    }
+
     int32_t on_config_sync(configuration_query_by_node_request req)
     {
         auto request = make_unique<configuration_query_by_node_request>(req);
@@ -502,6 +511,71 @@ TEST_F(meta_split_service_test, on_config_sync_test)
     drop_app("not_splitting_app");
 }
 
+TEST_F(meta_split_service_test, on_config_sync_delta_test)
+{
+    create_app("another_app");
+    auto another_app = find_app("another_app");
+    gpid pid1 = gpid(app->app_id, 0);
+    gpid pid2 = gpid(app->app_id, 1);
+    gpid pid3 = gpid(another_app->app_id, 0);
+    node_state node;
+    node.put_partition(pid1, true);
+    node.put_partition(pid2, true);
+    node.put_partition(pid3, true);
+    mock_node_state(NODE, node);
+
+    configuration_query_by_node_request req;
+    req.node = NODE;
+    req.__isset.partition_versions = true;
+
+    // the replica server knows nothing: every partition is synced, with app_info deduplicated
+    auto resp = config_sync(req);
+    ASSERT_EQ(ERR_OK, resp.err);
+    ASSERT_EQ(3, resp.partitions.size());
+    ASSERT_EQ(2, resp.apps.size());
+    ASSERT_EQ(3, resp.partition_versions.size());
+    ASSERT_TRUE(resp.unchanged_partitions.empty());
+    for (const auto &p : resp.partitions) {
+        ASSERT_TRUE(p.info.envs.empty());
+        ASSERT_EQ(0, p.info.app_id);
+    }
+
+    // nothing changed since
+    req.partition_versions = resp.partition_versions;
+    resp = config_sync(req);
+    ASSERT_EQ(ERR_OK, resp.err);
+    ASSERT_TRUE(resp.partitions.empty());
+    ASSERT_TRUE(resp.apps.empty());
+    ASSERT_EQ(3, resp.unchanged_partitions.size());
+
+    // a changed partition config and a changed app_info
+    app->partitions[1].ballot++;
+    another_app->envs["test_key"] = "test_value";
+    resp = config_sync(req);
+    ASSERT_EQ(ERR_OK, resp.err);
+    ASSERT_EQ(2, resp.partitions.size());
+    ASSERT_EQ(2, resp.apps.size());
+    ASSERT_EQ(1, resp.unchanged_partitions.size());
+    ASSERT_EQ(pid1, resp.unchanged_partitions[0]);
+    for (const auto &p : resp.partitions) {
+        ASSERT_NE(req.partition_versions[p.config.pid], resp.partition_versions[p.config.pid]);
+    }
+
+    // the request without versions gets every partition in the former format
+    resp = config_sync(configuration_query_by_node_request());
+    ASSERT_EQ(ERR_OBJECT_NOT_FOUND, resp.err);
+    configuration_query_by_node_request full_req;
+    full_req.node = NODE;
+    resp = config_sync(full_req);
+    ASSERT_EQ(3, resp.partitions.size());
+    ASSERT_FALSE(resp.__isset.apps);
+    for (const auto &p : resp.partitions) {
+        ASSERT_EQ(p.config.pid.get_app_id(), p.info.app_id);
+    }
+
+    drop_app("another_app");
+}
+
 /// control split unit tests
 TEST_F(meta_split_service_test, pause_or_restart_single_partition_test)
 {
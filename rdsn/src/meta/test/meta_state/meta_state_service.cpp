@@ -123,6 +123,29 @@ void provider_basic_test(const service_creator_func &service_creator,
                            dassert(read_value == 0xbeefdead, "get_value != create_value");
                        })
             ->wait();
+        service
+            ->get_data_batch({"/1", "/1/not_exist"},
+                             META_STATE_SERVICE_SIMPLE_TEST_CALLBACK,
+                             [](const std::vector<error_code> &ecs,
+                                const std::vector<dsn::blob> &values) {
+                                 dassert(ecs.size() == 2 && values.size() == 2,
+                                         "batch size mismatch");
+                                 expect_ok(ecs[0]);
+                                 expect_err(ecs[1]);
+                                 dsn::binary_reader reader(values[0]);
+                                 int read_value;
+                                 reader.read(read_value);
+                                 dassert(read_value == 0xbeefdead, "get_value != set_value");
+                             })
+            ->wait();
+        service
+            ->get_data_batch({},
+                             META_STATE_SERVICE_SIMPLE_TEST_CALLBACK,
+                             [](const std::vector<error_code> &ecs,
+                                const std::vector<dsn::blob> &values) {
+                                 dassert(ecs.empty() && values.empty(), "batch should be empty");
+                             })
+            ->wait();
     }
     // clean the node created in previos code-block, to support test in next round
     {
@@ -28,6 +28,15 @@ include "../dsn.thrift"
 
 namespace cpp dsn.service
 
+// how a chunk is compressed on the wire, negotiated per copy: the client asks for a
+// type in copy_request, and the server answers with the type it actually used
+enum nfs_compression_type
+{
+    NONE = 0,
+    LZ4 = 1,
+    ZSTD = 2
+}
+
 struct copy_request
 {
     1: dsn.rpc_address source;
@@ -39,6 +48,7 @@ struct copy_request
     7: bool is_last;
     8: bool overwrite;
     9: optional string source_disk_tag;
+    10: optional nfs_compression_type compression_type;
 }
 
 struct copy_response
@@ -47,6 +57,10 @@ struct copy_response
     2: dsn.blob file_content;
     3: i64 offset;
     4: i32 size;
+    // unset if file_content is not compressed
+    5: optional nfs_compression_type compression_type;
+    // crc32 of the uncompressed chunk, verified by the client before writing it
+    6: optional i32 chunk_crc;
 }
 
 struct get_file_size_request
@@ -0,0 +1,119 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "nfs_chunk_codec.h"
+
+#include <lz4.h>
+#include <strings.h>
+#include <zstd.h>
+
+#include <dsn/utility/utils.h>
+
+namespace dsn {
+namespace service {
+
+// favor speed over ratio, the chunk is on the critical path of learning
+static const int ZSTD_CHUNK_LEVEL = 1;
+
+bool parse_compression_type(const std::string &name, nfs_compression_type::type &type)
+{
+    if (strcasecmp(name.c_str(), "none") == 0) {
+        type = nfs_compression_type::NONE;
+    } else if (strcasecmp(name.c_str(), "lz4") == 0) {
+        type = nfs_compression_type::LZ4;
+    } else if (strcasecmp(name.c_str(), "zstd") == 0) {
+        type = nfs_compression_type::ZSTD;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool compress_chunk(nfs_compression_type::type type, const blob &raw, blob &compressed)
+{
+    size_t bound;
+    switch (type) {
+    case nfs_compression_type::LZ4:
+        bound = static_cast<size_t>(LZ4_compressBound(static_cast<int>(raw.length())));
+        break;
+    case nfs_compression_type::ZSTD:
+        bound = ZSTD_compressBound(raw.length());
+        break;
+    default:
+        return false;
+    }
+    if (bound == 0) {
+        return false;
+    }
+
+    std::shared_ptr<char> buf = utils::make_shared_array<char>(bound);
+    size_t len;
+    if (type == nfs_compression_type::LZ4) {
+        int ret = LZ4_compress_default(
+            raw.data(), buf.get(), static_cast<int>(raw.length()), static_cast<int>(bound));
+        if (ret <= 0) {
+            return false;
+        }
+        len = static_cast<size_t>(ret);
+    } else {
+        len = ZSTD_compress(buf.get(), bound, raw.data(), raw.length(), ZSTD_CHUNK_LEVEL);
+        if (ZSTD_isError(len)) {
+            return false;
+        }
+    }
+
+    if (len >= raw.length()) {
+        return false;
+    }
+    compressed = blob(std::move(buf), static_cast<unsigned int>(len));
+    return true;
+}
+
+bool decompress_chunk(nfs_compression_type::type type,
+                      const blob &compressed,
+                      uint32_t raw_size,
+                      blob &raw)
+{
+    std::shared_ptr<char> buf = utils::make_shared_array<char>(raw_size);
+    switch (type) {
+    case nfs_compression_type::LZ4: {
+        int ret = LZ4_decompress_safe(compressed.data(),
+                                      buf.get(),
+                                      static_cast<int>(compressed.length()),
+                                      static_cast<int>(raw_size));
+        if (ret < 0 || static_cast<uint32_t>(ret) != raw_size) {
+            return false;
+        }
+        break;
+    }
+    case nfs_compression_type::ZSTD: {
+        size_t ret = ZSTD_decompress(buf.get(), raw_size, compressed.data(), compressed.length());
+        if (ZSTD_isError(ret) || ret != raw_size) {
+            return false;
+        }
+        break;
+    }
+    default:
+        return false;
+    }
+
+    raw = blob(std::move(buf), raw_size);
+    return true;
+}
+
+} // namespace service
+} // namespace dsn
@@ -0,0 +1,46 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <string>
+
+#include <dsn/utility/blob.h>
+
+#include "nfs_types.h"
+
+namespace dsn {
+namespace service {
+
+// Parses "none", "lz4" or "zstd" (case insensitive), returns false for unknown names.
+bool parse_compression_type(const std::string &name, /*out*/ nfs_compression_type::type &type);
+
+// Compresses a chunk of file content before it is sent.
+// Returns false if the chunk can't be compressed or doesn't shrink, then it's sent as is.
+bool compress_chunk(nfs_compression_type::type type,
+                    const blob &raw,
+                    /*out*/ blob &compressed);
+
+// Restores a chunk compressed by compress_chunk(), whose original size is `raw_size`.
+// Returns false if the compressed data is corrupted.
+bool decompress_chunk(nfs_compression_type::type type,
+                      const blob &compressed,
+                      uint32_t raw_size,
+                      /*out*/ blob &raw);
+
+} // namespace service
+} // namespace dsn
@@ -28,11 +28,15 @@
 
 #include <fcntl.h>
 
+#include <fstream>
 #include <queue>
 
+#include <dsn/utility/crc.h>
 #include <dsn/utility/filesystem.h>
 #include <dsn/tool-api/command_manager.h>
 
+#include "nfs_chunk_codec.h"
+
 namespace dsn {
 namespace service {
 static uint32_t current_max_copy_rate_megabytes = 0;
@@ -86,14 +90,31 @@ DSN_DEFINE_int32("nfs",
                  1e5, // 100s
                  "rpc timeout in milliseconds for nfs copy, "
                  "0 means use default timeout of rpc engine");
+DSN_DEFINE_string("nfs",
+                  nfs_copy_compression_type,
+                  "none",
+                  "compression of the copied chunks on the wire: none, lz4 or zstd. "
+                  "servers not supporting it send the chunks uncompressed");
+DSN_DEFINE_validator(nfs_copy_compression_type, [](const char *value) -> bool {
+    nfs_compression_type::type type;
+    return parse_compression_type(value, type);
+});
+DSN_DEFINE_uint32("nfs",
+                  nfs_copy_manifest_interval_bytes,
+                  64 * 1024 * 1024,
+                  "how many bytes of a file are written between two persisted copy manifests, "
+                  "which let an interrupted copy resume. zero means never resuming copies");
 
 nfs_client_impl::nfs_client_impl()
     : _concurrent_copy_request_count(0),
       _concurrent_local_write_count(0),
       _buffered_local_write_count(0),
       _copy_requests_low(FLAGS_max_file_copy_request_count_per_file),
-      _high_priority_remaining_time(FLAGS_high_priority_speed_rate)
+      _high_priority_remaining_time(FLAGS_high_priority_speed_rate),
+      _compression_type(nfs_compression_type::NONE)
 {
+    parse_compression_type(FLAGS_nfs_copy_compression_type, _compression_type);
+
     _recent_copy_data_size.init_app_counter("eon.nfs_client",
                                             "recent_copy_data_size",
                                             COUNTER_TYPE_VOLATILE_NUMBER,
@@ -177,9 +198,17 @@ void nfs_client_impl::end_get_file_size(::dsn::error_code err,
         file_context_ptr filec(new file_context(ureq, resp.file_list[i], resp.size_list[i]));
         ureq->file_contexts[i] = filec;
 
+        filec->resume_offset = load_copy_manifest(ureq, filec);
+        filec->persisted_offset = filec->resume_offset;
+        if (filec->resume_offset > 0 && filec->resume_offset == filec->file_size) {
+            // copied completely by a former copy
+            ++ureq->finished_files;
+            continue;
+        }
+
         // init copy requests
-        uint64_t size = resp.size_list[i];
-        uint64_t req_offset = 0;
+        uint64_t size = resp.size_list[i] - filec->resume_offset;
+        uint64_t req_offset = filec->resume_offset;
         uint32_t req_size = size > FLAGS_nfs_copy_block_bytes ? FLAGS_nfs_copy_block_bytes
                                                               : static_cast<uint32_t>(size);
 
@@ -215,6 +244,9 @@ void nfs_client_impl::end_get_file_size(::dsn::error_code err,
                 _copy_requests_high.end(), copy_requests.begin(), copy_requests.end());
         else
             _copy_requests_low.push(std::move(copy_requests));
+    } else if (ureq->finished_files == static_cast<int>(ureq->file_contexts.size())) {
+        handle_completion(ureq, ERR_OK);
+        return;
     }
 
     tasking::enqueue(LPC_NFS_COPY_FILE, nullptr, [this]() { continue_copy(); }, 0);
@@ -291,6 +323,9 @@ void nfs_client_impl::continue_copy()
                 copy_req.overwrite = ureq->file_size_req.overwrite;
                 copy_req.is_last = req->is_last;
                 copy_req.__set_source_disk_tag(ureq->file_size_req.source_disk_tag);
+                if (_compression_type != nfs_compression_type::NONE) {
+                    copy_req.__set_compression_type(_compression_type);
+                }
                 req->remote_copy_task =
                     async_nfs_copy(copy_req,
                                    [=](error_code err, copy_response &&resp) {
@@ -333,6 +368,11 @@ void nfs_client_impl::end_copy(::dsn::error_code err,
         err = resp.error;
     }
 
+    blob content;
+    if (err == ERR_OK) {
+        err = decode_chunk(resp, reqc, content);
+    }
+
     if (err != ::dsn::ERR_OK) {
         _recent_copy_fail_count->increment();
 
@@ -373,6 +413,7 @@ void nfs_client_impl::end_copy(::dsn::error_code err,
         _recent_copy_data_size->add(resp.size);
 
         reqc->response = resp;
+        reqc->response.file_content = std::move(content);
         reqc->is_ready_for_write = true;
 
         // prepare write requests
@@ -457,8 +498,9 @@ void nfs_client_impl::continue_write()
         // double check
         zauto_lock l(fc->user_req->user_req_lock);
         if (!fc->file_holder->file_handle) {
-            fc->file_holder->file_handle =
-                file::open(file_path.c_str(), O_RDWR | O_CREAT | O_BINARY, 0666);
+            // a resumed file keeps its verified content, a fresh one drops any stale content
+            int flag = O_RDWR | O_CREAT | O_BINARY | (fc->resume_offset > 0 ? 0 : O_TRUNC);
+            fc->file_holder->file_handle = file::open(file_path.c_str(), flag, 0666);
         }
     }
 
@@ -469,6 +511,8 @@ void nfs_client_impl::continue_write()
     } else {
         zauto_lock l(reqc->lock);
         if (reqc->is_valid) {
+            // file_content shares memory with the received message, so the chunk goes from
+            // the socket to the file without an extra copy
             reqc->local_write_task = file::write(fc->file_holder->file_handle,
                                                  reqc->response.file_content.data(),
                                                  reqc->response.size,
@@ -513,18 +557,40 @@ void nfs_client_impl::end_write(error_code err, size_t sz, const copy_request_ex
     } else {
         _recent_write_data_size->add(sz);
 
+        // we use temp_holder to make file closing out of lock.
         file_wrapper_ptr temp_holder;
-        zauto_lock l(fc->user_req->user_req_lock);
-        if (!fc->user_req->is_finished &&
-            ++fc->finished_segments == (int)fc->copy_requests.size()) {
-            // release file to make it closed immediately after write done.
-            // we use temp_holder to make file closing out of lock.
-            temp_holder = std::move(fc->file_holder);
-
-            if (++fc->user_req->finished_files == (int)fc->user_req->file_contexts.size()) {
-                completed = true;
+        uint64_t verified_offset = 0;
+        {
+            zauto_lock l(fc->user_req->user_req_lock);
+            if (!fc->user_req->is_finished) {
+                reqc->is_written = true;
+                while (fc->verified_segments < (int)fc->copy_requests.size() &&
+                       fc->copy_requests[fc->verified_segments]->is_written) {
+                    const copy_request_ex_ptr &verified =
+                        fc->copy_requests[fc->verified_segments++];
+                    verified_offset = verified->offset + verified->size;
+                }
+
+                temp_holder = fc->file_holder;
+                if (++fc->finished_segments == (int)fc->copy_requests.size()) {
+                    // release file to make it closed immediately after write done.
+                    fc->file_holder = nullptr;
+
+                    if (++fc->user_req->finished_files ==
+                        (int)fc->user_req->file_contexts.size()) {
+                        completed = true;
+                    }
+                }
             }
         }
+
+        // the last chunk of a file is always persisted, so a completed file is never copied
+        // again by a resumed copy
+        if (verified_offset > 0 &&
+            (verified_offset == fc->file_size ||
+             verified_offset >= fc->persisted_offset + FLAGS_nfs_copy_manifest_interval_bytes)) {
+            persist_copy_manifest(fc, temp_holder, verified_offset);
+        }
     }
 
     if (completed) {
@@ -537,7 +603,8 @@ void nfs_client_impl::end_write(error_code err, size_t sz, const copy_request_ex
 
 void nfs_client_impl::handle_completion(const user_request_ptr &req, error_code err)
 {
-    // ATTENTION: only here we may lock for two level (user_req_lock -> copy_request_ex.lock)
+    // ATTENTION: only here we may lock for two level (user_req_lock -> copy_request_ex.lock,
+    // user_req_lock -> file_context.manifest_lock)
     zauto_lock l(req->user_req_lock);
 
     // make sure this function can only be executed for once
@@ -554,6 +621,12 @@ void nfs_client_impl::handle_completion(const user_request_ptr &req, error_code
                 zauto_lock l(rc->lock);
                 rc->is_valid = false;
             }
+        } else {
+            // the copy is done, nothing left to resume
+            zauto_lock l(fc->manifest_lock);
+            fc->manifest_removed = true;
+            utils::filesystem::remove_path(nfs_node::copy_manifest_path(
+                utils::filesystem::path_combine(req->file_size_req.dst_dir, fc->file_name)));
         }
         // clear copy_requests to break circle reference
         fc->copy_requests.clear();
@@ -566,6 +639,120 @@ void nfs_client_impl::handle_completion(const user_request_ptr &req, error_code
     req->nfs_task->enqueue(err, err == ERR_OK ? total_size : 0);
 }
 
+error_code nfs_client_impl::decode_chunk(const copy_response &resp,
+                                         const copy_request_ex_ptr &reqc,
+                                         blob &content)
+{
+    const file_context_ptr &fc = reqc->file_ctx;
+    if (resp.__isset.compression_type && resp.compression_type != nfs_compression_type::NONE) {
+        if (!decompress_chunk(resp.compression_type, resp.file_content, resp.size, content)) {
+            derror("{nfs_service} decompress chunk failed, source = %s, file = %s, "
+                   "offset = %" PRId64,
+                   fc->user_req->file_size_req.source.to_string(),
+                   fc->file_name.c_str(),
+                   resp.offset);
+            return ERR_CORRUPTION;
+        }
+    } else {
+        content = resp.file_content;
+    }
+
+    if (content.length() < static_cast<unsigned int>(resp.size) ||
+        (resp.__isset.chunk_crc &&
+         utils::crc32_calc(content.data(), resp.size, 0) !=
+             static_cast<uint32_t>(resp.chunk_crc))) {
+        derror("{nfs_service} chunk checksum mismatch, source = %s, file = %s, offset = %" PRId64,
+               fc->user_req->file_size_req.source.to_string(),
+               fc->file_name.c_str(),
+               resp.offset);
+        return ERR_CORRUPTION;
+    }
+    return ERR_OK;
+}
+
+uint64_t nfs_client_impl::load_copy_manifest(const user_request_ptr &ureq,
+                                             const file_context_ptr &fc)
+{
+    if (FLAGS_nfs_copy_manifest_interval_bytes == 0) {
+        return 0;
+    }
+
+    std::string dst_file =
+        utils::filesystem::path_combine(ureq->file_size_req.dst_dir, fc->file_name);
+    std::string manifest_file = nfs_node::copy_manifest_path(dst_file);
+    if (!utils::filesystem::file_exists(manifest_file)) {
+        return 0;
+    }
+
+    // a manifest of another remote file, or of a file changed since, is stale, and then
+    // the file is copied from scratch
+    std::string data;
+    copy_manifest manifest;
+    int64_t dst_size = 0;
+    if (utils::filesystem::read_file(manifest_file, data) != ERR_OK ||
+        !json::json_forwarder<copy_manifest>::decode(blob::create_from_bytes(std::move(data)),
+                                                     manifest) ||
+        manifest.source != ureq->file_size_req.source.to_string() ||
+        manifest.source_file !=
+            utils::filesystem::path_combine(ureq->file_size_req.source_dir, fc->file_name) ||
+        manifest.file_size != static_cast<int64_t>(fc->file_size) ||
+        manifest.verified_offset <= 0 || manifest.verified_offset > manifest.file_size ||
+        !utils::filesystem::file_size(dst_file, dst_size) ||
+        dst_size < manifest.verified_offset) {
+        utils::filesystem::remove_path(manifest_file);
+        return 0;
+    }
+
+    ddebug("{nfs_service} resume copying file %s from offset %" PRId64 ", file_size = %" PRIu64,
+           dst_file.c_str(),
+           manifest.verified_offset,
+           fc->file_size);
+    return static_cast<uint64_t>(manifest.verified_offset);
+}
+
+void nfs_client_impl::persist_copy_manifest(const file_context_ptr &fc,
+                                            const file_wrapper_ptr &holder,
+                                            uint64_t verified_offset)
+{
+    if (FLAGS_nfs_copy_manifest_interval_bytes == 0) {
+        return;
+    }
+
+    zauto_lock l(fc->manifest_lock);
+    if (fc->manifest_removed || verified_offset <= fc->persisted_offset) {
+        return;
+    }
+
+    // the manifest must never claim data that a crash could lose
+    if (holder->file_handle == nullptr || file::flush(holder->file_handle) != ERR_OK) {
+        return;
+    }
+
+    const user_request_ptr &ureq = fc->user_req;
+    copy_manifest manifest;
+    manifest.source = ureq->file_size_req.source.to_string();
+    manifest.source_file =
+        utils::filesystem::path_combine(ureq->file_size_req.source_dir, fc->file_name);
+    manifest.file_size = static_cast<int64_t>(fc->file_size);
+    manifest.verified_offset = static_cast<int64_t>(verified_offset);
+    blob data = json::json_forwarder<copy_manifest>::encode(manifest);
+
+    std::string manifest_file = nfs_node::copy_manifest_path(
+        utils::filesystem::path_combine(ureq->file_size_req.dst_dir, fc->file_name));
+    std::string tmp_file = manifest_file + ".tmp";
+    {
+        std::ofstream out(tmp_file, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), data.length());
+        if (!out.good()) {
+            dwarn("{nfs_service} write copy manifest %s failed", tmp_file.c_str());
+            return;
+        }
+    }
+    if (utils::filesystem::rename_path(tmp_file, manifest_file)) {
+        fc->persisted_offset = verified_offset;
+    }
+}
+
 // todo(jiashuo1) just for compatibility with scripts, such as
 // https://github.com/apache/incubator-pegasus/blob/v2.3/scripts/pegasus_offline_node_list.sh
 void nfs_client_impl::register_cli_commands()
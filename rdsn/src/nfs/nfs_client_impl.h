@@ -38,6 +38,7 @@
 #include <dsn/utility/flags.h>
 #include <dsn/tool-api/async_calls.h>
 #include <dsn/utils/token_buckets.h>
+#include <dsn/cpp/json_helper.h>
 
 #include "nfs_types.h"
 #include "nfs_code_definition.h"
@@ -109,6 +110,7 @@ public:
         ::dsn::task_ptr remote_copy_task;
         ::dsn::task_ptr local_write_task;
         bool is_ready_for_write;
+        bool is_written;
         bool is_valid;
         int retry_count;
         zlock lock; // to protect is_valid
@@ -121,6 +123,7 @@ public:
             size = 0;
             is_last = false;
             is_ready_for_write = false;
+            is_written = false;
             is_valid = true;
             retry_count = try_count;
         }
@@ -138,6 +141,15 @@ public:
         int finished_segments;
         std::vector<copy_request_ex_ptr> copy_requests;
 
+        // the offset an interrupted copy of this file is resumed from, zero for a fresh copy
+        uint64_t resume_offset;
+        // copy_requests[0, verified_segments) are written, chunks may finish out of order
+        int verified_segments;
+
+        zlock manifest_lock; // to serialize writing the manifest and protect manifest_removed
+        std::atomic<uint64_t> persisted_offset;
+        bool manifest_removed;
+
         file_context(const user_request_ptr &req, const std::string &file_nm, uint64_t sz)
         {
             user_req = req;
@@ -146,9 +158,25 @@ public:
             file_holder = new file_wrapper();
             current_write_index = -1;
             finished_segments = 0;
+            resume_offset = 0;
+            verified_segments = 0;
+            persisted_offset = 0;
+            manifest_removed = false;
         }
     };
 
+    // Persisted beside a file being copied (see nfs_node::copy_manifest_path), it records
+    // how much of the file is written and verified, so a copy interrupted by a failure or
+    // a restart resumes from there instead of copying the file again.
+    struct copy_manifest
+    {
+        std::string source;      // address of the remote node
+        std::string source_file; // path of the file on the remote node
+        int64_t file_size;
+        int64_t verified_offset;
+        DEFINE_JSON_SERIALIZATION(source, source_file, file_size, verified_offset)
+    };
+
     struct user_request : public ::dsn::ref_counter
     {
         zlock user_req_lock;
@@ -271,6 +299,19 @@ private:
 
     void end_write(error_code err, size_t sz, const copy_request_ex_ptr &reqc);
 
+    // decompresses the chunk in `resp` if needed, and checks it against the crc of the server
+    error_code decode_chunk(const copy_response &resp,
+                            const copy_request_ex_ptr &reqc,
+                            /*out*/ blob &content);
+
+    // returns the offset from which the copy of the file can be resumed, zero if there's no
+    // matching manifest left by a former copy
+    uint64_t load_copy_manifest(const user_request_ptr &ureq, const file_context_ptr &fc);
+
+    void persist_copy_manifest(const file_context_ptr &fc,
+                               const file_wrapper_ptr &holder,
+                               uint64_t verified_offset);
+
     void handle_completion(const user_request_ptr &req, error_code err);
 
     void register_cli_commands();
@@ -299,6 +340,8 @@ private:
     perf_counter_wrapper _recent_write_data_size;
     perf_counter_wrapper _recent_write_fail_count;
 
+    nfs_compression_type::type _compression_type;
+
     dsn_handle_t _nfs_max_copy_rate_megabytes_cmd;
 
     dsn::task_tracker _tracker;
@@ -102,4 +102,9 @@ aio_task_ptr nfs_node::copy_remote_files(std::shared_ptr<remote_copy_request> &r
     call(request, cb);
     return cb;
 }
+
+std::string nfs_node::copy_manifest_path(const std::string &dest_file)
+{
+    return dest_file + ".nfs_manifest";
+}
 }
@@ -31,9 +31,12 @@
 
 #include <cstdlib>
 
+#include <dsn/utility/crc.h>
 #include <dsn/utility/filesystem.h>
 #include <dsn/tool-api/async_calls.h>
 
+#include "nfs_chunk_codec.h"
+
 namespace dsn {
 namespace service {
 
@@ -122,6 +125,9 @@ void nfs_service_impl::on_copy(const ::dsn::service::copy_request &request,
     cp->hfile = hfile;
     cp->offset = request.offset;
     cp->size = request.size;
+    if (request.__isset.compression_type) {
+        cp->compression_type = request.compression_type;
+    }
 
     auto buffer_save = cp->bb.buffer().get();
 
@@ -163,9 +169,19 @@ void nfs_service_impl::internal_read_callback(error_code err, size_t sz, callbac
 
     ::dsn::service::copy_response resp;
     resp.error = err;
-    resp.file_content = std::move(cp.bb);
     resp.offset = cp.offset;
     resp.size = cp.size;
+    if (err == ERR_OK) {
+        resp.__set_chunk_crc(static_cast<int32_t>(utils::crc32_calc(cp.bb.data(), cp.size, 0)));
+        blob compressed;
+        if (cp.compression_type != nfs_compression_type::NONE &&
+            compress_chunk(cp.compression_type, cp.bb, compressed)) {
+            resp.__set_compression_type(cp.compression_type);
+            cp.bb = std::move(compressed);
+        }
+    }
+    // the chunk is linked into the response message rather than copied, see blob::write
+    resp.file_content = std::move(cp.bb);
 
     cp.replier(resp);
 }
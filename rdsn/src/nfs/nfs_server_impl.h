@@ -78,10 +78,15 @@ private:
         blob bb;
         uint64_t offset;
         uint32_t size;
+        nfs_compression_type::type compression_type;
         rpc_replier<copy_response> replier;
 
         callback_para(rpc_replier<copy_response> &&r)
-            : hfile(nullptr), offset(0), size(0), replier(std::move(r))
+            : hfile(nullptr),
+              offset(0),
+              size(0),
+              compression_type(nfs_compression_type::NONE),
+              replier(std::move(r))
         {
         }
         callback_para(callback_para &&r)
@@ -91,6 +96,7 @@ private:
               bb(std::move(r.bb)),
               offset(r.offset),
               size(r.size),
+              compression_type(r.compression_type),
               replier(std::move(r.replier))
         {
             r.hfile = nullptr;
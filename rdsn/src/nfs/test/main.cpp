@@ -26,6 +26,8 @@
 
 #include <gtest/gtest.h>
 
+#include <fstream>
+
 #include <dsn/service_api_c.h>
 #include <dsn/utility/filesystem.h>
 #include <dsn/tool-api/task.h>
@@ -176,6 +178,78 @@ TEST(nfs, basic)
     nfs->stop();
 }
 
+TEST(nfs, resume_from_manifest)
+{
+    std::unique_ptr<dsn::nfs_node> nfs(dsn::nfs_node::create());
+    nfs->start();
+
+    utils::filesystem::remove_path("nfs_test_dir_resume");
+    ASSERT_TRUE(utils::filesystem::create_directory("nfs_test_dir_resume"));
+
+    int64_t file_size;
+    ASSERT_TRUE(utils::filesystem::file_size("nfs_test_file1", file_size));
+    std::string verified_content(file_size, 'x');
+    auto write_file = [](const std::string &path, const std::string &content) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << content;
+    };
+
+    // nfs_test_file1 is claimed to be copied completely, nfs_test_file2 has a stale manifest
+    std::string source = dsn::rpc_address("localhost", 20101).to_string();
+    write_file("nfs_test_dir_resume/nfs_test_file1", verified_content);
+    write_file(nfs_node::copy_manifest_path("nfs_test_dir_resume/nfs_test_file1"),
+               "{\"source\":\"" + source + "\",\"source_file\":\"" +
+                   utils::filesystem::path_combine(".", "nfs_test_file1") +
+                   "\",\"file_size\":" + std::to_string(file_size) +
+                   ",\"verified_offset\":" + std::to_string(file_size) + "}");
+    write_file("nfs_test_dir_resume/nfs_test_file2", "stale");
+    write_file(nfs_node::copy_manifest_path("nfs_test_dir_resume/nfs_test_file2"),
+               "{\"source\":\"" + source +
+                   "\",\"source_file\":\"another_file\",\"file_size\":5,"
+                   "\"verified_offset\":5}");
+
+    std::vector<std::string> files{"nfs_test_file1", "nfs_test_file2"};
+    aio_result r;
+    dsn::aio_task_ptr t = nfs->copy_remote_files(dsn::rpc_address("localhost", 20101),
+                                                 "default",
+                                                 ".",
+                                                 files,
+                                                 "default",
+                                                 "nfs_test_dir_resume",
+                                                 true,
+                                                 false,
+                                                 LPC_AIO_TEST_NFS,
+                                                 nullptr,
+                                                 [&r](dsn::error_code err, size_t sz) {
+                                                     r.err = err;
+                                                     r.sz = sz;
+                                                 },
+                                                 0);
+    ASSERT_NE(nullptr, t);
+    ASSERT_TRUE(t->wait(20000));
+    ASSERT_EQ(ERR_OK, r.err);
+
+    // the verified file is not copied again, the other one is copied from scratch
+    std::string content;
+    ASSERT_EQ(ERR_OK,
+              utils::filesystem::read_file("nfs_test_dir_resume/nfs_test_file1", content));
+    ASSERT_EQ(verified_content, content);
+
+    std::string expected;
+    ASSERT_EQ(ERR_OK, utils::filesystem::read_file("nfs_test_file2", expected));
+    ASSERT_EQ(ERR_OK,
+              utils::filesystem::read_file("nfs_test_dir_resume/nfs_test_file2", content));
+    ASSERT_EQ(expected, content);
+
+    // nothing is left to resume after the copy succeeded
+    ASSERT_FALSE(utils::filesystem::file_exists(
+        nfs_node::copy_manifest_path("nfs_test_dir_resume/nfs_test_file1")));
+    ASSERT_FALSE(utils::filesystem::file_exists(
+        nfs_node::copy_manifest_path("nfs_test_dir_resume/nfs_test_file2")));
+
+    nfs->stop();
+}
+
 int g_test_ret = 0;
 GTEST_API_ int main(int argc, char **argv)
 {
@@ -17,9 +17,32 @@
 
 #include "log_block.h"
 
+#include <lz4.h>
+#include <strings.h>
+#include <zstd.h>
+
+#include <dsn/utility/utils.h>
+
 namespace dsn {
 namespace replication {
 
+// favor speed over ratio, the block is compressed on the write path
+static const int ZSTD_LOG_BLOCK_LEVEL = 1;
+
+bool parse_log_block_codec(const std::string &name, log_block_codec &codec)
+{
+    if (strcasecmp(name.c_str(), "none") == 0) {
+        codec = log_block_codec::NONE;
+    } else if (strcasecmp(name.c_str(), "lz4") == 0) {
+        codec = log_block_codec::LZ4;
+    } else if (strcasecmp(name.c_str(), "zstd") == 0) {
+        codec = log_block_codec::ZSTD;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 log_block::log_block(int64_t start_offset) : _start_offset(start_offset) { init(); }
 
 log_block::log_block() { init(); }
@@ -33,23 +56,145 @@ void log_block::init()
     add(temp_writer.get_buffer());
 }
 
+void log_block::compress(log_block_codec codec)
+{
+    auto hdr = reinterpret_cast<log_block_header *>(const_cast<char *>(front().data()));
+    hdr->magic = LOG_BLOCK_CODEC_MAGIC + static_cast<int32_t>(log_block_codec::NONE);
+
+    const size_t raw_size = _size - sizeof(log_block_header);
+    if (codec == log_block_codec::NONE || raw_size == 0) {
+        return;
+    }
+
+    // merge the data into a continuous buffer, skip the header
+    std::shared_ptr<char> raw = utils::make_shared_array<char>(raw_size);
+    size_t pos = 0;
+    for (size_t i = 1; i < _data.size(); ++i) {
+        memcpy(raw.get() + pos, _data[i].data(), _data[i].length());
+        pos += _data[i].length();
+    }
+
+    // the compressed data is prefixed with the raw size, which lz4 requires to decompress
+    size_t bound = codec == log_block_codec::LZ4
+                       ? static_cast<size_t>(LZ4_compressBound(static_cast<int>(raw_size)))
+                       : ZSTD_compressBound(raw_size);
+    std::shared_ptr<char> buf = utils::make_shared_array<char>(sizeof(int32_t) + bound);
+    char *dst = buf.get() + sizeof(int32_t);
+    size_t len = 0;
+    if (codec == log_block_codec::LZ4) {
+        int ret = LZ4_compress_default(
+            raw.get(), dst, static_cast<int>(raw_size), static_cast<int>(bound));
+        len = ret > 0 ? static_cast<size_t>(ret) : 0;
+    } else {
+        len = ZSTD_compress(dst, bound, raw.get(), raw_size, ZSTD_LOG_BLOCK_LEVEL);
+        len = ZSTD_isError(len) ? 0 : len;
+    }
+    if (len == 0 || sizeof(int32_t) + len >= raw_size) {
+        // keep the data as is if it doesn't shrink
+        return;
+    }
+
+    int32_t raw_length = static_cast<int32_t>(raw_size);
+    memcpy(buf.get(), &raw_length, sizeof(raw_length));
+    hdr->magic = LOG_BLOCK_CODEC_MAGIC + static_cast<int32_t>(codec);
+
+    blob header = _data.front();
+    _data.clear();
+    _data.emplace_back(std::move(header));
+    _data.emplace_back(std::move(buf), static_cast<unsigned int>(sizeof(int32_t) + len));
+    _size = _data[0].length() + _data[1].length();
+}
+
+/*static*/ bool log_block::decompress(const log_block_header &hdr, const blob &data, blob &raw)
+{
+    if (!hdr.has_codec() || hdr.codec() == log_block_codec::NONE) {
+        raw = data;
+        return true;
+    }
+
+    int32_t raw_length = 0;
+    if (data.length() < sizeof(raw_length)) {
+        return false;
+    }
+    memcpy(&raw_length, data.data(), sizeof(raw_length));
+    if (raw_length <= 0) {
+        return false;
+    }
+    const char *src = data.data() + sizeof(raw_length);
+    const size_t src_size = data.length() - sizeof(raw_length);
+
+    std::shared_ptr<char> buf = utils::make_shared_array<char>(raw_length);
+    switch (hdr.codec()) {
+    case log_block_codec::LZ4: {
+        int ret = LZ4_decompress_safe(src, buf.get(), static_cast<int>(src_size), raw_length);
+        if (ret != raw_length) {
+            return false;
+        }
+        break;
+    }
+    case log_block_codec::ZSTD: {
+        size_t ret = ZSTD_decompress(buf.get(), raw_length, src, src_size);
+        if (ZSTD_isError(ret) || ret != static_cast<size_t>(raw_length)) {
+            return false;
+        }
+        break;
+    }
+    default:
+        return false;
+    }
+
+    raw = blob(std::move(buf), static_cast<unsigned int>(raw_length));
+    return true;
+}
+
 void log_appender::append_mutation(const mutation_ptr &mu, const aio_task_ptr &cb)
 {
+    dassert(!_sealed, "can't append mutations into a sealed log appender");
     _mutations.push_back(mu);
     if (cb) {
         _callbacks.push_back(cb);
     }
+    if (_deferred) {
+        _queued_bytes += mu->appro_data_bytes();
+        return;
+    }
+    write_mutation(mu);
+}
+
+void log_appender::write_mutation(const mutation_ptr &mu)
+{
     log_block *blk = &_blocks.back();
     if (blk->size() > DEFAULT_MAX_BLOCK_BYTES) {
+        if (_codec != log_block_codec::NONE) {
+            blk->compress(_codec);
+        }
         _full_blocks_size += blk->size();
         _full_blocks_blob_cnt += blk->data().size();
         int64_t new_block_start_offset = blk->start_offset() + blk->size();
         _blocks.emplace_back(new_block_start_offset);
         blk = &_blocks.back();
     }
-    mu->data.header.log_offset = blk->start_offset() + blk->size();
+    mu->data.header.log_offset = _codec == log_block_codec::NONE
+                                     ? blk->start_offset() + blk->size()
+                                     : blk->start_offset();
     mu->write_to([blk](const blob &bb) { blk->add(bb); });
 }
 
+void log_appender::seal(int64_t start_offset)
+{
+    dassert(_deferred && !_sealed, "only an appender with queued mutations can be sealed");
+    _blocks.emplace_back(start_offset);
+    for (const auto &mu : _mutations) {
+        write_mutation(mu);
+    }
+    if (_codec != log_block_codec::NONE) {
+        log_block &blk = _blocks.back();
+        // a small block is kept raw, but it's still marked with the codec magic, as its
+        // mutations take the start offset of the block
+        blk.compress(blk.size() >= MIN_COMPRESS_BLOCK_BYTES ? _codec : log_block_codec::NONE);
+    }
+    _sealed = true;
+}
+
 } // namespace replication
 } // namespace dsn
@@ -22,16 +22,50 @@
 namespace dsn {
 namespace replication {
 
+// the codec of the block data, which is recorded in the magic of log_block_header
+enum class log_block_codec
+{
+    NONE = 0,
+    LZ4 = 1,
+    ZSTD = 2,
+};
+
+// parses "none", "lz4" or "zstd", returns false for unknown names
+bool parse_log_block_codec(const std::string &name, /*out*/ log_block_codec &codec);
+
+// the magic of the blocks written with a codec is LOG_BLOCK_CODEC_MAGIC + codec.
+//
+// all mutations in such a block take the start offset of the block as their log_offset,
+// because their offsets inside the block are unknown until the block is compressed. the
+// block data may still be NONE if it's small or doesn't shrink after compression.
+//
+// older versions refuse these blocks as invalid magic, rather than misreading them.
+static constexpr int32_t LOG_BLOCK_MAGIC = static_cast<int32_t>(0xdeadbeef);
+static constexpr int32_t LOG_BLOCK_CODEC_MAGIC = static_cast<int32_t>(0xdeadc000);
+
 // each block in log file has a log_block_header
 struct log_block_header
 {
-    int32_t magic{static_cast<int32_t>(0xdeadbeef)}; // 0xdeadbeef
-    int32_t length{0};   // block data length (not including log_block_header)
-    int32_t body_crc{0}; // block data crc (not including log_block_header)
+    int32_t magic{LOG_BLOCK_MAGIC}; // LOG_BLOCK_MAGIC, or LOG_BLOCK_CODEC_MAGIC + codec
+    int32_t length{0};   // block data length on disk (not including log_block_header)
+    int32_t body_crc{0}; // block data crc on disk (not including log_block_header)
 
     // start offset of the block (including log_block_header) in this log file
     // TODO(wutao1): this field is unusable. the value is always set, but not read.
     uint32_t local_offset{0};
+
+    bool has_codec() const
+    {
+        return magic >= LOG_BLOCK_CODEC_MAGIC &&
+               magic <= LOG_BLOCK_CODEC_MAGIC + static_cast<int32_t>(log_block_codec::ZSTD);
+    }
+    bool is_valid() const { return magic == LOG_BLOCK_MAGIC || has_codec(); }
+
+    // only valid if has_codec()
+    log_block_codec codec() const
+    {
+        return static_cast<log_block_codec>(magic - LOG_BLOCK_CODEC_MAGIC);
+    }
 };
 
 // a memory structure holding data which belongs to one block.
@@ -77,6 +111,14 @@ public:
     // global offset to start writting this block
     int64_t start_offset() const { return _start_offset; }
 
+    // replaces the block data with the compressed one, and records the codec in the header.
+    // no more data can be added after that.
+    void compress(log_block_codec codec);
+
+    // restores the block data read from disk, `hdr` is its header.
+    // returns false if the data is corrupted.
+    static bool decompress(const log_block_header &hdr, const blob &data, /*out*/ blob &raw);
+
 private:
     friend class log_appender;
     void init();
@@ -88,8 +130,13 @@ private:
 class log_appender
 {
 public:
+    // the mutations are written into the blocks as they are appended
     explicit log_appender(int64_t start_offset) { _blocks.emplace_back(start_offset); }
 
+    // the mutations are only queued until seal(), which writes them into the blocks once the
+    // start offset is known, and compresses the blocks with `codec`
+    explicit log_appender(log_block_codec codec) : _codec(codec), _deferred(true) {}
+
     log_appender(int64_t start_offset, log_block &block)
     {
         block._start_offset = start_offset;
@@ -98,22 +145,47 @@ public:
 
     void append_mutation(const mutation_ptr &mu, const aio_task_ptr &cb);
 
-    size_t size() const { return _full_blocks_size + _blocks.crbegin()->size(); }
-    size_t blob_count() const { return _full_blocks_blob_cnt + _blocks.crbegin()->data().size(); }
+    // writes the queued mutations into the blocks from `start_offset` and compresses them, after
+    // that no more mutations can be appended, and size() is what will be written.
+    // only for the appender created without a start offset. it doesn't touch the state of the
+    // log, so it can be called out of the lock of the log.
+    void seal(int64_t start_offset);
+    bool is_sealed() const { return !_deferred || _sealed; }
+
+    // the approximate size of the queued mutations if not sealed yet
+    size_t size() const
+    {
+        return _blocks.empty() ? _queued_bytes : _full_blocks_size + _blocks.crbegin()->size();
+    }
+    size_t blob_count() const
+    {
+        return _blocks.empty() ? 0 : _full_blocks_blob_cnt + _blocks.crbegin()->data().size();
+    }
 
     std::vector<mutation_ptr> mutations() const { return _mutations; }
+    size_t mutation_count() const { return _mutations.size(); }
 
     // The callback registered for each write.
     const std::vector<aio_task_ptr> &callbacks() const { return _callbacks; }
 
     // Returns the heading block's start_offset.
-    int64_t start_offset() const { return _blocks.cbegin()->start_offset(); }
+    int64_t start_offset() const
+    {
+        dassert(!_blocks.empty(), "the start offset is unknown until sealed");
+        return _blocks.cbegin()->start_offset();
+    }
 
     std::vector<log_block> &all_blocks() { return _blocks; }
 
 protected:
     static constexpr size_t DEFAULT_MAX_BLOCK_BYTES = 1 * 1024 * 1024; // 1MB
 
+    // the tailing block is often small under light load, which hardly shrinks and isn't worth
+    // compressing
+    static constexpr size_t MIN_COMPRESS_BLOCK_BYTES = 4 * 1024; // 4KB
+
+    void write_mutation(const mutation_ptr &mu);
+
     // |---------------------- _blocks ----------------------|
     // | full block 0 | full block 1 | .... | unfilled block |
 
@@ -124,6 +196,13 @@ protected:
     size_t _full_blocks_blob_cnt{0};
     std::vector<aio_task_ptr> _callbacks;
     std::vector<mutation_ptr> _mutations;
+
+    // the full blocks are compressed as soon as a new block is started, so that the new
+    // block starts right after the compressed one
+    log_block_codec _codec{log_block_codec::NONE};
+    bool _deferred{false};
+    bool _sealed{false};
+    size_t _queued_bytes{0};
 };
 
 } // namespace replication
@@ -195,7 +195,29 @@ void log_file::flush() const
     }
 }
 
-error_code log_file::read_next_log_block(/*out*/ ::dsn::blob &bb)
+error_code log_file::read_next_log_block(/*out*/ ::dsn::blob &bb,
+                                         /*out*/ log_block_header *out_hdr)
+{
+    log_block_header hdr;
+    error_code err = read_next_raw_log_block(bb, hdr);
+    if (err != ERR_OK) {
+        return err;
+    }
+
+    err = restore_log_block(hdr, _crc32, bb);
+    if (err != ERR_OK) {
+        return err;
+    }
+    _crc32 = hdr.body_crc;
+
+    if (out_hdr != nullptr) {
+        *out_hdr = hdr;
+    }
+    return ERR_OK;
+}
+
+error_code log_file::read_next_raw_log_block(/*out*/ ::dsn::blob &bb,
+                                             /*out*/ log_block_header &hdr)
 {
     dassert(_is_read, "log file must be of read mode");
     auto err = _stream->read_next(sizeof(log_block_header), bb);
@@ -212,9 +234,9 @@ error_code log_file::read_next_log_block(/*out*/ ::dsn::blob &bb)
 
         return err;
     }
-    log_block_header hdr = *reinterpret_cast<const log_block_header *>(bb.data());
+    hdr = *reinterpret_cast<const log_block_header *>(bb.data());
 
-    if (hdr.magic != 0xdeadbeef) {
+    if (!hdr.is_valid()) {
         derror("invalid data header magic: 0x%x", hdr.magic);
         return ERR_INVALID_DATA;
     }
@@ -233,15 +255,23 @@ error_code log_file::read_next_log_block(/*out*/ ::dsn::blob &bb)
 
         return err;
     }
+    return ERR_OK;
+}
 
+/*static*/ error_code
+log_file::restore_log_block(const log_block_header &hdr, uint32_t prev_crc, /*inout*/ blob &bb)
+{
     auto crc = dsn::utils::crc32_calc(
-        static_cast<const void *>(bb.data()), static_cast<size_t>(hdr.length), _crc32);
+        static_cast<const void *>(bb.data()), static_cast<size_t>(hdr.length), prev_crc);
     if (crc != hdr.body_crc) {
         derror("crc checking failed");
         return ERR_INVALID_DATA;
     }
-    _crc32 = crc;
 
+    if (hdr.has_codec() && !log_block::decompress(hdr, blob(bb), bb)) {
+        derror("decompress log block failed, codec = %d", static_cast<int>(hdr.codec()));
+        return ERR_INVALID_DATA;
+    }
     return ERR_OK;
 }
 
@@ -263,6 +293,7 @@ aio_task_ptr log_file::commit_log_blocks(log_appender &pending,
 {
     dassert(!_is_read, "log file must be of write mode");
     dcheck_gt(pending.size(), 0);
+    dassert(pending.is_sealed(), "log blocks must be sealed before committed");
 
     zauto_lock lock(_write_lock);
     if (!_handle) {
@@ -277,7 +308,7 @@ aio_task_ptr log_file::commit_log_blocks(log_appender &pending,
         int64_t local_offset = block.start_offset() - start_offset();
         auto hdr = reinterpret_cast<log_block_header *>(const_cast<char *>(block.front().data()));
 
-        dassert(hdr->magic == 0xdeadbeef, "");
+        dassert(hdr->is_valid(), "");
         hdr->local_offset = local_offset;
         hdr->length = static_cast<int32_t>(block.size() - sizeof(log_block_header));
         hdr->body_crc = _crc32;
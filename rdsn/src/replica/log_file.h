@@ -112,14 +112,31 @@ public:
 
     // sync read the next log entry from the file
     // the entry data is start from the 'local_offset' of the file
-    // the result is passed out by 'bb', not including the log_block_header
+    // the result is passed out by 'bb', not including the log_block_header,
+    // compressed blocks are decompressed, 'hdr' is the header of the block if not null
     // return error codes:
     //  - ERR_OK
     //  - ERR_HANDLE_EOF
     //  - ERR_INCOMPLETE_DATA
     //  - ERR_INVALID_DATA
     //  - other io errors caused by file read operator
-    error_code read_next_log_block(/*out*/ ::dsn::blob &bb);
+    error_code read_next_log_block(/*out*/ ::dsn::blob &bb,
+                                   /*out*/ log_block_header *hdr = nullptr);
+
+    // sync read the next log entry from the file like read_next_log_block, but neither checks
+    // the crc nor decompresses it, the block could be restored by restore_log_block() later,
+    // probably in another thread.
+    // NOTE: like read_next_log_block, 'bb' may point to the buffer of the stream which is reused
+    // by the later reads, copy it if it's kept longer.
+    error_code read_next_raw_log_block(/*out*/ ::dsn::blob &bb, /*out*/ log_block_header &hdr);
+
+    // checks the crc of the data of a raw block and decompresses it.
+    // 'prev_crc' is the body_crc of the previous block in the file, or 0 for the first block.
+    // return error codes:
+    //  - ERR_OK
+    //  - ERR_INVALID_DATA
+    static error_code
+    restore_log_block(const log_block_header &hdr, uint32_t prev_crc, /*inout*/ ::dsn::blob &bb);
 
     //
     // write routines
@@ -132,6 +149,7 @@ public:
     // 'callback_host' is used to get tracer
     // 'callback' is to indicate the callback handler
     // 'hash' helps to choose which thread in the thread pool to execute the callback
+    // the blocks of 'pending' must have been sealed, see log_appender::seal()
     // returns:
     //   - non-null if io task is in pending
     //   - null if error
@@ -0,0 +1,274 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "log_replay_pipeline.h"
+#include "mutation_log_utils.h"
+
+#include <dsn/dist/fmt_logging.h>
+#include <dsn/tool-api/async_calls.h>
+
+namespace dsn {
+namespace replication {
+
+log_replay_pipeline::log_replay_pipeline(mutation_log::replay_callback callback,
+                                         int64_t max_pending_bytes)
+    : _callback(std::move(callback)), _max_pending_bytes(max_pending_bytes)
+{
+}
+
+error_code log_replay_pipeline::run(std::map<int, log_file_ptr> &logs,
+                                    /*out*/ int64_t &end_offset)
+{
+    int64_t g_start_offset = 0;
+    int64_t g_end_offset = 0;
+    if (logs.size() > 0) {
+        g_start_offset = logs.begin()->second->start_offset();
+        g_end_offset = logs.rbegin()->second->end_offset();
+    }
+
+    error_s error = log_utils::check_log_files_continuity(logs);
+    if (!error.is_ok()) {
+        derror_f("check_log_files_continuity failed: {}", error);
+        return error.code();
+    }
+
+    _end_offset = g_start_offset;
+    for (auto &kv : logs) {
+        if (!read_log(kv.second)) {
+            break;
+        }
+    }
+
+    // no more tasks are issued once all items are replayed or discarded
+    {
+        std::unique_lock<std::mutex> l(_lock);
+        _cond.wait(l, [this]() { return _pending_items == 0; });
+    }
+    _tracker.wait_outstanding_tasks();
+
+    end_offset = _end_offset;
+    error_code err = _err;
+    if (err == ERR_OK || err == ERR_HANDLE_EOF) {
+        // the log may still be written when used for learning
+        dassert(g_end_offset <= end_offset,
+                "make sure the global end offset is correct: %" PRId64 " vs %" PRId64,
+                g_end_offset,
+                end_offset);
+        err = ERR_OK;
+    } else if (err == ERR_INCOMPLETE_DATA) {
+        // ignore the last incomplate block
+        err = ERR_OK;
+    } else {
+        // bad error
+        derror("replay mutation log failed: %s", err.to_string());
+    }
+
+    return err;
+}
+
+bool log_replay_pipeline::read_log(const log_file_ptr &log)
+{
+    ddebug("start to replay mutation log %s, offset = [%" PRId64 ", %" PRId64 "), size = %" PRId64,
+           log->path().c_str(),
+           log->start_offset(),
+           log->end_offset(),
+           log->end_offset() - log->start_offset());
+
+    log->reset_stream();
+    int64_t offset = log->start_offset();
+    uint32_t prev_crc = 0;
+    bool ok = true;
+    for (bool is_first = true; ok; is_first = false) {
+        auto item = std::make_shared<replay_item>();
+        item->log = log;
+        item->is_first = is_first;
+        item->start_offset = offset;
+
+        error_code err = log->read_next_raw_log_block(item->data, item->hdr);
+        if (err != ERR_OK) {
+            // the reading stops at the first bad block, as mutation_log::replay() does
+            item->is_end = true;
+            item->data = blob();
+            item->err = error_s::make(err, "failed to read log block");
+            item->end_offset = offset;
+            ok = submit(item);
+            break;
+        }
+
+        // the data may point to the buffer of the stream, which is reused by the later reads
+        if (item->data.buffer_ptr() == nullptr) {
+            item->data = blob::create_from_bytes(item->data.data(), item->data.length());
+        }
+        item->bytes = item->data.length();
+        item->prev_crc = prev_crc;
+        prev_crc = item->hdr.body_crc;
+        offset += sizeof(log_block_header) + item->hdr.length;
+        ok = submit(item);
+    }
+
+    log->close();
+    return ok;
+}
+
+bool log_replay_pipeline::submit(const replay_item_ptr &item)
+{
+    {
+        std::unique_lock<std::mutex> l(_lock);
+        _cond.wait(l, [this]() { return _stopped || _pending_bytes < _max_pending_bytes; });
+        if (_stopped) {
+            return false;
+        }
+        item->seq = _next_read_seq++;
+        _pending_bytes += item->bytes;
+        ++_pending_items;
+    }
+
+    if (item->is_end) {
+        on_decoded(item);
+    } else {
+        tasking::enqueue(LPC_REPLICATION_LOG_REPLAY,
+                         &_tracker,
+                         [this, item]() { decode(item); },
+                         static_cast<int>(item->seq));
+    }
+    return true;
+}
+
+void log_replay_pipeline::decode(const replay_item_ptr &item)
+{
+    error_code err = log_file::restore_log_block(item->hdr, item->prev_crc, item->data);
+    if (err != ERR_OK) {
+        item->err = error_s::make(err, "failed to read log block");
+        item->end_offset = item->start_offset;
+    } else {
+        mutation_log::replay_callback collect = [&item](int log_length, mutation_ptr &mu) {
+            item->mutations.emplace_back(log_length, mu);
+            return true;
+        };
+        item->err = mutation_log::replay_block_data(
+            item->log, collect, item->hdr, item->data, item->start_offset, item->end_offset);
+    }
+
+    // the mutations hold the data they refer to
+    item->data = blob();
+    on_decoded(item);
+}
+
+void log_replay_pipeline::on_decoded(const replay_item_ptr &item)
+{
+    std::lock_guard<std::mutex> l(_lock);
+    _decoded_items.emplace(item->seq, item);
+
+    // dispatch in the log order
+    auto it = _decoded_items.begin();
+    while (it != _decoded_items.end() && it->first == _next_dispatch_seq) {
+        ++_next_dispatch_seq;
+        dispatch_no_lock(it->second);
+        it = _decoded_items.erase(it);
+    }
+}
+
+void log_replay_pipeline::dispatch_no_lock(const replay_item_ptr &item)
+{
+    if (item->is_first) {
+        _log_finished = false;
+        if (!_stopped && item->log->start_offset() != _end_offset) {
+            derror("offset mismatch in log file offset and global offset %" PRId64 " vs %" PRId64,
+                   item->log->start_offset(),
+                   _end_offset);
+            _err = ERR_INVALID_DATA;
+            _stopped = true;
+        }
+    }
+    if (_stopped || _log_finished) {
+        release_no_lock(item);
+        return;
+    }
+
+    // the mutations of each gpid are replayed in order by one task
+    std::map<gpid, std::vector<std::pair<int, mutation_ptr>>> mutations_by_gpid;
+    for (auto &mu : item->mutations) {
+        mutations_by_gpid[mu.second->data.header.pid].emplace_back(std::move(mu));
+    }
+    item->mutations.clear();
+
+    item->pending_tasks = static_cast<int>(mutations_by_gpid.size());
+    for (auto &kv : mutations_by_gpid) {
+        auto mutations =
+            std::make_shared<std::vector<std::pair<int, mutation_ptr>>>(std::move(kv.second));
+        // the tasks of a gpid are executed in the order of being enqueued, for they are hashed
+        // to the same worker
+        tasking::enqueue(LPC_REPLICATION_LOG_REPLAY,
+                         &_tracker,
+                         [this, item, mutations]() { replay(item, *mutations); },
+                         kv.first.thread_hash());
+    }
+    _end_offset = item->end_offset;
+
+    if (item->pending_tasks == 0) {
+        release_no_lock(item);
+    }
+    if (item->is_end || !item->err.is_ok()) {
+        finish_log_no_lock(item);
+    }
+}
+
+void log_replay_pipeline::finish_log_no_lock(const replay_item_ptr &item)
+{
+    _log_finished = true;
+    _err = item->err.code();
+    ddebug("finish to replay mutation log (%s) [err: %s]",
+           item->log->path().c_str(),
+           item->err.description().c_str());
+
+    if (_err == ERR_OK || _err == ERR_HANDLE_EOF) {
+        // do nothing
+    } else if (_err == ERR_INCOMPLETE_DATA) {
+        // If the file is not corrupted, it may also return the value of ERR_INCOMPLETE_DATA.
+        // In this case, the correctness is relying on the check of start_offset.
+        dwarn("delay handling error: %s", _err.to_string());
+    } else {
+        // for other errors, we should break
+        _stopped = true;
+        _cond.notify_all();
+    }
+}
+
+void log_replay_pipeline::replay(const replay_item_ptr &item,
+                                 const std::vector<std::pair<int, mutation_ptr>> &mutations)
+{
+    for (const auto &kv : mutations) {
+        mutation_ptr mu = kv.second;
+        _callback(kv.first, mu);
+    }
+
+    std::lock_guard<std::mutex> l(_lock);
+    if (--item->pending_tasks == 0) {
+        release_no_lock(item);
+    }
+}
+
+void log_replay_pipeline::release_no_lock(const replay_item_ptr &item)
+{
+    _pending_bytes -= item->bytes;
+    --_pending_items;
+    // notify with the lock held, for run() may return once the lock is released
+    _cond.notify_all();
+}
+
+} // namespace replication
+} // namespace dsn
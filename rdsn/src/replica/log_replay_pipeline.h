@@ -0,0 +1,119 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include "mutation_log.h"
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace dsn {
+namespace replication {
+
+// Replays continuous log files like mutation_log::replay(), with the same callbacks and the
+// same result, but in a pipeline:
+// - the calling thread reads the blocks ahead sequentially, without checking them;
+// - the crc of the blocks are checked, and they are decompressed and decoded into mutations
+//   in parallel, by the workers of THREAD_POOL_REPLICATION;
+// - the decoded blocks are dispatched in the log order. The mutations of a gpid are passed to
+//   `callback` in order, in the worker of THREAD_POOL_REPLICATION which the gpid is hashed to,
+//   while the mutations of different gpids are replayed in parallel.
+//
+// So `callback` must be thread safe across gpids, and run() must not be called in a worker of
+// THREAD_POOL_REPLICATION, otherwise it may wait for the tasks queued behind itself.
+//
+// The blocks read but not replayed yet are limited to `max_pending_bytes`, except that one
+// block is always allowed.
+class log_replay_pipeline
+{
+public:
+    log_replay_pipeline(mutation_log::replay_callback callback, int64_t max_pending_bytes);
+
+    error_code run(std::map<int, log_file_ptr> &logs, /*out*/ int64_t &end_offset);
+
+private:
+    // a block read from a log file, or the end of the file where the reading stops
+    struct replay_item
+    {
+        // the order in the pipeline
+        uint64_t seq{0};
+        log_file_ptr log;
+        // whether it's the first item of the log file
+        bool is_first{false};
+        // whether it's the end of the log file, `err` is why the reading stops
+        bool is_end{false};
+        // global offset where the block starts
+        int64_t start_offset{0};
+        // bytes accounted in the pending bytes
+        int64_t bytes{0};
+
+        log_block_header hdr;
+        // the body_crc of the previous block in the file
+        uint32_t prev_crc{0};
+        blob data;
+
+        // decoded from the block, `err` is not ok if it's bad. the mutations before the bad
+        // one are still replayed, as mutation_log::replay() does.
+        std::vector<std::pair<int, mutation_ptr>> mutations;
+        error_s err;
+        int64_t end_offset{0};
+
+        // count of the replaying tasks of the mutations
+        int pending_tasks{0};
+    };
+    typedef std::shared_ptr<replay_item> replay_item_ptr;
+
+    // returns false if the pipeline is stopped
+    bool read_log(const log_file_ptr &log);
+    bool submit(const replay_item_ptr &item);
+
+    void decode(const replay_item_ptr &item);
+
+    // called when the item is decoded, dispatches the items in order
+    void on_decoded(const replay_item_ptr &item);
+    void dispatch_no_lock(const replay_item_ptr &item);
+    void finish_log_no_lock(const replay_item_ptr &item);
+    void replay(const replay_item_ptr &item,
+                const std::vector<std::pair<int, mutation_ptr>> &mutations);
+    void release_no_lock(const replay_item_ptr &item);
+
+    const mutation_log::replay_callback _callback;
+    const int64_t _max_pending_bytes;
+
+    std::mutex _lock;
+    std::condition_variable _cond;
+    bool _stopped{false};
+    // whether the log file being dispatched is finished, the rest of it is discarded
+    bool _log_finished{false};
+    uint64_t _next_read_seq{0};
+    uint64_t _next_dispatch_seq{0};
+    std::map<uint64_t, replay_item_ptr> _decoded_items;
+    int64_t _pending_bytes{0};
+    int _pending_items{0};
+
+    // the global offset replayed to, and the error of the last log file replayed
+    int64_t _end_offset{0};
+    error_code _err{ERR_OK};
+
+    dsn::task_tracker _tracker;
+};
+
+} // namespace replication
+} // namespace dsn
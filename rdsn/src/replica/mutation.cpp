@@ -56,6 +56,7 @@ mutation::mutation()
     _private0 = 0;
     _not_logged = 1;
     _prepare_ts_ms = 0;
+    _prepare_ts_us = 0;
     strcpy(_name, "0.0.0.0");
     _appro_data_bytes = sizeof(mutation_header);
     _create_ts_ns = dsn_now_ns();
@@ -339,9 +340,10 @@ void mutation::wait_log_task() const
 mutation_queue::mutation_queue(gpid gpid,
                                int max_concurrent_op /*= 2*/,
                                bool batch_write_disabled /*= false*/)
-    : _max_concurrent_op(max_concurrent_op), _batch_write_disabled(batch_write_disabled)
+    : _window_controller(gpid, max_concurrent_op), _batch_write_disabled(batch_write_disabled)
 {
     _current_op_count = 0;
+    _queued_count = 0;
     _pending_mutation = nullptr;
     dassert(gpid.get_app_id() != 0, "invalid gpid");
     _pcount = dsn_task_queue_virtual_length_ptr(RPC_PREPARE, gpid.thread_hash());
@@ -353,10 +355,7 @@ mutation_ptr mutation_queue::add_work(task_code code, dsn::message_ex *request,
 
     // if not allow write batch, switch work queue
     if (_pending_mutation && !spec->rpc_request_is_write_allow_batch) {
-        _pending_mutation->add_ref(); // released when unlink
-        _hdr.add(_pending_mutation);
-        _pending_mutation = nullptr;
-        ++(*_pcount);
+        link_pending_workload();
     }
 
     // add to work queue
@@ -370,36 +369,32 @@ mutation_ptr mutation_queue::add_work(task_code code, dsn::message_ex *request,
 
     _pending_mutation->add_client_request(code, request);
 
+    const int max_concurrent_op = _window_controller.window();
+
     // short-cut
-    if (_current_op_count < _max_concurrent_op && _hdr.is_empty()) {
+    if (_current_op_count < max_concurrent_op && _hdr.is_empty()) {
         auto ret = _pending_mutation;
         _pending_mutation = nullptr;
-        _current_op_count++;
-        return ret;
+        return start_work(ret);
     }
 
     // check if need to switch work queue
     if (_batch_write_disabled || !spec->rpc_request_is_write_allow_batch ||
-        _pending_mutation->is_full()) {
-        _pending_mutation->add_ref(); // released when unlink
-        _hdr.add(_pending_mutation);
-        _pending_mutation = nullptr;
-        ++(*_pcount);
+        _pending_mutation->is_full(_window_controller.batch_bytes())) {
+        link_pending_workload();
     }
 
     // get next work item
-    if (_current_op_count >= _max_concurrent_op)
+    if (_current_op_count >= max_concurrent_op)
         return nullptr;
     else if (_hdr.is_empty()) {
         dassert(_pending_mutation != nullptr, "pending mutation cannot be null");
 
         auto ret = _pending_mutation;
         _pending_mutation = nullptr;
-        _current_op_count++;
-        return ret;
+        return start_work(ret);
     } else {
-        _current_op_count++;
-        return unlink_next_workload();
+        return start_work(unlink_next_workload());
     }
 }
 
@@ -407,7 +402,7 @@ mutation_ptr mutation_queue::check_possible_work(int current_running_count)
 {
     _current_op_count = current_running_count;
 
-    if (_current_op_count >= _max_concurrent_op)
+    if (_current_op_count >= _window_controller.window())
         return nullptr;
 
     // no further workload
@@ -415,8 +410,7 @@ mutation_ptr mutation_queue::check_possible_work(int current_running_count)
         if (_pending_mutation != nullptr) {
             auto ret = _pending_mutation;
             _pending_mutation = nullptr;
-            _current_op_count++;
-            return ret;
+            return start_work(ret);
         } else {
             return nullptr;
         }
@@ -424,8 +418,7 @@ mutation_ptr mutation_queue::check_possible_work(int current_running_count)
 
     // run further workload
     else {
-        _current_op_count++;
-        return unlink_next_workload();
+        return start_work(unlink_next_workload());
     }
 }
 
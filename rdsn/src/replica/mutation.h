@@ -36,6 +36,7 @@
 #pragma once
 
 #include "common/replication_common.h"
+#include "mutation_window_controller.h"
 #include <list>
 #include <atomic>
 #include <dsn/utility/link.h>
@@ -116,10 +117,15 @@ public:
     int clear_prepare_or_commit_tasks();
     void wait_log_task() const;
     uint64_t prepare_ts_ms() const { return _prepare_ts_ms; }
-    void set_prepare_ts() { _prepare_ts_ms = dsn_now_ms(); }
+    uint64_t prepare_ts_us() const { return _prepare_ts_us; }
+    void set_prepare_ts()
+    {
+        _prepare_ts_us = dsn_now_us();
+        _prepare_ts_ms = _prepare_ts_us / 1000;
+    }
 
     // >= 1 MB
-    bool is_full() const { return _appro_data_bytes >= 1024 * 1024; }
+    bool is_full(int max_bytes) const { return _appro_data_bytes >= max_bytes; }
     int appro_data_bytes() const { return _appro_data_bytes; }
 
     // read & write mutation data
@@ -170,6 +176,7 @@ private:
     };
 
     uint64_t _prepare_ts_ms;
+    uint64_t _prepare_ts_us;
     ::dsn::task_ptr _log_task;
     node_tasks _prepare_or_commit_tasks;
     std::vector<dsn::message_ex *> _prepare_requests; // may combine duplicate requests
@@ -192,6 +199,8 @@ class replica;
 //    requets should be packed into different mutations
 // 2. number of preparing mutations is also limited, so we should queue new created mutations and
 //    try to send them as soon as the concurrent condition satisfies.
+//
+// both limits are given by the window controller, see mutation_window_controller.
 class mutation_queue
 {
 public:
@@ -216,6 +225,8 @@ public:
     // which triggers further round of operations as returned
     mutation_ptr check_possible_work(int current_running_count);
 
+    mutation_window_controller &window_controller() { return _window_controller; }
+
 private:
     mutation_ptr unlink_next_workload()
     {
@@ -223,16 +234,34 @@ private:
         if (r.get() != nullptr) {
             r->release_ref(); // added in add_work
             --(*_pcount);
+            --_queued_count;
         }
         return r;
     }
 
-    void reset_max_concurrent_ops(int max_c) { _max_concurrent_op = max_c; }
+    void link_pending_workload()
+    {
+        _pending_mutation->add_ref(); // released when unlink
+        _hdr.add(_pending_mutation);
+        _pending_mutation = nullptr;
+        ++(*_pcount);
+        ++_queued_count;
+    }
+
+    // called when the mutation is returned to be prepared
+    mutation_ptr start_work(mutation_ptr mu)
+    {
+        _current_op_count++;
+        _window_controller.on_mutation_started(static_cast<int>(mu->client_requests.size()),
+                                               _queued_count);
+        return mu;
+    }
 
 private:
     int _current_op_count;
-    int _max_concurrent_op;
+    mutation_window_controller _window_controller;
     bool _batch_write_disabled;
+    int _queued_count; // count of mutations in _hdr
 
     volatile int *_pcount;
     mutation_ptr _pending_mutation;
@@ -27,6 +27,7 @@
 #include "mutation_log.h"
 #include "replica.h"
 #include "mutation_log_utils.h"
+#include "log_replay_pipeline.h"
 
 #include <dsn/utils/latency_tracer.h>
 #include <dsn/utility/filesystem.h>
@@ -43,6 +44,31 @@ DSN_DEFINE_bool("replication",
                 false,
                 "when write private log, whether to flush file after write done");
 
+DSN_DEFINE_string("replication",
+                  slog_block_compression,
+                  "none",
+                  "codec to compress the blocks of shared log: none, lz4 or zstd. the private "
+                  "logs are compressed as the table env replica.log_block_compression");
+DSN_DEFINE_validator(slog_block_compression, [](const char *value) -> bool {
+    log_block_codec codec;
+    return parse_log_block_codec(value, codec);
+});
+
+DSN_DEFINE_bool("replication",
+                slog_pipelined_replay_enabled,
+                false,
+                "whether to replay the shared log in a pipeline on startup: the blocks are read "
+                "ahead, checked and decoded in parallel, and the mutations of different replicas "
+                "are replayed in parallel by the replication threads");
+
+DSN_DEFINE_int32("replication",
+                 slog_pipelined_replay_max_pending_mb,
+                 256,
+                 "max size of the shared log blocks read but not replayed yet when replaying in "
+                 "a pipeline");
+DSN_DEFINE_validator(slog_pipelined_replay_max_pending_mb,
+                     [](int32_t value) -> bool { return value > 0; });
+
 ::dsn::task_ptr mutation_log_shared::append(mutation_ptr &mu,
                                             dsn::task_code callback_code,
                                             dsn::task_tracker *tracker,
@@ -61,7 +87,7 @@ DSN_DEFINE_bool("replication",
     ADD_POINT(mu->_tracer);
     // init pending buffer
     if (nullptr == _pending_write) {
-        _pending_write = std::make_shared<log_appender>(mark_new_offset(0, true).second);
+        _pending_write = std::make_shared<log_appender>(_block_codec.load());
     }
     _pending_write->append_mutation(mu, cb);
 
@@ -116,17 +142,20 @@ void mutation_log_shared::write_pending_mutations(bool release_lock_required)
     dassert(release_lock_required, "lock must be hold at this point");
     dassert(!_is_writing.load(std::memory_order_relaxed), "");
     dassert(_pending_write != nullptr, "");
-    dassert(_pending_write->size() > 0, "pending write size = %d", (int)_pending_write->size());
-    auto pr = mark_new_offset(_pending_write->size(), false);
-    dcheck_eq(pr.second, _pending_write->start_offset());
+    dassert(_pending_write->mutation_count() > 0, "no pending mutation");
 
     _is_writing.store(true, std::memory_order_release);
 
     // move or reset pending variables
     auto pending = std::move(_pending_write);
 
-    // seperate commit_log_block from within the lock
+    // seperate commit_log_block from within the lock, so do writing and compressing the
+    // mutations. the offsets are reserved only by the write in progress, so they can't be
+    // moved by others until this one is reserved
     _slock.unlock();
+    pending->seal(mark_new_offset(0, true).second);
+    auto pr = mark_new_offset(pending->size(), false);
+    dcheck_eq(pr.second, pending->start_offset());
     commit_pending_mutations(pr.first, pending);
 }
 
@@ -153,7 +182,7 @@ void mutation_log_shared::commit_pending_mutations(log_file_ptr &lf,
 
             for (auto &block : pending->all_blocks()) {
                 auto hdr = (log_block_header *)block.front().data();
-                dassert(hdr->magic == 0xdeadbeef, "header magic is changed: 0x%x", hdr->magic);
+                dassert(hdr->is_valid(), "header magic is changed: 0x%x", hdr->magic);
             }
 
             if (err == ERR_OK) {
@@ -227,7 +256,7 @@ mutation_log_private::mutation_log_private(const std::string &dir,
 
     // init pending buffer
     if (nullptr == _pending_write) {
-        _pending_write = make_unique<log_appender>(mark_new_offset(0, true).second);
+        _pending_write = make_unique<log_appender>(_block_codec.load());
     }
     _pending_write->append_mutation(mu, cb);
 
@@ -370,7 +399,10 @@ void mutation_log_private::write_pending_mutations(bool release_lock_required)
     dassert(release_lock_required, "lock must be hold at this point");
     dassert(!_is_writing.load(std::memory_order_relaxed), "");
     dassert(_pending_write != nullptr, "");
-    dassert(_pending_write->size() > 0, "pending write size = %d", (int)_pending_write->size());
+    dassert(_pending_write->mutation_count() > 0, "no pending mutation");
+    // sealed within the lock, as learners copy the pending and issued mutations under it,
+    // and the private log is written in the replica thread only anyway
+    _pending_write->seal(mark_new_offset(0, true).second);
     auto pr = mark_new_offset(_pending_write->size(), false);
     dcheck_eq_replica(pr.second, _pending_write->start_offset());
 
@@ -410,7 +442,7 @@ void mutation_log_private::commit_pending_mutations(log_file_ptr &lf,
 
             for (auto &block : pending->all_blocks()) {
                 auto hdr = (log_block_header *)block.front().data();
-                dassert(hdr->magic == 0xdeadbeef, "header magic is changed: 0x%x", hdr->magic);
+                dassert(hdr->is_valid(), "header magic is changed: 0x%x", hdr->magic);
             }
 
             if (dsn_unlikely(utils::FLAGS_enable_latency_tracer)) {
@@ -471,6 +503,12 @@ mutation_log::mutation_log(const std::string &dir, int32_t max_log_file_mb, gpid
     _owner_replica = r;
     _private_gpid = gpid;
 
+    log_block_codec codec = log_block_codec::NONE;
+    if (!_is_private) {
+        parse_log_block_codec(FLAGS_slog_block_compression, codec);
+    }
+    _block_codec.store(codec);
+
     if (r) {
         dassert(_private_gpid == r->get_gpid(),
                 "(%d.%d) VS (%d.%d)",
@@ -657,26 +695,35 @@ error_code mutation_log::open(replay_callback read_callback,
     // replay with the found files
     std::map<int, log_file_ptr> replay_logs(replay_begin, replay_end);
     int64_t end_offset = 0;
-    err = replay(
-        replay_logs,
-        [this, read_callback](int log_length, mutation_ptr &mu) {
-            bool ret = true;
-
-            if (read_callback) {
-                ret = read_callback(log_length,
-                                    mu); // actually replica::replay_mutation(mu, true|false);
-            }
+    // the callback is called concurrently for different gpids if replayed in a pipeline
+    std::mutex update_lock;
+    replay_callback callback = [this, read_callback, &update_lock](int log_length,
+                                                                   mutation_ptr &mu) {
+        bool ret = true;
+
+        if (read_callback) {
+            ret = read_callback(log_length,
+                                mu); // actually replica::replay_mutation(mu, true|false);
+        }
 
-            if (ret) {
-                this->update_max_decree_no_lock(mu->data.header.pid, mu->data.header.decree);
-                if (this->_is_private) {
-                    this->update_max_commit_on_disk_no_lock(mu->data.header.last_committed_decree);
-                }
+        if (ret) {
+            std::lock_guard<std::mutex> l(update_lock);
+            this->update_max_decree_no_lock(mu->data.header.pid, mu->data.header.decree);
+            if (this->_is_private) {
+                this->update_max_commit_on_disk_no_lock(mu->data.header.last_committed_decree);
             }
+        }
 
-            return ret;
-        },
-        end_offset);
+        return ret;
+    };
+    if (!_is_private && FLAGS_slog_pipelined_replay_enabled) {
+        int64_t max_pending_bytes =
+            static_cast<int64_t>(FLAGS_slog_pipelined_replay_max_pending_mb) << 20;
+        log_replay_pipeline pipeline(std::move(callback), max_pending_bytes);
+        err = pipeline.run(replay_logs, end_offset);
+    } else {
+        err = replay(replay_logs, std::move(callback), end_offset);
+    }
 
     if (ERR_OK == err) {
         _global_start_offset =
@@ -148,6 +148,15 @@ public:
         return replay_block(log, callback, start_offset, end_offset);
     }
 
+    // Iterates over the mutations of a block which has been read from `log` and restored, see
+    // log_file::read_next_log_block(). `global_start_offset` is where the block starts.
+    static error_s replay_block_data(log_file_ptr &log,
+                                     replay_callback &callback,
+                                     const log_block_header &hdr,
+                                     const blob &bb,
+                                     int64_t global_start_offset,
+                                     /*out*/ int64_t &end_offset);
+
     // Resets mutation log with log files under `dir`.
     // The original log will be removed after this call.
     // NOTE: log should be opened before this method called. now it only be used private log
@@ -277,6 +286,10 @@ public:
     void hint_switch_file() { _switch_file_hint = true; }
     void demand_switch_file() { _switch_file_demand = true; }
 
+    // compress the log blocks written later with the codec
+    // thread safe
+    void set_block_codec(log_block_codec codec) { _block_codec.store(codec); }
+
     task_tracker *tracker() { return &_tracker; }
 
 protected:
@@ -335,6 +348,7 @@ protected:
     int64_t _max_log_file_size_in_bytes;
     int64_t _min_log_file_size_in_bytes;
     bool _force_flush;
+    std::atomic<log_block_codec> _block_codec;
 
     dsn::task_tracker _tracker;
 
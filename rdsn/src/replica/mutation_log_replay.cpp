@@ -64,51 +64,64 @@ namespace replication {
         return error_s::make(ERR_INCOMPLETE_DATA, "mutation_log_replay_block");
     });
 
-    blob bb;
-    std::unique_ptr<binary_reader> reader;
-
     log->reset_stream(start_offset); // start reading from given offset
     int64_t global_start_offset = start_offset + log->start_offset();
     end_offset = global_start_offset; // reset end_offset to the start.
 
     // reads the entire block into memory
-    error_code err = log->read_next_log_block(bb);
+    blob bb;
+    log_block_header hdr;
+    error_code err = log->read_next_log_block(bb, &hdr);
     if (err != ERR_OK) {
         return error_s::make(err, "failed to read log block");
     }
 
-    reader = dsn::make_unique<binary_reader>(bb);
-    end_offset += sizeof(log_block_header);
+    return replay_block_data(log, callback, hdr, bb, global_start_offset, end_offset);
+}
+
+/*static*/ error_s mutation_log::replay_block_data(log_file_ptr &log,
+                                                   replay_callback &callback,
+                                                   const log_block_header &hdr,
+                                                   const blob &bb,
+                                                   int64_t global_start_offset,
+                                                   int64_t &end_offset)
+{
+    binary_reader reader(bb);
+    end_offset = global_start_offset + sizeof(log_block_header);
 
     // The first block is log_file_header.
     if (global_start_offset == log->start_offset()) {
-        end_offset += log->read_file_header(*reader);
+        end_offset += log->read_file_header(reader);
         if (!log->is_right_header()) {
             return error_s::make(ERR_INVALID_DATA, "failed to read log file header");
         }
         // continue to parsing the data block
     }
 
-    while (!reader->is_eof()) {
-        auto old_size = reader->get_remaining_size();
-        mutation_ptr mu = mutation::read_from(*reader, nullptr);
+    while (!reader.is_eof()) {
+        auto old_size = reader.get_remaining_size();
+        mutation_ptr mu = mutation::read_from(reader, nullptr);
         dassert(nullptr != mu, "");
         mu->set_logged();
 
-        if (mu->data.header.log_offset != end_offset) {
+        // the mutations in a block with codec take the start offset of the block
+        int64_t expected_offset = hdr.has_codec() ? global_start_offset : end_offset;
+        if (mu->data.header.log_offset != expected_offset) {
             return FMT_ERR(ERR_INVALID_DATA,
                            "offset mismatch in log entry and mutation {} vs {}",
-                           end_offset,
+                           expected_offset,
                            mu->data.header.log_offset);
         }
 
-        int log_length = old_size - reader->get_remaining_size();
+        int log_length = old_size - reader.get_remaining_size();
 
         callback(log_length, mu);
 
         end_offset += log_length;
     }
 
+    // the block may be compressed, so its end on disk is given by the header
+    end_offset = global_start_offset + sizeof(log_block_header) + hdr.length;
     return error_s::ok();
 }
 
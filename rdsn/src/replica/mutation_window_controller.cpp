@@ -0,0 +1,232 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "mutation_window_controller.h"
+
+#include <algorithm>
+#include <dsn/utility/flags.h>
+#include <dsn/c/api_utilities.h>
+#include <dsn/dist/fmt_logging.h>
+
+namespace dsn {
+namespace replication {
+
+DSN_DEFINE_bool("replication",
+                mutation_2pc_adaptive_window_enabled,
+                false,
+                "whether to size the 2pc window and the batch bytes of mutations from the "
+                "observed prepare rtt, log latency and write queue depth");
+DSN_TAG_VARIABLE(mutation_2pc_adaptive_window_enabled, FT_MUTABLE);
+
+DSN_DEFINE_int32("replication",
+                 mutation_2pc_min_window,
+                 2,
+                 "min count of mutations preparing at the same time when the 2pc window is "
+                 "adaptive, the max is staleness_for_commit");
+DSN_TAG_VARIABLE(mutation_2pc_min_window, FT_MUTABLE);
+DSN_DEFINE_validator(mutation_2pc_min_window, [](int32_t value) -> bool { return value > 0; });
+
+DSN_DEFINE_int32("replication",
+                 mutation_2pc_min_batch_bytes,
+                 64 * 1024,
+                 "min bytes a queued mutation batches when the 2pc window is adaptive");
+DSN_TAG_VARIABLE(mutation_2pc_min_batch_bytes, FT_MUTABLE);
+DSN_DEFINE_validator(mutation_2pc_min_batch_bytes, [](int32_t value) -> bool { return value > 0; });
+
+DSN_DEFINE_int32("replication",
+                 mutation_2pc_max_batch_bytes,
+                 4 * 1024 * 1024,
+                 "max bytes a queued mutation batches when the 2pc window is adaptive");
+DSN_TAG_VARIABLE(mutation_2pc_max_batch_bytes, FT_MUTABLE);
+DSN_DEFINE_validator(mutation_2pc_max_batch_bytes,
+                     [](int32_t value) -> bool { return value > 0 && value <= (1 << 30); });
+
+DSN_DEFINE_group_validator(mutation_2pc_batch_bytes, [](std::string &message) -> bool {
+    if (FLAGS_mutation_2pc_min_batch_bytes > FLAGS_mutation_2pc_max_batch_bytes) {
+        message = fmt::format("replication.mutation_2pc_min_batch_bytes({}) should be <= "
+                              "replication.mutation_2pc_max_batch_bytes({})",
+                              FLAGS_mutation_2pc_min_batch_bytes,
+                              FLAGS_mutation_2pc_max_batch_bytes);
+        return false;
+    }
+    return true;
+});
+
+DSN_DEFINE_int32("replication",
+                 mutation_2pc_window_adjust_samples,
+                 64,
+                 "how many mutations a round of the adaptive 2pc window lasts");
+DSN_TAG_VARIABLE(mutation_2pc_window_adjust_samples, FT_MUTABLE);
+DSN_DEFINE_validator(mutation_2pc_window_adjust_samples,
+                     [](int32_t value) -> bool { return value > 0; });
+
+DSN_DEFINE_int32("replication",
+                 mutation_2pc_latency_tolerance_percent,
+                 100,
+                 "the 2pc window is cut when the prepare rtt or log latency of a round exceeds "
+                 "the lowest one by this percent");
+DSN_TAG_VARIABLE(mutation_2pc_latency_tolerance_percent, FT_MUTABLE);
+DSN_DEFINE_validator(mutation_2pc_latency_tolerance_percent,
+                     [](int32_t value) -> bool { return value >= 0; });
+
+// the batch bytes of mutations when the window is not adaptive
+static const int DEFAULT_BATCH_BYTES = 1024 * 1024;
+
+// the lowest latencies are forgotten every this many rounds
+static const int BASE_LATENCY_REFRESH_ROUNDS = 16;
+
+mutation_window_controller::mutation_window_controller(gpid pid, int max_window)
+    : _max_window(max_window),
+      _window(max_window),
+      _batch_bytes(DEFAULT_BATCH_BYTES),
+      _mutation_count(0),
+      _request_count(0),
+      _queue_depth_sum(0),
+      _prepare_rtt_sum_us(0),
+      _prepare_rtt_count(0),
+      _log_latency_sum_us(0),
+      _log_latency_count(0),
+      _base_prepare_rtt_us(0),
+      _base_log_latency_us(0),
+      _round_count(0)
+{
+    dassert(max_window > 0, "invalid max window %d", max_window);
+
+    std::string counter_str = fmt::format("2pc.window.size@{}", pid);
+    _counter_window_size.init_app_counter(
+        "eon.replica", counter_str.c_str(), COUNTER_TYPE_NUMBER, counter_str.c_str());
+    _counter_window_size->set(window());
+
+    counter_str = fmt::format("2pc.batch.bytes@{}", pid);
+    _counter_batch_bytes.init_app_counter(
+        "eon.replica", counter_str.c_str(), COUNTER_TYPE_NUMBER, counter_str.c_str());
+    _counter_batch_bytes->set(batch_bytes());
+
+    counter_str = fmt::format("2pc.requests.per.mutation@{}", pid);
+    _counter_requests_per_mutation.init_app_counter(
+        "eon.replica", counter_str.c_str(), COUNTER_TYPE_NUMBER, counter_str.c_str());
+}
+
+int mutation_window_controller::window() const
+{
+    return FLAGS_mutation_2pc_adaptive_window_enabled ? _window : _max_window;
+}
+
+int mutation_window_controller::batch_bytes() const
+{
+    return FLAGS_mutation_2pc_adaptive_window_enabled ? _batch_bytes : DEFAULT_BATCH_BYTES;
+}
+
+void mutation_window_controller::on_mutation_started(int request_count, int queue_depth)
+{
+    ++_mutation_count;
+    _request_count += request_count;
+    _queue_depth_sum += queue_depth;
+    if (_mutation_count >= FLAGS_mutation_2pc_window_adjust_samples) {
+        adjust();
+    }
+}
+
+void mutation_window_controller::on_prepare_acked(uint64_t rtt_us)
+{
+    _prepare_rtt_sum_us += rtt_us;
+    ++_prepare_rtt_count;
+}
+
+void mutation_window_controller::on_log_appended(uint64_t latency_us)
+{
+    _log_latency_sum_us += latency_us;
+    ++_log_latency_count;
+}
+
+void mutation_window_controller::adjust()
+{
+    _counter_requests_per_mutation->set(_request_count / _mutation_count);
+
+    if (!FLAGS_mutation_2pc_adaptive_window_enabled) {
+        // start over once enabled again
+        _window = _max_window;
+        _batch_bytes = DEFAULT_BATCH_BYTES;
+        _base_prepare_rtt_us = 0;
+        _base_log_latency_us = 0;
+        _round_count = 0;
+    } else {
+        uint64_t prepare_rtt_us =
+            _prepare_rtt_count > 0 ? _prepare_rtt_sum_us / _prepare_rtt_count : 0;
+        uint64_t log_latency_us =
+            _log_latency_count > 0 ? _log_latency_sum_us / _log_latency_count : 0;
+
+        if (_round_count++ % BASE_LATENCY_REFRESH_ROUNDS == 0) {
+            _base_prepare_rtt_us = 0;
+            _base_log_latency_us = 0;
+        }
+        auto is_saturated = [](uint64_t base_us, uint64_t latency_us) {
+            uint64_t tolerance = 100 + FLAGS_mutation_2pc_latency_tolerance_percent;
+            return base_us > 0 && latency_us * 100 > base_us * tolerance;
+        };
+        bool saturated = is_saturated(_base_prepare_rtt_us, prepare_rtt_us) ||
+                         is_saturated(_base_log_latency_us, log_latency_us);
+        auto update_base = [](uint64_t &base_us, uint64_t latency_us) {
+            if (latency_us > 0 && (base_us == 0 || latency_us < base_us)) {
+                base_us = latency_us;
+            }
+        };
+        update_base(_base_prepare_rtt_us, prepare_rtt_us);
+        update_base(_base_log_latency_us, log_latency_us);
+
+        int min_window = std::min(FLAGS_mutation_2pc_min_window, _max_window);
+        // in int64 as the max batch bytes may be up to 1GB
+        int64_t batch_bytes = _batch_bytes;
+        if (saturated) {
+            _window = std::max(min_window, _window - std::max(1, _window / 4));
+        } else if (_queue_depth_sum >= _mutation_count) {
+            // in average at least one mutation is waiting when another one starts
+            if (_window < _max_window) {
+                ++_window;
+            } else {
+                batch_bytes *= 2;
+            }
+        } else {
+            batch_bytes /= 2;
+        }
+        // the bounds may be changed at runtime
+        _window = std::max(min_window, std::min(_window, _max_window));
+        batch_bytes = std::max<int64_t>(FLAGS_mutation_2pc_min_batch_bytes,
+                                        std::min<int64_t>(batch_bytes,
+                                                          FLAGS_mutation_2pc_max_batch_bytes));
+        if (batch_bytes != _batch_bytes) {
+            // the latencies with the former batch bytes are not comparable
+            _batch_bytes = static_cast<int>(batch_bytes);
+            _base_prepare_rtt_us = 0;
+            _base_log_latency_us = 0;
+        }
+    }
+
+    _counter_window_size->set(window());
+    _counter_batch_bytes->set(batch_bytes());
+
+    _mutation_count = 0;
+    _request_count = 0;
+    _queue_depth_sum = 0;
+    _prepare_rtt_sum_us = 0;
+    _prepare_rtt_count = 0;
+    _log_latency_sum_us = 0;
+    _log_latency_count = 0;
+}
+
+} // namespace replication
+} // namespace dsn
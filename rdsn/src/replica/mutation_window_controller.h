@@ -0,0 +1,99 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <dsn/tool-api/gpid.h>
+#include <dsn/perf_counter/perf_counter_wrapper.h>
+
+namespace dsn {
+namespace replication {
+
+// Sizes the 2pc pipeline of a primary: how many mutations may be preparing at the same
+// time (the window), and how many bytes of client requests a queued mutation may batch.
+//
+// Samples of the prepare-ack rtt, the private log append latency and the write queue depth
+// are aggregated into rounds of `mutation_2pc_window_adjust_samples` mutations. After each
+// round:
+// - if the latencies grew well beyond the lowest ones seen, the secondaries or the log are
+//   saturated: the window is cut;
+// - otherwise if writes are queued, the window grows by one, or once it reaches the upper
+//   bound, the mutations get larger;
+// - otherwise the pipeline is idle and the mutations get smaller again.
+//
+// Larger mutations take longer to prepare, so the lowest latencies are those seen with the
+// current batch bytes, and they are learned again once the batch bytes change.
+//
+// When disabled, the window is `max_window` and a mutation batches up to 1MB, as before.
+//
+// not thread safe, it's accessed in the replica thread only
+class mutation_window_controller
+{
+public:
+    // `max_window` is the upper bound of the window, it should not exceed staleness_for_commit,
+    // otherwise mutations beyond the window would be rejected by init_prepare.
+    mutation_window_controller(gpid pid, int max_window);
+
+    // max count of mutations preparing at the same time
+    int window() const;
+
+    // a queued mutation is full and won't batch more requests once it reaches this size
+    int batch_bytes() const;
+
+    // called when a mutation starts to prepare, with the count of mutations still waiting
+    // in the queue
+    void on_mutation_started(int request_count, int queue_depth);
+
+    // rtt of a successful prepare to a secondary
+    void on_prepare_acked(uint64_t rtt_us);
+
+    // latency of appending a mutation to the private log
+    void on_log_appended(uint64_t latency_us);
+
+private:
+    void adjust();
+
+    friend class mutation_window_controller_test;
+
+    const int _max_window;
+    int _window;
+    int _batch_bytes;
+
+    // samples of the current round
+    int _mutation_count;
+    int64_t _request_count;
+    int64_t _queue_depth_sum;
+    uint64_t _prepare_rtt_sum_us;
+    int _prepare_rtt_count;
+    uint64_t _log_latency_sum_us;
+    int _log_latency_count;
+
+    // the lowest average latencies of a round with the current batch bytes, which latencies
+    // of later rounds are compared with to detect saturation. they are refreshed every several
+    // rounds to follow the changes of network or disk.
+    uint64_t _base_prepare_rtt_us;
+    uint64_t _base_log_latency_us;
+    int _round_count;
+
+    perf_counter_wrapper _counter_window_size;
+    perf_counter_wrapper _counter_batch_bytes;
+    perf_counter_wrapper _counter_requests_per_mutation;
+};
+
+} // namespace replication
+} // namespace dsn
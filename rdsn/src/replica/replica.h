@@ -160,7 +160,9 @@ public:
     //    messages and tools from/for meta server
     //
     void on_config_proposal(configuration_update_request &proposal);
-    void on_config_sync(const app_info &info,
+    // returns true if the config is applied fully, so that syncing it again is not needed
+    // until it changes
+    bool on_config_sync(const app_info &info,
                         const partition_configuration &config,
                         split_status::type meta_split_status);
     void on_cold_backup(const backup_request &request, /*out*/ backup_response &response);
@@ -485,6 +487,9 @@ private:
     // update envs to deny client request
     void update_deny_client(const std::map<std::string, std::string> &envs);
 
+    // update envs to compress the blocks of private log
+    void update_log_block_compression(const std::map<std::string, std::string> &envs);
+
     void init_disk_tag();
 
     // store `info` into a file under `path` directory
@@ -638,6 +643,8 @@ private:
     disk_status::type _disk_status{disk_status::NORMAL};
 
     bool _allow_ingest_behind{false};
+
+    log_block_codec _log_block_codec{log_block_codec::NONE};
 };
 typedef dsn::ref_ptr<replica> replica_ptr;
 } // namespace replication
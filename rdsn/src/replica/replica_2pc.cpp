@@ -561,6 +561,8 @@ void replica::on_append_log_completed(mutation_ptr &mu, error_code err, size_t s
         switch (status()) {
         case partition_status::PS_PRIMARY:
             if (err == ERR_OK) {
+                _primary_states.write_queue.window_controller().on_log_appended(
+                    dsn_now_us() - mu->prepare_ts_us());
                 do_possible_commit_on_primary(mu);
             } else {
                 handle_local_failure(err);
@@ -671,6 +673,8 @@ void replica::on_prepare_reply(std::pair<mutation_ptr, partition_status::type> p
                     "invalid secondary node address, address = %s",
                     node.to_string());
             dassert(mu->left_secondary_ack_count() > 0, "%u", mu->left_secondary_ack_count());
+            _primary_states.write_queue.window_controller().on_prepare_acked(
+                dsn_now_us() - mu->prepare_ts_us());
             if (0 == mu->decrease_left_secondary_ack_count()) {
                 do_possible_commit_on_primary(mu);
             }
@@ -578,6 +578,8 @@ void replica::update_app_envs_internal(const std::map<std::string, std::string>
     update_allow_ingest_behind(envs);
 
     update_deny_client(envs);
+
+    update_log_block_compression(envs);
 }
 
 void replica::update_bool_envs(const std::map<std::string, std::string> &envs,
@@ -643,6 +645,29 @@ void replica::update_deny_client(const std::map<std::string, std::string> &envs)
     _deny_client.write = (sub_sargs[1] == "write" || sub_sargs[1] == "all");
 }
 
+void replica::update_log_block_compression(const std::map<std::string, std::string> &envs)
+{
+    log_block_codec codec = log_block_codec::NONE;
+    std::string value = "none";
+    auto iter = envs.find(replica_envs::LOG_BLOCK_COMPRESSION);
+    if (iter != envs.end()) {
+        value = iter->second;
+        if (!parse_log_block_codec(value, codec)) {
+            dwarn_replica(
+                "invalid value of env {}: {}", replica_envs::LOG_BLOCK_COMPRESSION, value);
+            return;
+        }
+    }
+    if (codec != _log_block_codec) {
+        ddebug_replica("switch env[{}] to {}", replica_envs::LOG_BLOCK_COMPRESSION, value);
+        _log_block_codec = codec;
+    }
+    // the private log may be recreated, such as after learning
+    if (_private_log != nullptr) {
+        _private_log->set_block_codec(_log_block_codec);
+    }
+}
+
 void replica::query_app_envs(/*out*/ std::map<std::string, std::string> &envs)
 {
     if (_app) {
@@ -1093,14 +1118,14 @@ bool replica::update_local_configuration_with_no_ballot_change(partition_status:
 }
 
 // ThreadPool: THREAD_POOL_REPLICATION
-void replica::on_config_sync(const app_info &info,
+bool replica::on_config_sync(const app_info &info,
                              const partition_configuration &config,
                              split_status::type meta_split_status)
 {
     dinfo_replica("configuration sync");
     // no outdated update
     if (config.ballot < get_ballot())
-        return;
+        return false;
 
     update_app_max_replica_count(info.max_replica_count);
     update_app_envs(info.envs);
@@ -1109,8 +1134,10 @@ void replica::on_config_sync(const app_info &info,
     if (status() == partition_status::PS_PRIMARY) {
         if (nullptr != _primary_states.reconfiguration_task) {
             // already under reconfiguration, skip configuration sync
+            return false;
         } else if (info.partition_count != _app_info.partition_count) {
             _split_mgr->trigger_primary_parent_split(info.partition_count, meta_split_status);
+            return false;
         }
     } else {
         if (_is_initializing) {
@@ -1120,7 +1147,7 @@ void replica::on_config_sync(const app_info &info,
                 update_configuration_on_meta_server(config_type::CT_PRIMARY_FORCE_UPDATE_BALLOT,
                                                     config.primary,
                                                     const_cast<partition_configuration &>(config));
-                return;
+                return false;
             }
             _is_initializing = false;
         }
@@ -1139,8 +1166,10 @@ void replica::on_config_sync(const app_info &info,
             } else {
                 ddebug("%s: state is non-transient inactive, waiting primary to remove me", name());
             }
+            return false;
         }
     }
+    return true;
 }
 
 void replica::update_app_max_replica_count(int32_t max_replica_count)
@@ -248,6 +248,7 @@ error_code replica::init_app_and_prepare_list(bool create_new)
 
             _private_log = new mutation_log_private(
                 log_dir, _options->log_private_file_size_mb, get_gpid(), this);
+            _private_log->set_block_codec(_log_block_codec);
             ddebug("%s: plog_dir = %s", name(), log_dir.c_str());
 
             // sync valid_start_offset between app and logs
@@ -341,6 +342,7 @@ error_code replica::init_app_and_prepare_list(bool create_new)
 
             _private_log = new mutation_log_private(
                 log_dir, _options->log_private_file_size_mb, get_gpid(), this);
+            _private_log->set_block_codec(_log_block_codec);
             ddebug("%s: plog_dir = %s", name(), log_dir.c_str());
 
             err = _private_log->open(nullptr, [this](error_code err) {
@@ -39,6 +39,8 @@
 #include "replica_stub.h"
 #include "replica/duplication/replica_duplicator_manager.h"
 
+#include <set>
+
 #include <dsn/utility/filesystem.h>
 #include <dsn/dist/replication/replication_app_base.h>
 #include <dsn/dist/fmt_logging.h>
@@ -885,7 +887,22 @@ void replica::on_learn_reply(error_code err, learn_request &&req, learn_response
 
     else if (resp.state.files.size() > 0) {
         auto learn_dir = _app->learn_dir();
-        utils::filesystem::remove_path(learn_dir);
+        // files an interrupted round left for the files to learn now are kept with their copy
+        // manifests, nfs resumes them if they come from the same remote files
+        std::set<std::string> resumable_files;
+        for (const auto &f : resp.state.files) {
+            std::string file = utils::filesystem::path_combine(learn_dir, f);
+            resumable_files.insert(nfs_node::copy_manifest_path(file));
+            resumable_files.insert(std::move(file));
+        }
+        std::vector<std::string> stale_files;
+        if (utils::filesystem::get_subfiles(learn_dir, stale_files, true)) {
+            for (const auto &f : stale_files) {
+                if (resumable_files.count(utils::filesystem::path_combine(f, "")) == 0) {
+                    utils::filesystem::remove_path(f);
+                }
+            }
+        }
         utils::filesystem::create_directory(learn_dir);
 
         if (!dsn::utils::filesystem::directory_exists(learn_dir)) {
@@ -75,6 +75,14 @@ DSN_DEFINE_uint32("replication",
                   "max concurrent manual emergency checkpoint running count");
 DSN_TAG_VARIABLE(max_concurrent_manual_emergency_checkpointing_count, FT_MUTABLE);
 
+DSN_DEFINE_uint32("replication",
+                  config_sync_full_interval,
+                  10,
+                  "every how many config syncs one reports all the stored replicas and gets all "
+                  "the partitions, others get only the changed partitions. 0 and 1 mean every "
+                  "config sync is full");
+DSN_TAG_VARIABLE(config_sync_full_interval, FT_MUTABLE);
+
 bool replica_stub::s_not_exit_on_log_failure = false;
 
 replica_stub::replica_stub(replica_state_subscriber subscriber /*= nullptr*/,
@@ -111,6 +119,7 @@ replica_stub::replica_stub(replica_state_subscriber subscriber /*= nullptr*/,
     _is_long_subscriber = is_long_subscriber;
     _failure_detector = nullptr;
     _state = NS_Disconnected;
+    _config_sync_count = 0;
     _log = nullptr;
     _primary_address_str[0] = '\0';
     install_perf_counters();
@@ -1359,14 +1368,42 @@ void replica_stub::query_configuration_by_node()
     configuration_query_by_node_request req;
     req.node = _primary_address;
 
-    // TODO: send stored replicas may cost network, we shouldn't config the frequency
-    get_local_replicas(req.stored_replicas);
-    req.__isset.stored_replicas = true;
+    // a full sync reports the stored replicas and gets every partition, which also redoes the
+    // work a replica may skip on an unchanged config, while the others get only the
+    // partitions changed since the versions the replicas have synced
+    bool is_full_sync = FLAGS_config_sync_full_interval <= 1 ||
+                        _config_sync_count % FLAGS_config_sync_full_interval == 0;
+    ++_config_sync_count;
+    if (is_full_sync) {
+        get_local_replicas(req.stored_replicas);
+        req.__isset.stored_replicas = true;
+    } else {
+        zauto_read_lock l(_replicas_lock);
+        for (const auto &kv : _replicas) {
+            // only the replicas in a steady status skip syncing an unchanged config
+            partition_status::type status = kv.second->status();
+            if (status != partition_status::PS_PRIMARY &&
+                status != partition_status::PS_SECONDARY) {
+                continue;
+            }
+            // the replica may have changed since it applied the config, which has to be
+            // synced again then
+            auto iter = _config_sync_versions.find(kv.first);
+            if (iter != _config_sync_versions.end() &&
+                iter->second.config_ballot == kv.second->get_ballot() &&
+                iter->second.status == status) {
+                req.partition_versions.emplace(iter->first, iter->second.version);
+            }
+        }
+    }
+    req.__isset.partition_versions = true;
 
     ::dsn::marshall(msg, req);
 
-    ddebug("send query node partitions request to meta server, stored_replicas_count = %d",
-           (int)req.stored_replicas.size());
+    ddebug("send query node partitions request to meta server, stored_replicas_count = %d, "
+           "partition_versions_count = %d",
+           (int)req.stored_replicas.size(),
+           (int)req.partition_versions.size());
 
     rpc_address target(_failure_detector->get_servers());
     _config_query_task =
@@ -1438,8 +1475,9 @@ void replica_stub::on_node_query_reply(error_code err,
         }
 
         ddebug_f("process query node partitions response for resp.err = ERR_OK, "
-                 "partitions_count({}), gc_replicas_count({})",
+                 "partitions_count({}), unchanged_partitions_count({}), gc_replicas_count({})",
                  resp.partitions.size(),
+                 resp.unchanged_partitions.size(),
                  resp.gc_replicas.size());
 
         replicas rs;
@@ -1448,11 +1486,45 @@ void replica_stub::on_node_query_reply(error_code err,
             rs = _replicas;
         }
 
+        // meta server of old versions ignores the versions and replies every partition. The
+        // versions of the unchanged partitions are kept, while the others are recorded by the
+        // scatter tasks once the replicas have applied the configs
+        std::map<gpid, config_sync_version> versions;
+        if (resp.__isset.partition_versions) {
+            for (const gpid &pid : resp.unchanged_partitions) {
+                rs.erase(pid);
+                auto iter = _config_sync_versions.find(pid);
+                if (iter != _config_sync_versions.end()) {
+                    versions.emplace(pid, iter->second);
+                }
+            }
+        }
+        _config_sync_versions = std::move(versions);
+
+        std::unordered_map<int32_t, const app_info *> apps;
+        for (const app_info &info : resp.apps) {
+            apps.emplace(info.app_id, &info);
+        }
+
         for (auto it = resp.partitions.begin(); it != resp.partitions.end(); ++it) {
             rs.erase(it->config.pid);
+            if (resp.__isset.apps) {
+                auto app = apps.find(it->config.pid.get_app_id());
+                dassert_f(app != apps.end(),
+                          "app_info of {} is missing in config sync response",
+                          it->config.pid);
+                it->info = *app->second;
+            }
+            auto version = resp.partition_versions.find(it->config.pid);
+            bool has_version = version != resp.partition_versions.end();
             tasking::enqueue(LPC_QUERY_NODE_CONFIGURATION_SCATTER,
                              &_tracker,
-                             std::bind(&replica_stub::on_node_query_reply_scatter, this, this, *it),
+                             std::bind(&replica_stub::on_node_query_reply_scatter,
+                                       this,
+                                       this,
+                                       *it,
+                                       has_version,
+                                       has_version ? version->second : 0),
                              it->config.pid.thread_hash());
         }
 
@@ -1488,10 +1560,11 @@ void replica_stub::set_meta_server_connected_for_test(
     _state = NS_Connected;
 
     for (auto it = resp.partitions.begin(); it != resp.partitions.end(); ++it) {
-        tasking::enqueue(LPC_QUERY_NODE_CONFIGURATION_SCATTER,
-                         &_tracker,
-                         std::bind(&replica_stub::on_node_query_reply_scatter, this, this, *it),
-                         it->config.pid.thread_hash());
+        tasking::enqueue(
+            LPC_QUERY_NODE_CONFIGURATION_SCATTER,
+            &_tracker,
+            std::bind(&replica_stub::on_node_query_reply_scatter, this, this, *it, false, 0),
+            it->config.pid.thread_hash());
     }
 }
 
@@ -1506,14 +1579,25 @@ void replica_stub::set_replica_state_subscriber_for_test(replica_state_subscribe
 // replica_stub::close
 // ThreadPool: THREAD_POOL_REPLICATION
 void replica_stub::on_node_query_reply_scatter(replica_stub_ptr this_,
-                                               const configuration_update_request &req)
+                                               const configuration_update_request &req,
+                                               bool has_sync_version,
+                                               int64_t sync_version)
 {
     replica_ptr replica = get_replica(req.config.pid);
     if (replica != nullptr) {
-        replica->on_config_sync(req.info,
-                                req.config,
-                                req.__isset.meta_split_status ? req.meta_split_status
-                                                              : split_status::NOT_SPLIT);
+        bool applied =
+            replica->on_config_sync(req.info,
+                                    req.config,
+                                    req.__isset.meta_split_status ? req.meta_split_status
+                                                                  : split_status::NOT_SPLIT);
+        // a config skipped or applied partly is synced again by the next config sync
+        if (applied && has_sync_version) {
+            zauto_lock l(_state_lock);
+            if (_state == NS_Connected) {
+                _config_sync_versions[req.config.pid] = {
+                    sync_version, replica->get_ballot(), replica->status()};
+            }
+        }
     } else {
         if (req.config.primary == _primary_address) {
             ddebug("%s@%s: replica not exists on replica server, which is primary, remove it "
@@ -1586,6 +1670,9 @@ void replica_stub::on_meta_server_disconnected()
         return;
 
     _state = NS_Disconnected;
+    // the first config sync after reconnected is a full one
+    _config_sync_count = 0;
+    _config_sync_versions.clear();
 
     replicas rs;
     {
@@ -253,8 +253,11 @@ private:
     void query_configuration_by_node();
     void on_meta_server_disconnected_scatter(replica_stub_ptr this_, gpid id);
     void on_node_query_reply(error_code err, dsn::message_ex *request, dsn::message_ex *response);
+    // `sync_version` is recorded once the config is applied if `has_sync_version` is set
     void on_node_query_reply_scatter(replica_stub_ptr this_,
-                                     const configuration_update_request &config);
+                                     const configuration_update_request &config,
+                                     bool has_sync_version,
+                                     int64_t sync_version);
     void on_node_query_reply_scatter2(replica_stub_ptr this_, gpid id);
     void remove_replica_on_meta_server(const app_info &info, const partition_configuration &config);
     task_ptr begin_open_replica(const app_info &app,
@@ -364,6 +367,17 @@ private:
     // temproal states
     ::dsn::task_ptr _config_query_task;
     ::dsn::task_ptr _config_sync_timer_task;
+    struct config_sync_version
+    {
+        int64_t version;
+        // the ballot and status of the replica once it applied the config of `version`
+        ballot config_ballot;
+        partition_status::type status;
+    };
+    // versions of the partition configs the replicas have applied, the next config sync gets
+    // only the partitions changed since, protected by _state_lock
+    std::map<gpid, config_sync_version> _config_sync_versions;
+    uint32_t _config_sync_count;
     ::dsn::task_ptr _gc_timer_task;
     ::dsn::task_ptr _disk_stat_timer_task;
     ::dsn::task_ptr _mem_release_timer_task;
@@ -166,5 +166,172 @@ TEST_F(log_appender_test, read_log_block)
     ASSERT_EQ(mutation_idx, 1024);
 }
 
+TEST_F(log_block_test, parse_log_block_codec)
+{
+    log_block_codec codec = log_block_codec::NONE;
+    ASSERT_TRUE(parse_log_block_codec("lz4", codec));
+    ASSERT_EQ(codec, log_block_codec::LZ4);
+    ASSERT_TRUE(parse_log_block_codec("ZSTD", codec));
+    ASSERT_EQ(codec, log_block_codec::ZSTD);
+    ASSERT_TRUE(parse_log_block_codec("none", codec));
+    ASSERT_EQ(codec, log_block_codec::NONE);
+    ASSERT_FALSE(parse_log_block_codec("snappy", codec));
+    ASSERT_EQ(codec, log_block_codec::NONE);
+}
+
+class log_appender_codec_test : public replica_test_base,
+                                public ::testing::WithParamInterface<log_block_codec>
+{
+};
+
+TEST_P(log_appender_codec_test, read_compressed_log_block)
+{
+    log_appender appender(GetParam());
+    for (int i = 0; i < 1024; i++) { // more than DEFAULT_MAX_BLOCK_BYTES
+        appender.append_mutation(create_test_mutation(1 + i, std::string(1024, 'a')), nullptr);
+    }
+    ASSERT_FALSE(appender.is_sealed());
+    ASSERT_TRUE(appender.all_blocks().empty());
+    appender.seal(10);
+    ASSERT_TRUE(appender.is_sealed());
+    ASSERT_EQ(appender.all_blocks().size(), 2);
+
+    // the repeated data shrinks a lot
+    ASSERT_LT(appender.size(), 1024 * 1024 / 4);
+
+    size_t sz = 0;
+    int64_t start_offset = 10;
+    int mutation_idx = 0;
+    for (const log_block &blk : appender.all_blocks()) {
+        ASSERT_EQ(start_offset, blk.start_offset());
+        sz += blk.size();
+        start_offset += blk.size();
+
+        std::string buffer;
+        for (size_t i = 1; i < blk.data().size(); ++i) {
+            buffer += blk.data()[i].to_string();
+        }
+        auto hdr = *reinterpret_cast<const log_block_header *>(blk.front().data());
+        ASSERT_TRUE(hdr.is_valid());
+        ASSERT_TRUE(hdr.has_codec());
+        ASSERT_EQ(hdr.codec(), GetParam());
+
+        blob raw;
+        ASSERT_TRUE(log_block::decompress(hdr, blob::create_from_bytes(std::move(buffer)), raw));
+        binary_reader reader(raw);
+        while (!reader.is_eof()) {
+            mutation_ptr mu = mutation::read_from(reader, nullptr);
+            // all mutations of a compressed block take the block start offset
+            ASSERT_EQ(mu->data.header.log_offset, blk.start_offset());
+            ASSERT_EQ(mu->data.header.decree, 1 + mutation_idx);
+            mutation_idx++;
+        }
+    }
+    ASSERT_EQ(sz, appender.size());
+    ASSERT_EQ(mutation_idx, 1024);
+}
+
+TEST_P(log_appender_codec_test, decompress_corrupted_data)
+{
+    log_appender appender(GetParam());
+    appender.append_mutation(create_test_mutation(1, std::string(8 * 1024, 'a')), nullptr);
+    appender.seal(10);
+
+    const log_block &blk = appender.all_blocks()[0];
+    ASSERT_EQ(blk.data().size(), 2);
+    auto hdr = *reinterpret_cast<const log_block_header *>(blk.front().data());
+    ASSERT_EQ(hdr.codec(), GetParam());
+
+    std::string buffer = blk.data()[1].to_string();
+    buffer.resize(buffer.size() / 2);
+    blob raw;
+    ASSERT_FALSE(log_block::decompress(hdr, blob::create_from_bytes(std::move(buffer)), raw));
+}
+
+INSTANTIATE_TEST_CASE_P(log_appender_codec,
+                        log_appender_codec_test,
+                        ::testing::Values(log_block_codec::LZ4, log_block_codec::ZSTD));
+
+TEST_F(log_appender_test, deferred_log_block)
+{
+    // the mutations are written into the blocks as if the start offset was known on appending
+    log_appender expected(10);
+    log_appender appender(log_block_codec::NONE);
+    for (int i = 0; i < 1024; i++) { // more than DEFAULT_MAX_BLOCK_BYTES
+        expected.append_mutation(create_test_mutation(1 + i, std::string(1024, 'a')), nullptr);
+        appender.append_mutation(create_test_mutation(1 + i, std::string(1024, 'a')), nullptr);
+    }
+    ASSERT_EQ(appender.mutation_count(), 1024);
+    ASSERT_FALSE(appender.is_sealed());
+    appender.seal(10);
+    ASSERT_TRUE(appender.is_sealed());
+
+    ASSERT_EQ(appender.size(), expected.size());
+    ASSERT_EQ(appender.blob_count(), expected.blob_count());
+    ASSERT_EQ(appender.all_blocks().size(), expected.all_blocks().size());
+    for (size_t i = 0; i < appender.all_blocks().size(); ++i) {
+        const log_block &blk = appender.all_blocks()[i];
+        ASSERT_EQ(blk.start_offset(), expected.all_blocks()[i].start_offset());
+        auto hdr = *reinterpret_cast<const log_block_header *>(blk.front().data());
+        ASSERT_EQ(hdr.magic, LOG_BLOCK_MAGIC);
+    }
+    auto mutations = appender.mutations();
+    auto expected_mutations = expected.mutations();
+    for (size_t i = 0; i < mutations.size(); ++i) {
+        ASSERT_EQ(mutations[i]->data.header.log_offset,
+                  expected_mutations[i]->data.header.log_offset);
+    }
+}
+
+TEST_F(log_appender_test, small_log_block_not_compressed)
+{
+    log_appender raw(10);
+    raw.append_mutation(create_test_mutation(1, std::string(1024, 'a')), nullptr);
+
+    log_appender appender(log_block_codec::LZ4);
+    appender.append_mutation(create_test_mutation(1, std::string(1024, 'a')), nullptr);
+    appender.seal(10);
+
+    // too small to be worth compressing, the data is kept as is
+    ASSERT_EQ(appender.size(), raw.size());
+    const log_block &blk = appender.all_blocks()[0];
+    auto hdr = *reinterpret_cast<const log_block_header *>(blk.front().data());
+    ASSERT_TRUE(hdr.has_codec());
+    ASSERT_EQ(hdr.codec(), log_block_codec::NONE);
+
+    std::string buffer;
+    for (size_t i = 1; i < blk.data().size(); ++i) {
+        buffer += blk.data()[i].to_string();
+    }
+    blob raw_data;
+    ASSERT_TRUE(log_block::decompress(hdr, blob::create_from_bytes(std::move(buffer)), raw_data));
+    binary_reader reader(raw_data);
+    mutation_ptr mu = mutation::read_from(reader, nullptr);
+    ASSERT_EQ(mu->data.header.log_offset, 10);
+    ASSERT_TRUE(reader.is_eof());
+}
+
+TEST_F(log_appender_test, incompressible_log_block)
+{
+    std::string data(8 * 1024, '\0');
+    uint32_t seed = 1;
+    for (char &c : data) {
+        seed = seed * 1103515245 + 12345;
+        c = static_cast<char>(seed >> 16);
+    }
+    log_appender raw(10);
+    raw.append_mutation(create_test_mutation(1, data), nullptr);
+
+    log_appender appender(log_block_codec::LZ4);
+    appender.append_mutation(create_test_mutation(1, data), nullptr);
+    appender.seal(10);
+
+    // random data doesn't shrink, so it's kept as is
+    ASSERT_EQ(appender.size(), raw.size());
+    auto hdr = *reinterpret_cast<const log_block_header *>(appender.all_blocks()[0].front().data());
+    ASSERT_TRUE(hdr.has_codec());
+    ASSERT_EQ(hdr.codec(), log_block_codec::NONE);
+}
+
 } // namespace replication
 } // namespace dsn
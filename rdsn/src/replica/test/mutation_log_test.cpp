@@ -25,6 +25,7 @@
  */
 
 #include "replica/mutation_log.h"
+#include "replica/log_replay_pipeline.h"
 #include "replica_test_base.h"
 
 #include <dsn/utility/filesystem.h>
@@ -350,12 +351,14 @@ public:
         return mlog;
     }
 
-    void test_replay_single_file(int num_entries)
+    void test_replay_single_file(int num_entries,
+                                 log_block_codec codec = log_block_codec::NONE)
     {
         std::vector<mutation_ptr> mutations;
 
         { // writing logs
             mutation_log_ptr mlog = create_private_log();
+            mlog->set_block_codec(codec);
 
             for (int i = 0; i < num_entries; i++) {
                 mutation_ptr mu = create_test_mutation(2 + i, "hello!");
@@ -427,6 +430,40 @@ public:
             ASSERT_GE(log_files.size(), 1);
         }
     }
+
+    // writes a shared log of mutations of `gpid_count` gpids in turn, returns the log files
+    std::vector<std::string> write_shared_log(int gpid_count, int num_entries)
+    {
+        std::string log_dir = _log_dir + "/slog";
+        {
+            mutation_log_ptr mlog = new mutation_log_shared(log_dir, 1, false);
+            EXPECT_EQ(ERR_OK, mlog->open(nullptr, nullptr));
+            for (int i = 0; i < num_entries; i++) {
+                mutation_ptr mu = create_test_mutation(2 + i / gpid_count, "hello!");
+                mu->data.header.pid = gpid(1, i % gpid_count);
+                mlog->append(mu, LPC_AIO_IMMEDIATE_CALLBACK, nullptr, nullptr, 0);
+            }
+            mlog->close();
+        }
+
+        std::vector<std::string> log_files;
+        EXPECT_TRUE(utils::filesystem::get_subfiles(log_dir, log_files, false));
+        return log_files;
+    }
+
+    static std::map<int, log_file_ptr> open_logs(const std::vector<std::string> &log_files)
+    {
+        std::map<int, log_file_ptr> logs;
+        for (const auto &path : log_files) {
+            error_code ec;
+            log_file_ptr log = log_file::open_read(path.c_str(), ec);
+            EXPECT_EQ(ERR_OK, ec) << path;
+            if (log != nullptr) {
+                logs[log->index()] = log;
+            }
+        }
+        return logs;
+    }
 };
 
 TEST_F(mutation_log_test, replay_single_file_1000) { test_replay_single_file(1000); }
@@ -441,6 +478,16 @@ TEST_F(mutation_log_test, replay_single_file_1) { test_replay_single_file(1); }
 
 TEST_F(mutation_log_test, replay_single_file_10) { test_replay_single_file(10); }
 
+TEST_F(mutation_log_test, replay_single_file_lz4)
+{
+    test_replay_single_file(1000, log_block_codec::LZ4);
+}
+
+TEST_F(mutation_log_test, replay_single_file_zstd)
+{
+    test_replay_single_file(1000, log_block_codec::ZSTD);
+}
+
 // mutation_log::open
 TEST_F(mutation_log_test, open)
 {
@@ -481,6 +528,84 @@ TEST_F(mutation_log_test, replay_multiple_files_20000_1mb) { test_replay_multipl
 
 TEST_F(mutation_log_test, replay_multiple_files_50000_1mb) { test_replay_multiple_files(50000, 1); }
 
+TEST_F(mutation_log_test, replay_in_pipeline)
+{
+    const int gpid_count = 4;
+    const int num_entries = 5000;
+    std::vector<std::string> log_files = write_shared_log(gpid_count, num_entries);
+    ASSERT_GT(log_files.size(), 1);
+    std::map<int, log_file_ptr> logs = open_logs(log_files);
+    int64_t log_end_offset = logs.rbegin()->second->end_offset();
+
+    std::mutex lock;
+    std::map<gpid, std::vector<decree>> replayed;
+    // little pending bytes to make the reading wait for the replaying
+    log_replay_pipeline pipeline(
+        [&lock, &replayed](int log_length, mutation_ptr &mu) -> bool {
+            std::lock_guard<std::mutex> l(lock);
+            replayed[mu->data.header.pid].push_back(mu->data.header.decree);
+            return true;
+        },
+        64 * 1024);
+    int64_t end_offset = 0;
+    ASSERT_EQ(ERR_OK, pipeline.run(logs, end_offset));
+    ASSERT_EQ(log_end_offset, end_offset);
+
+    // the mutations of each gpid are replayed in order
+    ASSERT_EQ(static_cast<size_t>(gpid_count), replayed.size());
+    for (const auto &kv : replayed) {
+        ASSERT_EQ(static_cast<size_t>(num_entries / gpid_count), kv.second.size());
+        for (size_t i = 0; i < kv.second.size(); i++) {
+            ASSERT_EQ(static_cast<decree>(2 + i), kv.second[i]);
+        }
+    }
+}
+
+TEST_F(mutation_log_test, replay_incomplete_log_in_pipeline)
+{
+    std::vector<std::string> log_files = write_shared_log(2, 2000);
+    ASSERT_GT(log_files.size(), 1);
+
+    // cut the tail of the last file
+    std::string last_file;
+    {
+        std::map<int, log_file_ptr> logs = open_logs(log_files);
+        last_file = logs.rbegin()->second->path();
+        for (auto &kv : logs) {
+            kv.second->close();
+        }
+    }
+    int64_t file_size = 0;
+    ASSERT_TRUE(utils::filesystem::file_size(last_file, file_size));
+    copy_file(last_file.c_str(), (last_file + ".tmp").c_str(), file_size - 10);
+    ASSERT_TRUE(utils::filesystem::rename_path(last_file + ".tmp", last_file));
+
+    // the pipeline replays the same mutations as the sequential replay
+    int expected_count = 0;
+    int64_t expected_end_offset = 0;
+    ASSERT_EQ(ERR_OK,
+              mutation_log::replay(log_files,
+                                   [&expected_count](int log_length, mutation_ptr &mu) -> bool {
+                                       expected_count++;
+                                       return true;
+                                   },
+                                   expected_end_offset));
+
+    std::atomic<int> count{0};
+    log_replay_pipeline pipeline(
+        [&count](int log_length, mutation_ptr &mu) -> bool {
+            count++;
+            return true;
+        },
+        1024 * 1024);
+    std::map<int, log_file_ptr> logs = open_logs(log_files);
+    int64_t end_offset = 0;
+    ASSERT_EQ(ERR_OK, pipeline.run(logs, end_offset));
+    ASSERT_EQ(expected_count, count.load());
+    ASSERT_EQ(expected_end_offset, end_offset);
+    ASSERT_LT(end_offset, logs.rbegin()->second->end_offset());
+}
+
 TEST_F(mutation_log_test, replay_start_decree)
 {
     // decree ranges from [1, 30)
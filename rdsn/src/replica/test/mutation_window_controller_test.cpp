@@ -0,0 +1,179 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "replica/mutation_window_controller.h"
+
+#include <gtest/gtest.h>
+#include <dsn/utility/flags.h>
+
+namespace dsn {
+namespace replication {
+
+DSN_DECLARE_bool(mutation_2pc_adaptive_window_enabled);
+DSN_DECLARE_int32(mutation_2pc_min_window);
+DSN_DECLARE_int32(mutation_2pc_min_batch_bytes);
+DSN_DECLARE_int32(mutation_2pc_max_batch_bytes);
+DSN_DECLARE_int32(mutation_2pc_window_adjust_samples);
+
+class mutation_window_controller_test : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        FLAGS_mutation_2pc_adaptive_window_enabled = true;
+        FLAGS_mutation_2pc_min_window = 2;
+        FLAGS_mutation_2pc_min_batch_bytes = 64 * 1024;
+        FLAGS_mutation_2pc_max_batch_bytes = 4 * 1024 * 1024;
+        FLAGS_mutation_2pc_window_adjust_samples = 4;
+    }
+
+    void TearDown() override { FLAGS_mutation_2pc_adaptive_window_enabled = false; }
+
+    // runs a round of samples with the given latencies and queue depth
+    static void run_round(mutation_window_controller &cntl,
+                          uint64_t prepare_rtt_us,
+                          uint64_t log_latency_us,
+                          int queue_depth)
+    {
+        for (int i = 0; i < FLAGS_mutation_2pc_window_adjust_samples; ++i) {
+            cntl.on_prepare_acked(prepare_rtt_us);
+            cntl.on_log_appended(log_latency_us);
+            cntl.on_mutation_started(2, queue_depth);
+        }
+    }
+
+    static int window(const mutation_window_controller &cntl) { return cntl._window; }
+    static int batch_bytes(const mutation_window_controller &cntl) { return cntl._batch_bytes; }
+};
+
+TEST_F(mutation_window_controller_test, disabled)
+{
+    FLAGS_mutation_2pc_adaptive_window_enabled = false;
+    mutation_window_controller cntl(gpid(1, 1), 10);
+    ASSERT_EQ(10, cntl.window());
+    ASSERT_EQ(1024 * 1024, cntl.batch_bytes());
+
+    run_round(cntl, 100, 100, 0);
+    run_round(cntl, 1000, 1000, 5);
+    ASSERT_EQ(10, cntl.window());
+    ASSERT_EQ(1024 * 1024, cntl.batch_bytes());
+}
+
+TEST_F(mutation_window_controller_test, shrink_when_saturated)
+{
+    // keep the batch bytes unchanged
+    FLAGS_mutation_2pc_max_batch_bytes = 1024 * 1024;
+    mutation_window_controller cntl(gpid(1, 1), 20);
+    ASSERT_EQ(20, cntl.window());
+
+    // the first round sets the base latency
+    run_round(cntl, 100, 100, 5);
+    ASSERT_EQ(20, cntl.window());
+
+    // prepare rtt tripled: cut the window
+    run_round(cntl, 300, 100, 5);
+    ASSERT_EQ(15, cntl.window());
+
+    // so does the log latency
+    run_round(cntl, 100, 300, 5);
+    ASSERT_EQ(12, cntl.window());
+
+    // never below the min window, and the batch bytes are not changed by saturation
+    for (int i = 0; i < 10; ++i) {
+        run_round(cntl, 1000, 1000, 5);
+    }
+    ASSERT_EQ(2, cntl.window());
+    ASSERT_EQ(1024 * 1024, cntl.batch_bytes());
+}
+
+TEST_F(mutation_window_controller_test, grow_when_backlogged)
+{
+    mutation_window_controller cntl(gpid(1, 1), 10);
+
+    // idle: batch less, down to the min bytes
+    for (int i = 0; i < 5; ++i) {
+        run_round(cntl, 1000, 1000, 0);
+    }
+    ASSERT_EQ(10, cntl.window());
+    ASSERT_EQ(64 * 1024, cntl.batch_bytes());
+
+    run_round(cntl, 3000, 3000, 0);
+    ASSERT_EQ(8, cntl.window());
+
+    // latency is back to normal with writes queued: grow the window up to the max
+    for (int i = 0; i < 2; ++i) {
+        run_round(cntl, 1000, 1000, 3);
+    }
+    ASSERT_EQ(10, cntl.window());
+    ASSERT_EQ(64 * 1024, cntl.batch_bytes());
+
+    // then batch more
+    run_round(cntl, 1000, 1000, 3);
+    ASSERT_EQ(10, cntl.window());
+    ASSERT_EQ(128 * 1024, cntl.batch_bytes());
+}
+
+TEST_F(mutation_window_controller_test, relearn_latency_with_new_batch_bytes)
+{
+    mutation_window_controller cntl(gpid(1, 1), 20);
+
+    // larger mutations take longer, which is not taken as saturation
+    run_round(cntl, 100, 100, 5);
+    ASSERT_EQ(2 * 1024 * 1024, cntl.batch_bytes());
+    run_round(cntl, 300, 300, 5);
+    ASSERT_EQ(20, cntl.window());
+    ASSERT_EQ(4 * 1024 * 1024, cntl.batch_bytes());
+
+    // the base latency of the max batch bytes
+    run_round(cntl, 300, 300, 5);
+    run_round(cntl, 300, 300, 5);
+    ASSERT_EQ(20, cntl.window());
+
+    run_round(cntl, 900, 900, 5);
+    ASSERT_EQ(15, cntl.window());
+    ASSERT_EQ(4 * 1024 * 1024, cntl.batch_bytes());
+}
+
+TEST_F(mutation_window_controller_test, max_batch_bytes)
+{
+    FLAGS_mutation_2pc_max_batch_bytes = 1 << 30;
+    mutation_window_controller cntl(gpid(1, 1), 10);
+    for (int i = 0; i < 20; ++i) {
+        run_round(cntl, 1000, 1000, 3);
+    }
+    ASSERT_EQ(10, cntl.window());
+    ASSERT_EQ(1 << 30, cntl.batch_bytes());
+}
+
+TEST_F(mutation_window_controller_test, reset_when_disabled)
+{
+    // keep the batch bytes unchanged
+    FLAGS_mutation_2pc_max_batch_bytes = 1024 * 1024;
+    mutation_window_controller cntl(gpid(1, 1), 10);
+    run_round(cntl, 1000, 1000, 5);
+    run_round(cntl, 3000, 3000, 5);
+    ASSERT_NE(10, window(cntl));
+
+    FLAGS_mutation_2pc_adaptive_window_enabled = false;
+    ASSERT_EQ(10, cntl.window());
+    run_round(cntl, 1000, 1000, 0);
+    ASSERT_EQ(10, window(cntl));
+    ASSERT_EQ(1024 * 1024, batch_bytes(cntl));
+}
+
+} // namespace replication
+} // namespace dsn
@@ -128,24 +128,27 @@ void asio_rpc_session::do_read(int read_next)
 
 void asio_rpc_session::send(uint64_t signature)
 {
-    std::vector<boost::asio::const_buffer> asio_wbufs;
     int bcount = (int)_sending_buffers.size();
+    size_t msg_count = _sending_msgs.size();
 
     // prepare buffers
-    asio_wbufs.resize(bcount);
+    _write_buffers.clear();
     for (int i = 0; i < bcount; i++) {
-        asio_wbufs[i] = boost::asio::const_buffer(_sending_buffers[i].buf, _sending_buffers[i].sz);
+        _write_buffers.emplace_back(_sending_buffers[i].buf, _sending_buffers[i].sz);
     }
 
     add_ref();
 
     boost::asio::async_write(
-        *_socket, asio_wbufs, [this, signature](boost::system::error_code ec, std::size_t length) {
+        *_socket,
+        write_buffers_ref{&_write_buffers},
+        [this, signature, msg_count](boost::system::error_code ec, std::size_t length) {
             if (ec) {
                 derror(
                     "asio write to %s failed: %s", _remote_addr.to_string(), ec.message().c_str());
                 on_failure(true);
             } else {
+                _net.on_messages_sent(length, msg_count);
                 on_send_completed(signature);
             }
 
@@ -160,6 +163,7 @@ asio_rpc_session::asio_rpc_session(asio_network_provider &net,
                                    bool is_client)
     : rpc_session(net, remote_addr, parser, is_client), _socket(socket)
 {
+    _write_buffers.reserve(net.max_buffer_block_count_per_send());
     set_options();
 }
 
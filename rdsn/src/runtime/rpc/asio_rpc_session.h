@@ -64,10 +64,26 @@ private:
         }
     }
 
+    // a ConstBufferSequence referring to _write_buffers, so that async_write doesn't copy the
+    // buffers; it's valid because only one write is in flight at a time
+    struct write_buffers_ref
+    {
+        typedef boost::asio::const_buffer value_type;
+        typedef std::vector<boost::asio::const_buffer>::const_iterator const_iterator;
+
+        const std::vector<boost::asio::const_buffer> *buffers;
+
+        const_iterator begin() const { return buffers->begin(); }
+        const_iterator end() const { return buffers->end(); }
+    };
+
 private:
     // boost::asio::socket is thread-unsafe, must use lock to prevent a
     // reading/writing socket being modified or closed concurrently.
     std::shared_ptr<boost::asio::ip::tcp::socket> _socket;
+
+    // reused by each send() to avoid allocating for every write
+    std::vector<boost::asio::const_buffer> _write_buffers;
 };
 
 } // namespace tools
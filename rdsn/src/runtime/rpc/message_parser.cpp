@@ -147,6 +147,8 @@ char *message_reader::read_buffer_ptr(unsigned int read_next)
         // TODO(wutao1): make it a buffer queue like what sofa-pbrpc does
         //               (https://github.com/baidu/sofa-pbrpc/blob/master/src/sofa/pbrpc/buffer.h)
         //               to reduce memory copy.
+        // the receive blocks are released by the worker threads, so they are not drawn from the
+        // buffer pool, which would leave them in the caches of the workers
         _buffer.assign(dsn::utils::make_shared_array<char>(sz), 0, sz);
         _buffer_occupied = 0;
 
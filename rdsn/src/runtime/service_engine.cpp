@@ -30,6 +30,7 @@
 
 #include <dsn/dist/fmt_logging.h>
 #include <dsn/utility/filesystem.h>
+#include <dsn/utility/buffer_pool.h>
 #include <dsn/utility/smart_pointers.h>
 #include <dsn/tool-api/env_provider.h>
 #include <dsn/tool-api/command_manager.h>
@@ -190,6 +191,14 @@ service_engine::service_engine()
         "system.queue - get queue internal information",
         "system.queue",
         &service_engine::get_queue_info);
+
+    _get_buffer_pool_info_cmd = dsn::command_manager::instance().register_command(
+        {"system.buffer_pool"},
+        "system.buffer_pool - get allocation statistics of the rpc buffer pool",
+        "system.buffer_pool",
+        [](const std::vector<std::string> &args) {
+            return utils::buffer_pool::get_stats().to_string();
+        });
 }
 
 service_engine::~service_engine()
@@ -198,6 +207,7 @@ service_engine::~service_engine()
 
     UNREGISTER_VALID_HANDLER(_get_runtime_info_cmd);
     UNREGISTER_VALID_HANDLER(_get_queue_info_cmd);
+    UNREGISTER_VALID_HANDLER(_get_buffer_pool_info_cmd);
 }
 
 void service_engine::init_before_toollets(const service_spec &spec)
@@ -131,6 +131,7 @@ private:
 
     dsn_handle_t _get_runtime_info_cmd;
     dsn_handle_t _get_queue_info_cmd;
+    dsn_handle_t _get_buffer_pool_info_cmd;
 
     bool _simulator;
 
@@ -0,0 +1,140 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "fair_task_queue.h"
+
+#include <dsn/c/api_layer1.h>
+#include <dsn/dist/fmt_logging.h>
+#include <dsn/utility/flags.h>
+#include <dsn/utility/string_conv.h>
+#include <dsn/utility/strings.h>
+
+#include "task_engine.h"
+
+namespace dsn {
+namespace tools {
+
+DSN_DEFINE_string("core",
+                  fair_queue_app_weights,
+                  "",
+                  "weights of apps in fair_task_queue, in the format of "
+                  "app_id:weight[,app_id:weight...], apps not listed are weighted 1");
+
+fair_task_queue::fair_task_queue(task_worker_pool *pool, int index, task_queue *inner_provider)
+    : task_queue(pool, index, inner_provider)
+{
+    std::vector<std::string> weights;
+    utils::split_args(FLAGS_fair_queue_app_weights, weights, ',');
+    for (const auto &weight : weights) {
+        std::vector<std::string> kv;
+        utils::split_args(weight.c_str(), kv, ':');
+        int32_t app_id = 0;
+        int32_t value = 0;
+        if (kv.size() != 2 || !buf2int32(kv[0], app_id) || !buf2int32(kv[1], value) ||
+            value <= 0) {
+            derror_f("invalid fair_queue_app_weights item \"{}\", ignore it", weight);
+            continue;
+        }
+        _requests.set_app_weight(app_id, value);
+    }
+
+    _shed_task_counter.init_global_counter(pool->node()->full_name(),
+                                           "engine",
+                                           (get_name() + ".queue.shed_task").c_str(),
+                                           COUNTER_TYPE_VOLATILE_NUMBER,
+                                           "count of requests dropped due to client timeout");
+}
+
+void fair_task_queue::enqueue(task *task)
+{
+    entry e{task, dsn_now_ns()};
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        if (task->spec().type != TASK_TYPE_RPC_REQUEST ||
+            task->spec().priority == TASK_PRIORITY_HIGH) {
+            _urgent.push_back(e);
+        } else {
+            auto request = static_cast<rpc_request_task *>(task)->get_request();
+            _requests.push(request->header->gpid, e);
+        }
+    }
+    _cond.notify_one();
+}
+
+task *fair_task_queue::dequeue(int &batch_size)
+{
+    task *head = nullptr, *last = nullptr;
+    std::vector<task *> expired;
+    int count = 0;
+    {
+        std::unique_lock<std::mutex> l(_lock);
+        _cond.wait(l, [this]() { return !_urgent.empty() || !_requests.empty(); });
+
+        uint64_t now = dsn_now_ns();
+        entry e;
+        while (count < batch_size) {
+            if (!_urgent.empty()) {
+                e = _urgent.front();
+                _urgent.pop_front();
+            } else if (_requests.pop(e)) {
+                if (is_expired(e, now)) {
+                    expired.push_back(e.t);
+                    continue;
+                }
+            } else {
+                break;
+            }
+
+            if (last) {
+                last->next = e.t;
+            } else {
+                head = e.t;
+            }
+            last = e.t;
+            last->next = nullptr;
+            count++;
+        }
+    }
+
+    // drop the expired requests as rpc_request_task::exec() does, without replying
+    for (task *t : expired) {
+        t->spec().on_rpc_task_dropped.execute(static_cast<rpc_request_task *>(t));
+        decrease_count();
+        t->release_ref(); // added in task::enqueue(pool)
+    }
+    if (!expired.empty()) {
+        _shed_task_counter->add(expired.size());
+    }
+
+    batch_size = count;
+    return head;
+}
+
+bool fair_task_queue::is_expired(const entry &e, uint64_t now_ns)
+{
+    // only the tasks which opt in are dropped, as rpc_request_task::exec() does
+    if (!e.t->spec().rpc_request_dropped_before_execution_when_timeout) {
+        return false;
+    }
+
+    auto request = static_cast<rpc_request_task *>(e.t)->get_request();
+    int32_t timeout_ms = request->header->client.timeout_ms;
+    return timeout_ms > 0 &&
+           now_ns - e.enqueue_ts_ns >= static_cast<uint64_t>(timeout_ms) * 1000000ULL;
+}
+} // namespace tools
+} // namespace dsn
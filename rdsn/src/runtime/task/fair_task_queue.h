@@ -0,0 +1,68 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#include <dsn/tool-api/task_queue.h>
+
+#include "weighted_fair_queue.h"
+
+namespace dsn {
+namespace tools {
+
+// A task queue for the unpartitioned pools which serve the reads of many replicas, e.g.
+// THREAD_POOL_LOCAL_APP and THREAD_POOL_SCAN.
+//
+// RPC requests are scheduled by weighted_fair_queue according to the gpid in their header, so
+// that the backlog of one table or replica does not stall the requests of others. The weight of
+// each app is configured by [core] fair_queue_app_weights. Requests of the tasks which set
+// `rpc_request_dropped_before_execution_when_timeout` are dropped before executed if they have
+// waited in the queue longer than their client timeout, as the client has given up on them.
+// Other tasks, and the tasks of TASK_PRIORITY_HIGH, are served first in FIFO order.
+class fair_task_queue : public task_queue
+{
+public:
+    fair_task_queue(task_worker_pool *pool, int index, task_queue *inner_provider);
+
+    void enqueue(task *task) override;
+
+    task *dequeue(/*inout*/ int &batch_size) override;
+
+private:
+    struct entry
+    {
+        task *t;
+        uint64_t enqueue_ts_ns;
+    };
+
+    // Whether the request has been queued for longer than its client timeout, and its task
+    // code allows it to be dropped.
+    static bool is_expired(const entry &e, uint64_t now_ns);
+
+    std::mutex _lock;
+    std::condition_variable _cond;
+    std::deque<entry> _urgent;
+    weighted_fair_queue<entry> _requests;
+
+    perf_counter_wrapper _shed_task_counter;
+};
+} // namespace tools
+} // namespace dsn
@@ -145,6 +145,7 @@ task_spec::task_spec(int code,
       rpc_request_is_write_idempotent(false),
       priority(pri),
       pool_code(pool),
+      allow_steal(false),
       rpc_call_header_format(NET_HDR_DSN),
       rpc_call_channel(RPC_CHANNEL_TCP),
       rpc_message_crc_required(false),
@@ -0,0 +1,121 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <dsn/tool-api/gpid.h>
+
+namespace dsn {
+
+// A two level deficit round robin queue: apps are served in turn, each app gets `weight` items
+// per round (1 by default), and the replicas of an app are served in turn within the app's
+// share. So a replica with a long backlog delays only the other replicas of its own app by one
+// item per round, and never delays other apps by more than its app's weight.
+//
+// Not thread safe.
+template <typename T>
+class weighted_fair_queue
+{
+public:
+    void set_app_weight(int32_t app_id, int weight)
+    {
+        _weights[app_id] = std::max(weight, 1);
+        auto iter = _apps.find(app_id);
+        if (iter != _apps.end()) {
+            iter->second.weight = _weights[app_id];
+        }
+    }
+
+    void push(gpid pid, T item)
+    {
+        auto iter = _apps.find(pid.get_app_id());
+        if (iter == _apps.end()) {
+            auto weight = _weights.find(pid.get_app_id());
+            iter = _apps.emplace(pid.get_app_id(), app_flow()).first;
+            iter->second.weight = weight == _weights.end() ? 1 : weight->second;
+        }
+
+        app_flow &app = iter->second;
+        std::deque<T> &items = app.partitions[pid.get_partition_index()];
+        if (items.empty()) {
+            if (app.active_partitions.empty()) {
+                _active_apps.push_back(pid.get_app_id());
+            }
+            app.active_partitions.push_back(pid.get_partition_index());
+        }
+        items.push_back(std::move(item));
+        _size++;
+    }
+
+    // Pops the next item in the round robin order, returns false if the queue is empty.
+    bool pop(/*out*/ T &item)
+    {
+        if (_active_apps.empty()) {
+            return false;
+        }
+
+        app_flow &app = _apps[_active_apps.front()];
+        if (app.deficit <= 0) {
+            // a new turn of the app
+            app.deficit += app.weight;
+        }
+
+        int32_t pidx = app.active_partitions.front();
+        app.active_partitions.pop_front();
+        std::deque<T> &items = app.partitions[pidx];
+        item = std::move(items.front());
+        items.pop_front();
+        if (!items.empty()) {
+            app.active_partitions.push_back(pidx);
+        }
+        _size--;
+
+        app.deficit--;
+        if (app.active_partitions.empty()) {
+            // an idle app does not save its share for later
+            app.deficit = 0;
+            _active_apps.pop_front();
+        } else if (app.deficit <= 0) {
+            _active_apps.push_back(_active_apps.front());
+            _active_apps.pop_front();
+        }
+        return true;
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+private:
+    struct app_flow
+    {
+        int weight = 1;
+        int deficit = 0;
+        std::unordered_map<int32_t, std::deque<T>> partitions;
+        // partitions which have items, in the order to be served
+        std::deque<int32_t> active_partitions;
+    };
+
+    std::unordered_map<int32_t, int> _weights;
+    std::unordered_map<int32_t, app_flow> _apps;
+    // apps which have items, in the order to be served
+    std::deque<int32_t> _active_apps;
+    size_t _size = 0;
+};
+} // namespace dsn
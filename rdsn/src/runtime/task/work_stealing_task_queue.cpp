@@ -0,0 +1,174 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "work_stealing_task_queue.h"
+
+#include <dsn/c/api_layer1.h>
+#include <dsn/utility/flags.h>
+
+#include "task_engine.h"
+
+namespace dsn {
+namespace tools {
+
+DSN_DEFINE_uint32("core",
+                  work_stealing_idle_wait_us,
+                  10000,
+                  "how long (us) an idle worker of work_stealing_task_queue waits for its own "
+                  "tasks before it looks for tasks to steal again");
+
+work_stealing_task_queue::work_stealing_task_queue(task_worker_pool *pool,
+                                                   int index,
+                                                   task_queue *inner_provider)
+    : task_queue(pool, index, inner_provider), _stealable_count(0), _idle(false)
+{
+    _steal_task_counter.init_global_counter(pool->node()->full_name(),
+                                            "engine",
+                                            (get_name() + ".queue.steal_task").c_str(),
+                                            COUNTER_TYPE_VOLATILE_NUMBER,
+                                            "count of tasks stolen from the sibling queues");
+    _wait_time_counter.init_global_counter(pool->node()->full_name(),
+                                           "engine",
+                                           (get_name() + ".queue.wait_time_ns").c_str(),
+                                           COUNTER_TYPE_NUMBER_PERCENTILES,
+                                           "time (ns) tasks wait in the queue before executed");
+}
+
+void work_stealing_task_queue::enqueue(task *task)
+{
+    entry e{task, dsn_now_ns()};
+    auto pri = task->spec().priority;
+    if (task->spec().allow_steal) {
+        _stealable[pri].enqueue(e);
+        // tasks pile up when the worker is busy, let an idle sibling help
+        if (_stealable_count.fetch_add(1, std::memory_order_relaxed) > 0) {
+            wake_up_idle_sibling();
+        }
+    } else {
+        _pinned[pri].enqueue(e);
+    }
+    _sema.signal(1);
+}
+
+task *work_stealing_task_queue::dequeue(int &batch_size)
+{
+    std::call_once(_siblings_init_flag, [this]() { init_siblings(); });
+
+    // the semaphore is only a hint of the queue length, as the stealable tasks may be taken by
+    // the siblings, and the stolen tasks are not counted
+    int count = batch_size;
+    _idle.store(true, std::memory_order_relaxed);
+    _sema.waitMany(count, _siblings.empty() ? -1 : FLAGS_work_stealing_idle_wait_us);
+    _idle.store(false, std::memory_order_relaxed);
+
+    task *head = nullptr, *last = nullptr;
+    int n = take(_pinned, count, head, last);
+    if (n < count) {
+        int m = take(_stealable, count - n, head, last);
+        _stealable_count.fetch_sub(m, std::memory_order_relaxed);
+        n += m;
+    }
+    if (n == 0) {
+        n = steal(count, head, last);
+    }
+
+    batch_size = n;
+    return head;
+}
+
+int work_stealing_task_queue::take(queue_t *queues, int count, task *&head, task *&last)
+{
+    uint64_t now = dsn_now_ns();
+    int n = 0;
+    entry entries[16];
+    for (int pri = TASK_PRIORITY_COUNT - 1; pri >= 0 && n < count; --pri) {
+        size_t got;
+        while (n < count &&
+               (got = queues[pri].try_dequeue_bulk(
+                    entries, std::min<size_t>(count - n, sizeof(entries) / sizeof(entry)))) > 0) {
+            for (size_t i = 0; i < got; ++i) {
+                task *t = entries[i].t;
+                if (last) {
+                    last->next = t;
+                } else {
+                    head = t;
+                }
+                last = t;
+                last->next = nullptr;
+                _wait_time_counter->set(now - entries[i].enqueue_ts_ns);
+            }
+            n += static_cast<int>(got);
+        }
+    }
+    return n;
+}
+
+int work_stealing_task_queue::steal(int count, task *&head, task *&last)
+{
+    size_t size = _siblings.size();
+    if (size == 0) {
+        return 0;
+    }
+
+    // start from a different sibling each time to spread the stealing
+    size_t start = static_cast<size_t>(dsn_now_ns()) % size;
+    for (size_t i = 0; i < size; ++i) {
+        work_stealing_task_queue *victim = _siblings[(start + i) % size];
+        if (victim->_stealable_count.load(std::memory_order_relaxed) <= 0) {
+            continue;
+        }
+
+        // leave the victim some tasks if it has many, it is working on them too
+        int want = std::max(1, std::min(count, victim->_stealable_count.load() / 2));
+        int n = victim->take(victim->_stealable, want, head, last);
+        if (n > 0) {
+            victim->_stealable_count.fetch_sub(n, std::memory_order_relaxed);
+            // the tasks are counted in the victim's queue length, move them to ours, which is
+            // decreased by the worker after dequeue
+            victim->decrease_count(n);
+            increase_count(n);
+            _steal_task_counter->add(n);
+            return n;
+        }
+    }
+    return 0;
+}
+
+void work_stealing_task_queue::wake_up_idle_sibling()
+{
+    std::call_once(_siblings_init_flag, [this]() { init_siblings(); });
+    for (auto *sibling : _siblings) {
+        if (sibling->_idle.load(std::memory_order_relaxed)) {
+            sibling->_sema.signal(1);
+            return;
+        }
+    }
+}
+
+void work_stealing_task_queue::init_siblings()
+{
+    // all the queues of the pool are created before any worker starts, see
+    // task_worker_pool::create()
+    for (auto *q : pool()->queues()) {
+        auto *sibling = dynamic_cast<work_stealing_task_queue *>(q);
+        if (sibling != nullptr && sibling != this) {
+            _siblings.push_back(sibling);
+        }
+    }
+}
+} // namespace tools
+} // namespace dsn
@@ -0,0 +1,80 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <concurrentqueue/concurrentqueue.h>
+#include <concurrentqueue/blockingconcurrentqueue.h>
+
+#include <dsn/tool-api/task_queue.h>
+
+namespace dsn {
+namespace tools {
+
+// A task queue for partitioned thread pools, with which an idle worker can steal tasks from the
+// queues of its busy siblings.
+//
+// Only the tasks whose spec sets `allow_steal` can be stolen. All the other tasks, e.g. the ones
+// which must be executed in order on the thread of their replica, stay in the queue selected by
+// their hash. An idle worker looks for stealable tasks when its own queue is empty, and is woken
+// up when stealable tasks pile up in a sibling queue.
+class work_stealing_task_queue : public task_queue
+{
+public:
+    work_stealing_task_queue(task_worker_pool *pool, int index, task_queue *inner_provider);
+
+    void enqueue(task *task) override;
+
+    task *dequeue(/*inout*/ int &batch_size) override;
+
+private:
+    struct entry
+    {
+        task *t;
+        uint64_t enqueue_ts_ns;
+    };
+    typedef moodycamel::ConcurrentQueue<entry> queue_t;
+
+    // Dequeues at most `count` tasks from `queues`, from the highest priority to the lowest, and
+    // appends them to the list [head, last]. Returns the number of dequeued tasks.
+    int take(queue_t *queues, int count, task *&head, task *&last);
+    // Steals at most `count` tasks from the sibling queues.
+    int steal(int count, task *&head, task *&last);
+    // Wakes up a sibling which is waiting for tasks to steal one of ours.
+    void wake_up_idle_sibling();
+    void init_siblings();
+
+    moodycamel::LightweightSemaphore _sema;
+    // tasks which can only be executed by the worker(s) of this queue
+    queue_t _pinned[TASK_PRIORITY_COUNT];
+    // tasks which can be stolen by the workers of the sibling queues
+    queue_t _stealable[TASK_PRIORITY_COUNT];
+    std::atomic<int> _stealable_count;
+    // whether the worker is waiting for tasks
+    std::atomic<bool> _idle;
+
+    std::once_flag _siblings_init_flag;
+    std::vector<work_stealing_task_queue *> _siblings;
+
+    perf_counter_wrapper _steal_task_counter;
+    perf_counter_wrapper _wait_time_counter;
+};
+} // namespace tools
+} // namespace dsn
@@ -222,3 +222,38 @@ TEST(rpc_message, copy_message_no_reply)
     // so we only need to call release_ref here.
     msg->release_ref();
 }
+
+TEST(rpc_message, write_append)
+{
+    blob large = blob::create_from_bytes(std::string(binary_writer::nocopy_min_bytes, 'x'));
+
+    message_ex *request = message_ex::create_request(RPC_CODE_FOR_TEST, 100, 1);
+    {
+        rpc_write_stream writer(request);
+        writer.write(int32_t(1));
+        writer.write_nocopy(large);
+        writer.write(int32_t(2));
+    }
+    ASSERT_EQ(sizeof(int32_t) * 2 + large.length(), request->body_size());
+    // the large blob is linked into the message rather than copied
+    ASSERT_EQ(4u, request->buffers.size());
+    ASSERT_EQ(large.data(), request->buffers[2].data());
+
+    message_ex *receive = request->copy(true, true);
+    {
+        rpc_read_stream reader(receive);
+        int32_t value = 0;
+        reader.read(value);
+        ASSERT_EQ(1, value);
+        blob content;
+        reader.read(content, large.length());
+        ASSERT_EQ(large.to_string(), content.to_string());
+        reader.read(value);
+        ASSERT_EQ(2, value);
+    }
+
+    receive->add_ref();
+    receive->release_ref();
+    request->add_ref();
+    request->release_ref();
+}
@@ -0,0 +1,214 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/rpc/network.sim.h"
+
+#include <gtest/gtest.h>
+#include <dsn/tool-api/rpc_message.h>
+#include <dsn/utility/flags.h>
+
+namespace dsn {
+DSN_DECLARE_uint32(send_coalesce_threshold_bytes);
+DSN_DECLARE_uint32(send_coalesce_buffer_size);
+
+class rpc_session_test : public testing::Test
+{
+public:
+    rpc_session_test()
+        : _old_threshold_bytes(FLAGS_send_coalesce_threshold_bytes),
+          _old_buffer_size(FLAGS_send_coalesce_buffer_size),
+          _sim_net(new tools::sim_network_provider(nullptr, nullptr))
+    {
+        _session =
+            _sim_net->create_server_session(rpc_address("localhost", 10086), rpc_session_ptr());
+    }
+
+    ~rpc_session_test()
+    {
+        // release the messages left in the session
+        while (next_batch()) {
+        }
+        FLAGS_send_coalesce_threshold_bytes = _old_threshold_bytes;
+        FLAGS_send_coalesce_buffer_size = _old_buffer_size;
+    }
+
+    // Queues a message whose buffers are a header and `bodies`, returns the data of the buffers.
+    std::vector<std::string> add_message(const std::vector<std::string> &bodies)
+    {
+        auto msg = message_ex::create_receive_message_with_standalone_header(
+            blob::create_from_bytes(std::string(bodies[0])));
+        for (size_t i = 1; i < bodies.size(); ++i) {
+            msg->buffers.emplace_back(blob::create_from_bytes(std::string(bodies[i])));
+        }
+        msg->add_ref(); // released in next_batch()
+        msg->dl.insert_before(&_session->_messages);
+        ++_session->_message_count;
+
+        std::vector<std::string> data;
+        for (const auto &buf : msg->buffers) {
+            data.emplace_back(buf.to_string());
+        }
+        return data;
+    }
+
+    // Finishes the current batch, and unlinks the next one from the queued messages.
+    bool next_batch()
+    {
+        for (message_ex *msg : _session->_sending_msgs) {
+            msg->release_ref();
+        }
+        _session->_sending_msgs.clear();
+        _session->_sending_buffers.clear();
+        return _session->unlink_message_for_send();
+    }
+
+    void set_sending_buffers(const std::vector<std::string> &data)
+    {
+        _session->_sending_buffers.clear();
+        for (const auto &d : data) {
+            message_parser::send_buf buf;
+            buf.buf = const_cast<char *>(d.data());
+            buf.sz = d.size();
+            _session->_sending_buffers.push_back(buf);
+        }
+    }
+
+    std::vector<std::string> sending_buffers() const
+    {
+        std::vector<std::string> result;
+        for (const auto &buf : _session->_sending_buffers) {
+            result.emplace_back(static_cast<const char *>(buf.buf), buf.sz);
+        }
+        return result;
+    }
+
+    bool is_coalesced(int index) const
+    {
+        const char *base = _session->_coalesce_buffer.get();
+        const char *buf = static_cast<const char *>(_session->_sending_buffers[index].buf);
+        return base != nullptr && buf >= base && buf < base + FLAGS_send_coalesce_buffer_size;
+    }
+
+    const uint32_t _old_threshold_bytes;
+    const uint32_t _old_buffer_size;
+    std::unique_ptr<tools::sim_network_provider> _sim_net;
+    rpc_session_ptr _session;
+};
+
+TEST_F(rpc_session_test, coalesce_send_buffers)
+{
+    FLAGS_send_coalesce_threshold_bytes = 4;
+    FLAGS_send_coalesce_buffer_size = 16;
+
+    // the small buffers are copied together, the large ones are sent as they are
+    std::vector<std::string> data = {"a", "bb", "large", "ccc", "dddd"};
+    set_sending_buffers(data);
+    ASSERT_EQ(3, _session->coalesce_send_buffers(0, 5));
+    _session->_sending_buffers.resize(3);
+    ASSERT_EQ(std::vector<std::string>({"abb", "large", "cccdddd"}), sending_buffers());
+    ASSERT_TRUE(is_coalesced(0));
+    ASSERT_EQ(data[2].data(), _session->_sending_buffers[1].buf);
+    ASSERT_TRUE(is_coalesced(2));
+    ASSERT_EQ(10, _session->_coalesce_buffer_used);
+
+    // the buffers of the next message extend the last block of the previous one if they are
+    // adjacent in the coalesce buffer, until the coalesce buffer is full
+    std::vector<std::string> data2 = {"ee", "ffff", "g", "h"};
+    for (const auto &d : data2) {
+        message_parser::send_buf buf;
+        buf.buf = const_cast<char *>(d.data());
+        buf.sz = d.size();
+        _session->_sending_buffers.push_back(buf);
+    }
+    ASSERT_EQ(2, _session->coalesce_send_buffers(3, 4));
+    _session->_sending_buffers.resize(5);
+    ASSERT_EQ(std::vector<std::string>({"abb", "large", "cccddddeeffff", "g", "h"}),
+              sending_buffers());
+    ASSERT_EQ(16, _session->_coalesce_buffer_used);
+    ASSERT_EQ(data2[2].data(), _session->_sending_buffers[3].buf);
+    ASSERT_EQ(data2[3].data(), _session->_sending_buffers[4].buf);
+    _session->_sending_buffers.clear();
+}
+
+TEST_F(rpc_session_test, unlink_message_for_send_without_coalescing)
+{
+    FLAGS_send_coalesce_threshold_bytes = 0;
+    _session->_max_buffer_block_count_per_send = 4;
+
+    // 2 + 2 blocks
+    add_message({"a"});
+    add_message({"b"});
+    // 3 blocks, which would exceed the limit in the middle of the message
+    auto msg3 = add_message({"c", "d"});
+    // 5 blocks, which exceeds the limit alone
+    add_message({"e", "f", "g", "h"});
+
+    ASSERT_TRUE(next_batch());
+    ASSERT_EQ(2, _session->_sending_msgs.size());
+    ASSERT_EQ(4, _session->_sending_buffers.size());
+    ASSERT_EQ(2, _session->_message_count);
+
+    // the message is not split, it's sent in the next batch as a whole
+    ASSERT_TRUE(next_batch());
+    ASSERT_EQ(1, _session->_sending_msgs.size());
+    ASSERT_EQ(msg3, sending_buffers());
+
+    // a message exceeding the limit alone is still sent
+    ASSERT_TRUE(next_batch());
+    ASSERT_EQ(1, _session->_sending_msgs.size());
+    ASSERT_EQ(5, _session->_sending_buffers.size());
+    ASSERT_EQ(0, _session->_message_count);
+
+    ASSERT_FALSE(next_batch());
+}
+
+TEST_F(rpc_session_test, unlink_message_for_send_with_coalescing)
+{
+    const size_t header_size = sizeof(message_header);
+    FLAGS_send_coalesce_threshold_bytes = static_cast<uint32_t>(header_size);
+    FLAGS_send_coalesce_buffer_size = static_cast<uint32_t>(header_size * 3 + 3);
+    _session->_max_buffer_block_count_per_send = 4;
+
+    auto msg1 = add_message({"a"});
+    auto msg2 = add_message({"b"});
+    // the coalesce buffer is full in the middle of this message
+    auto msg3 = add_message({"c", "d"});
+    auto msg4 = add_message({"e"});
+    auto msg5 = add_message({"f"});
+
+    // the blocks saved by coalescing let 4 messages of 9 blocks into the batch, the limit is
+    // still checked by the block count of each message before coalescing
+    ASSERT_TRUE(next_batch());
+    ASSERT_EQ(4, _session->_sending_msgs.size());
+    ASSERT_EQ(std::vector<std::string>(
+                  {msg1[0] + msg1[1] + msg2[0] + msg2[1] + msg3[0] + msg3[1], "d", msg4[0], "e"}),
+              sending_buffers());
+    ASSERT_TRUE(is_coalesced(0));
+    ASSERT_FALSE(is_coalesced(1));
+    ASSERT_FALSE(is_coalesced(2));
+    ASSERT_FALSE(is_coalesced(3));
+
+    // a single message is sent without copy
+    ASSERT_TRUE(next_batch());
+    ASSERT_EQ(1, _session->_sending_msgs.size());
+    ASSERT_EQ(msg5, sending_buffers());
+    ASSERT_FALSE(is_coalesced(0));
+    ASSERT_FALSE(is_coalesced(1));
+
+    ASSERT_FALSE(next_batch());
+}
+} // namespace dsn
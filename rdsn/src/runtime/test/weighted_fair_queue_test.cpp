@@ -0,0 +1,86 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <gtest/gtest.h>
+
+#include "runtime/task/weighted_fair_queue.h"
+
+namespace dsn {
+
+TEST(weighted_fair_queue, round_robin_between_apps)
+{
+    weighted_fair_queue<int> q;
+    // app 1 has a long backlog on one replica, app 2 has a few requests
+    for (int i = 0; i < 100; ++i) {
+        q.push(gpid(1, 0), 100 + i);
+    }
+    q.push(gpid(2, 0), 200);
+    q.push(gpid(2, 1), 201);
+    ASSERT_EQ(102, q.size());
+
+    std::vector<int> items;
+    int item;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(q.pop(item));
+        items.push_back(item);
+    }
+    ASSERT_EQ(std::vector<int>({100, 200, 101, 201}), items);
+
+    // only app 1 is left
+    for (int i = 2; i < 100; ++i) {
+        ASSERT_TRUE(q.pop(item));
+        ASSERT_EQ(100 + i, item);
+    }
+    ASSERT_FALSE(q.pop(item));
+    ASSERT_TRUE(q.empty());
+}
+
+TEST(weighted_fair_queue, round_robin_between_replicas)
+{
+    weighted_fair_queue<int> q;
+    for (int i = 0; i < 3; ++i) {
+        q.push(gpid(1, 0), i);
+    }
+    q.push(gpid(1, 1), 10);
+    q.push(gpid(1, 2), 20);
+
+    std::vector<int> items;
+    int item;
+    while (q.pop(item)) {
+        items.push_back(item);
+    }
+    ASSERT_EQ(std::vector<int>({0, 10, 20, 1, 2}), items);
+}
+
+TEST(weighted_fair_queue, app_weight)
+{
+    weighted_fair_queue<int> q;
+    q.set_app_weight(1, 3);
+    for (int i = 0; i < 6; ++i) {
+        q.push(gpid(1, 0), 100 + i);
+        q.push(gpid(2, 0), 200 + i);
+    }
+
+    std::vector<int> items;
+    int item;
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(q.pop(item));
+        items.push_back(item);
+    }
+    ASSERT_EQ(std::vector<int>({100, 101, 102, 200, 103, 104, 105, 201}), items);
+}
+} // namespace dsn
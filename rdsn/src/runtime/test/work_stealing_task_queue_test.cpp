@@ -0,0 +1,80 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <dsn/service_api_cpp.h>
+#include <dsn/utility/synchronize.h>
+
+#include "runtime/service_engine.h"
+#include "runtime/task/task_engine.h"
+#include "test_utils.h"
+
+DEFINE_THREAD_POOL_CODE(THREAD_POOL_FOR_TEST_STEAL)
+DEFINE_TASK_CODE(LPC_TEST_PINNED, TASK_PRIORITY_COMMON, THREAD_POOL_FOR_TEST_STEAL)
+DEFINE_TASK_CODE(LPC_TEST_STEALABLE, TASK_PRIORITY_COMMON, THREAD_POOL_FOR_TEST_STEAL)
+
+TEST(core, work_stealing_task_queue)
+{
+    if (dsn::service_engine::instance().spec().tool == "simulator")
+        return;
+
+    dsn::task_worker_pool *pool =
+        dsn::task::get_current_node2()->computation()->get_pool(THREAD_POOL_FOR_TEST_STEAL);
+    ASSERT_NE(nullptr, pool);
+    ASSERT_EQ("dsn::tools::work_stealing_task_queue", pool->spec().queue_factory_name);
+    ASSERT_EQ(2u, pool->queues().size());
+    dsn::task_spec::get(LPC_TEST_STEALABLE.code())->allow_steal = true;
+
+    // block the worker of queue 0
+    dsn::utils::notify_event blocker_started, release_blocker;
+    dsn::tasking::enqueue(LPC_TEST_PINNED,
+                          nullptr,
+                          [&]() {
+                              blocker_started.notify();
+                              release_blocker.wait();
+                          },
+                          0);
+    blocker_started.wait();
+
+    // the pinned task waits for the blocker, while the stealable ones are executed by worker 1
+    std::atomic<bool> pinned_executed(false);
+    dsn::tasking::enqueue(LPC_TEST_PINNED, nullptr, [&]() { pinned_executed = true; }, 0);
+
+    const int kStealableCount = 10;
+    std::atomic<int> stolen_count(0);
+    dsn::utils::notify_event all_stolen;
+    for (int i = 0; i < kStealableCount; ++i) {
+        dsn::tasking::enqueue(LPC_TEST_STEALABLE,
+                              nullptr,
+                              [&]() {
+                                  if (dsn::task::get_current_worker_index() == 1 &&
+                                      ++stolen_count == kStealableCount) {
+                                      all_stolen.notify();
+                                  }
+                              },
+                              0);
+    }
+    ASSERT_TRUE(all_stolen.wait_for(10000));
+    ASSERT_FALSE(pinned_executed);
+
+    release_blocker.notify();
+    for (int i = 0; i < 100 && !pinned_executed; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    ASSERT_TRUE(pinned_executed);
+}
@@ -0,0 +1,411 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "async_logger.h"
+
+#include <chrono>
+#include <cstring>
+#include <iterator>
+
+#include <dsn/utility/flags.h>
+#include <dsn/utility/process_utils.h>
+#include <dsn/utils/time_utils.h>
+#include <fmt/format.h>
+
+namespace dsn {
+namespace tools {
+
+DSN_DEFINE_uint32("tools.async_logger",
+                  buffer_kb_per_thread,
+                  256,
+                  "the size of the ring buffer of each logging thread, in KB");
+DSN_DEFINE_uint32("tools.async_logger",
+                  max_buffer_kb,
+                  64 * 1024,
+                  "the max total size of the ring buffers, in KB");
+DSN_DEFINE_uint32("tools.async_logger",
+                  flush_interval_ms,
+                  10,
+                  "the interval for the writer thread to check for new messages when idle");
+
+// shared with simple_logger
+DSN_DECLARE_bool(short_header);
+DSN_DECLARE_string(stderr_start_level);
+
+// A single-producer/single-consumer ring buffer of log messages.
+class async_logger::ring_buffer
+{
+public:
+    explicit ring_buffer(size_t capacity)
+        : _capacity(capacity), _data(new char[capacity]), _head(0), _tail(0)
+    {
+    }
+
+    // Returns false if there's no room for `message`.
+    // Only one thread is allowed to push at the same time.
+    bool push(dsn_log_level_t log_level, const std::string &message)
+    {
+        record_header header;
+        header.level = log_level;
+        header.size = static_cast<uint32_t>(message.size());
+
+        uint64_t size = sizeof(header) + message.size();
+        uint64_t tail = _tail.load(std::memory_order_relaxed);
+        if (size > _capacity - (tail - _head.load(std::memory_order_acquire))) {
+            return false;
+        }
+
+        copy_in(tail, &header, sizeof(header));
+        copy_in(tail + sizeof(header), message.data(), message.size());
+        _tail.store(tail + size, std::memory_order_release);
+        return true;
+    }
+
+    // Calls `f(log_level, data, size)` for each message in the buffer and removes them,
+    // returns the number of the messages. Only called by the writer thread.
+    template <typename F>
+    size_t pop_all(F &&f)
+    {
+        uint64_t head = _head.load(std::memory_order_relaxed);
+        uint64_t tail = _tail.load(std::memory_order_acquire);
+        size_t count = 0;
+        while (head < tail) {
+            record_header header;
+            copy_out(head, sizeof(header), (char *)&header);
+            head += sizeof(header);
+
+            size_t pos = head % _capacity;
+            if (pos + header.size <= _capacity) {
+                f(header.level, _data.get() + pos, header.size);
+            } else {
+                _scratch.resize(header.size);
+                copy_out(head, header.size, &_scratch[0]);
+                f(header.level, _scratch.data(), header.size);
+            }
+            head += header.size;
+            ++count;
+        }
+        _head.store(head, std::memory_order_release);
+        return count;
+    }
+
+private:
+    struct record_header
+    {
+        dsn_log_level_t level;
+        uint32_t size;
+    };
+
+    void copy_in(uint64_t offset, const void *src, size_t size)
+    {
+        size_t pos = offset % _capacity;
+        size_t first = std::min(size, _capacity - pos);
+        memcpy(_data.get() + pos, src, first);
+        memcpy(_data.get(), (const char *)src + first, size - first);
+    }
+
+    void copy_out(uint64_t offset, size_t size, char *dst) const
+    {
+        size_t pos = offset % _capacity;
+        size_t first = std::min(size, _capacity - pos);
+        memcpy(dst, _data.get() + pos, first);
+        memcpy(dst + first, _data.get(), size - first);
+    }
+
+    const size_t _capacity;
+    std::unique_ptr<char[]> _data;
+    // the offsets are increased monotonically
+    std::atomic<uint64_t> _head;
+    std::atomic<uint64_t> _tail;
+    std::string _scratch;
+};
+
+static std::atomic<uint64_t> s_next_logger_id(1);
+
+static void format_header(std::string &str, dsn_log_level_t log_level)
+{
+    static char s_level_char[] = "IDWEF";
+
+    uint64_t ts = dsn_now_ns();
+    std::string time_str;
+    dsn::utils::time_ms_to_string(ts / 1000000, time_str);
+
+    int tid = dsn::utils::get_current_tid();
+    fmt::format_to(std::back_inserter(str),
+                   "{}{} ({} {}) {}",
+                   s_level_char[log_level],
+                   time_str,
+                   ts,
+                   tid,
+                   log_prefixed_message_func());
+}
+
+static void append_vformat(std::string &str, const char *fmt, va_list args)
+{
+    static const size_t kInitialSize = 256;
+
+    va_list args2;
+    va_copy(args2, args);
+    size_t old_size = str.size();
+    str.resize(old_size + kInitialSize);
+    int n = vsnprintf(&str[old_size], kInitialSize, fmt, args);
+    if (n < 0) {
+        n = 0;
+    } else if (static_cast<size_t>(n) >= kInitialSize) {
+        str.resize(old_size + n + 1);
+        vsnprintf(&str[old_size], n + 1, fmt, args2);
+    }
+    str.resize(old_size + n);
+    va_end(args2);
+}
+
+async_logger::async_logger(const char *log_dir)
+    : logging_provider(log_dir),
+      _id(s_next_logger_id.fetch_add(1)),
+      _stderr_start_level(enum_from_string(FLAGS_stderr_start_level, LOG_LEVEL_INVALID)),
+      _roller(log_dir),
+      _log(nullptr),
+      _lines(0),
+      _shared_ring_buffer(new ring_buffer(FLAGS_buffer_kb_per_thread * 1024)),
+      _dropped_count(0),
+      _reported_dropped_count(0),
+      _flush_requested(0),
+      _flushed(0),
+      _wake_requested(false),
+      _stopping(false)
+{
+    _log = _roller.roll(nullptr);
+    _writer = std::thread([this]() { write_loop(); });
+}
+
+async_logger::~async_logger()
+{
+    {
+        std::lock_guard<std::mutex> l(_writer_lock);
+        _stopping = true;
+    }
+    _writer_cv.notify_one();
+    _writer.join();
+    ::fclose(_log);
+}
+
+void async_logger::dsn_logv(const char *file,
+                            const char *function,
+                            const int line,
+                            dsn_log_level_t log_level,
+                            const char *fmt,
+                            va_list args)
+{
+    // reuse the memory of the message for each thread
+    thread_local std::string message;
+    message.clear();
+
+    format_header(message, log_level);
+    if (!FLAGS_short_header) {
+        fmt::format_to(std::back_inserter(message), "{}:{}:{}(): ", file, line, function);
+    }
+    append_vformat(message, fmt, args);
+    message.push_back('\n');
+
+    append(log_level, message);
+}
+
+void async_logger::dsn_log(const char *file,
+                           const char *function,
+                           const int line,
+                           dsn_log_level_t log_level,
+                           const char *str)
+{
+    thread_local std::string message;
+    message.clear();
+
+    format_header(message, log_level);
+    if (!FLAGS_short_header) {
+        fmt::format_to(std::back_inserter(message), "{}:{}:{}(): ", file, line, function);
+    }
+    message.append(str);
+    message.push_back('\n');
+
+    append(log_level, message);
+}
+
+void async_logger::flush()
+{
+    std::unique_lock<std::mutex> l(_writer_lock);
+    uint64_t seq = ++_flush_requested;
+    _writer_cv.notify_one();
+    // don't wait forever in case the writer thread is stuck, e.g. when the process is coring
+    _flushed_cv.wait_for(l, std::chrono::seconds(1), [this, seq]() { return _flushed >= seq; });
+}
+
+async_logger::ring_buffer *async_logger::get_ring_buffer()
+{
+    struct thread_ring_buffer
+    {
+        uint64_t logger_id;
+        ring_buffer *rb;
+    };
+    thread_local thread_ring_buffer t_ring_buffer{0, nullptr};
+    if (dsn_likely(t_ring_buffer.logger_id == _id)) {
+        return t_ring_buffer.rb;
+    }
+
+    std::lock_guard<std::mutex> l(_ring_buffers_lock);
+    int tid = utils::get_current_tid();
+    ring_buffer *rb = nullptr;
+    auto iter = _ring_buffer_of_thread.find(tid);
+    if (iter != _ring_buffer_of_thread.end()) {
+        // the thread id is reused after the previous thread exited
+        rb = iter->second;
+    } else {
+        if ((_ring_buffers.size() + 1) * FLAGS_buffer_kb_per_thread <= FLAGS_max_buffer_kb) {
+            _ring_buffers.emplace_back(new ring_buffer(FLAGS_buffer_kb_per_thread * 1024));
+            rb = _ring_buffers.back().get();
+        }
+        _ring_buffer_of_thread.emplace(tid, rb);
+    }
+
+    t_ring_buffer.logger_id = _id;
+    t_ring_buffer.rb = rb;
+    return rb;
+}
+
+void async_logger::append(dsn_log_level_t log_level, const std::string &message)
+{
+    bool pushed;
+    ring_buffer *rb = get_ring_buffer();
+    if (rb != nullptr) {
+        pushed = rb->push(log_level, message);
+    } else {
+        utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_shared_ring_buffer_lock);
+        pushed = _shared_ring_buffer->push(log_level, message);
+    }
+    if (dsn_unlikely(!pushed)) {
+        _dropped_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (log_level >= LOG_LEVEL_FATAL) {
+        flush();
+    } else if (log_level >= LOG_LEVEL_ERROR) {
+        // wake the writer without waiting for the message to be written. only the thread that
+        // sets the flag notifies, so a burst of errors doesn't contend on the writer lock.
+        if (!_wake_requested.exchange(true, std::memory_order_acq_rel)) {
+            // the writer checks the flag under the lock, taking the lock before notifying makes
+            // sure the notification is not lost between its check and its wait
+            {
+                std::lock_guard<std::mutex> l(_writer_lock);
+            }
+            _writer_cv.notify_one();
+        }
+    }
+}
+
+void async_logger::write_loop()
+{
+    while (true) {
+        uint64_t flush_requested;
+        bool stopping;
+        {
+            std::lock_guard<std::mutex> l(_writer_lock);
+            flush_requested = _flush_requested;
+            stopping = _stopping;
+            _wake_requested.store(false, std::memory_order_release);
+        }
+
+        size_t count = drain();
+
+        // the messages pushed before the flush requests have been written
+        {
+            std::lock_guard<std::mutex> l(_writer_lock);
+            if (_flushed < flush_requested) {
+                _flushed = flush_requested;
+                _flushed_cv.notify_all();
+            }
+        }
+
+        if (stopping) {
+            return;
+        }
+
+        if (count == 0) {
+            std::unique_lock<std::mutex> l(_writer_lock);
+            _writer_cv.wait_for(l, std::chrono::milliseconds(FLAGS_flush_interval_ms), [this]() {
+                return _stopping || _wake_requested.load(std::memory_order_acquire) ||
+                       _flushed < _flush_requested;
+            });
+        }
+    }
+}
+
+size_t async_logger::drain()
+{
+    std::vector<ring_buffer *> ring_buffers;
+    {
+        std::lock_guard<std::mutex> l(_ring_buffers_lock);
+        ring_buffers.reserve(_ring_buffers.size() + 1);
+        for (const auto &rb : _ring_buffers) {
+            ring_buffers.push_back(rb.get());
+        }
+    }
+    ring_buffers.push_back(_shared_ring_buffer.get());
+
+    size_t count = 0;
+    for (ring_buffer *rb : ring_buffers) {
+        count += rb->pop_all([this](dsn_log_level_t log_level, const char *data, size_t size) {
+            _buffer.append(data, size);
+            if (log_level >= _stderr_start_level) {
+                _stderr_buffer.append(data, size);
+            }
+            if (++_lines >= MAX_LINES_PER_LOG_FILE) {
+                write_buffers();
+                _log = _roller.roll(_log);
+                _lines = 0;
+            }
+        });
+    }
+
+    uint64_t dropped_count = _dropped_count.load(std::memory_order_relaxed);
+    if (dsn_unlikely(dropped_count != _reported_dropped_count)) {
+        format_header(_buffer, LOG_LEVEL_WARNING);
+        fmt::format_to(std::back_inserter(_buffer),
+                       "async_logger dropped {} log messages since last report\n",
+                       dropped_count - _reported_dropped_count);
+        _reported_dropped_count = dropped_count;
+        ++_lines;
+    }
+
+    write_buffers();
+    return count;
+}
+
+void async_logger::write_buffers()
+{
+    if (!_buffer.empty()) {
+        ::fwrite(_buffer.data(), 1, _buffer.size(), _log);
+        ::fflush(_log);
+        _buffer.clear();
+    }
+    if (!_stderr_buffer.empty()) {
+        ::fwrite(_stderr_buffer.data(), 1, _stderr_buffer.size(), stdout);
+        ::fflush(stdout);
+        _stderr_buffer.clear();
+    }
+}
+
+} // namespace tools
+} // namespace dsn
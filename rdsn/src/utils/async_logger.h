@@ -0,0 +1,121 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <dsn/tool_api.h>
+#include <dsn/utility/synchronize.h>
+
+#include "simple_logger.h"
+
+namespace dsn {
+namespace tools {
+
+/*
+ * async_logger writes logs to files like simple_logger, but the calling threads only format
+ * the messages and push them into their own lock-free ring buffers. A background thread
+ * drains the ring buffers in batches, writes them to the log files and rolls the files.
+ *
+ * - Messages from different threads may be written slightly out of their time order.
+ * - A message is dropped if the ring buffer of its thread is full, the number of dropped
+ *   messages is reported in the log file.
+ * - The ring buffers take at most `[tools.async_logger] max_buffer_kb`, the threads created
+ *   after that share one ring buffer protected by a lock.
+ * - Messages at LOG_LEVEL_ERROR wake the background thread to write them immediately.
+ * - Messages at LOG_LEVEL_FATAL are flushed before returning, since the process is going to
+ *   abort.
+ *
+ * The log file naming, rolling and copying to stderr follow the configs of simple_logger.
+ */
+class async_logger : public logging_provider
+{
+public:
+    explicit async_logger(const char *log_dir);
+    ~async_logger() override;
+
+    void dsn_logv(const char *file,
+                  const char *function,
+                  const int line,
+                  dsn_log_level_t log_level,
+                  const char *fmt,
+                  va_list args) override;
+
+    void dsn_log(const char *file,
+                 const char *function,
+                 const int line,
+                 dsn_log_level_t log_level,
+                 const char *str) override;
+
+    // Blocks until the messages logged before are written and flushed to the log file.
+    void flush() override;
+
+    uint64_t dropped_count() const { return _dropped_count.load(std::memory_order_relaxed); }
+
+private:
+    class ring_buffer;
+
+    ring_buffer *get_ring_buffer();
+    void append(dsn_log_level_t log_level, const std::string &message);
+
+    void write_loop();
+    // Writes out all the messages in the ring buffers, returns the number of them.
+    size_t drain();
+    void write_buffers();
+
+private:
+    const uint64_t _id;
+    dsn_log_level_t _stderr_start_level;
+
+    // only accessed by the writer thread
+    log_file_roller _roller;
+    FILE *_log;
+    int _lines;
+    std::string _buffer;
+    std::string _stderr_buffer;
+
+    // protects `_ring_buffers` and `_ring_buffer_of_thread`
+    std::mutex _ring_buffers_lock;
+    std::vector<std::unique_ptr<ring_buffer>> _ring_buffers;
+    std::unordered_map<int, ring_buffer *> _ring_buffer_of_thread;
+    // shared by the threads that don't own a ring buffer
+    std::unique_ptr<ring_buffer> _shared_ring_buffer;
+    ::dsn::utils::ex_lock_nr_spin _shared_ring_buffer_lock;
+
+    std::atomic<uint64_t> _dropped_count;
+    uint64_t _reported_dropped_count;
+
+    std::mutex _writer_lock;
+    std::condition_variable _writer_cv;
+    std::condition_variable _flushed_cv;
+    uint64_t _flush_requested;
+    uint64_t _flushed;
+    // set by the messages that should be written without waiting for the flush interval
+    std::atomic<bool> _wake_requested;
+    bool _stopping;
+    std::thread _writer;
+};
+
+} // namespace tools
+} // namespace dsn
@@ -71,7 +71,7 @@ void binary_writer::create_buffer(size_t size)
 
 void binary_writer::create_new_buffer(size_t size, /*out*/ blob &bb)
 {
-    bb.assign(::dsn::utils::make_shared_array<char>(size), 0, (int)size);
+    bb.assign(::dsn::utils::buffer_pool::make_shared(size), 0, (int)size);
 }
 
 void binary_writer::commit()
@@ -93,7 +93,7 @@ blob binary_writer::get_buffer()
     } else if (_total_size == 0) {
         return blob();
     } else {
-        std::shared_ptr<char> bptr(::dsn::utils::make_shared_array<char>(_total_size));
+        std::shared_ptr<char> bptr(::dsn::utils::buffer_pool::make_shared(_total_size));
         blob bb(bptr, _total_size);
         const char *ptr = bb.data();
 
@@ -110,7 +110,7 @@ blob binary_writer::get_current_buffer()
     if (_buffers.size() == 1) {
         return _current_offset > 0 ? _buffers[0].range(0, _current_offset) : _buffers[0];
     } else {
-        std::shared_ptr<char> bptr(::dsn::utils::make_shared_array<char>(_total_size));
+        std::shared_ptr<char> bptr(::dsn::utils::buffer_pool::make_shared(_total_size));
         blob bb(bptr, _total_size);
         const char *ptr = bb.data();
 
@@ -174,6 +174,27 @@ void binary_writer::write(const char *buffer, int sz)
     }
 }
 
+void binary_writer::write_nocopy(const blob &val)
+{
+    if (static_cast<int>(val.length()) < nocopy_min_bytes || val.buffer_ptr() == nullptr) {
+        write(val.data(), static_cast<int>(val.length()));
+        return;
+    }
+
+    commit();
+    if (_current_buffer_length > 0) {
+        // the current buffer is allocated but nothing is written into it
+        *_buffers.rbegin() = _buffers.rbegin()->range(0, 0);
+    }
+
+    append_new_buffer(val);
+    _buffers.push_back(val);
+    _current_buffer = nullptr;
+    _current_offset = 0;
+    _current_buffer_length = 0;
+    _total_size += val.length();
+}
+
 bool binary_writer::next(void **data, int *size)
 {
     int rem_size = _current_buffer_length - _current_offset;
@@ -0,0 +1,377 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <dsn/utility/buffer_pool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <unordered_set>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <dsn/utility/flags.h>
+#include <dsn/utility/ports.h>
+
+namespace dsn {
+namespace utils {
+
+DSN_DEFINE_bool("core",
+                buffer_pool_enabled,
+                true,
+                "whether the small buffers of rpc messages are cached per thread for reuse");
+DSN_DEFINE_uint64("core",
+                  buffer_pool_max_cached_bytes_per_thread,
+                  4 * 1024 * 1024,
+                  "max bytes of free buffers cached by each thread");
+DSN_DEFINE_uint64("core",
+                  buffer_pool_max_cached_bytes_per_class,
+                  256 * 1024,
+                  "max bytes of free buffers of one size class cached by each thread");
+DSN_DEFINE_uint64("core",
+                  buffer_pool_max_cached_bytes,
+                  64 * 1024 * 1024,
+                  "max bytes of free buffers cached by all the threads, each thread caches at "
+                  "most an equal share of it");
+DSN_DEFINE_uint64("core",
+                  buffer_pool_max_central_cached_bytes,
+                  16 * 1024 * 1024,
+                  "max bytes of free buffers moved out of the thread caches, which are shared "
+                  "by all the threads");
+
+namespace {
+
+// the unused buffers of a thread cache are moved to the central lists every so many operations
+const uint32_t kScavengeInterval = 64 * 1024;
+
+inline size_t class_size(int cls) { return buffer_pool::class_size(cls); }
+
+// max count of the buffers of the size class in a thread cache
+inline size_t max_cached_count(int cls)
+{
+    return std::max<size_t>(1, FLAGS_buffer_pool_max_cached_bytes_per_class / class_size(cls));
+}
+
+// count of the buffers moved between a thread cache and the central list at a time
+inline size_t batch_count(int cls) { return std::max<size_t>(1, max_cached_count(cls) / 2); }
+
+// only the owner thread writes the counters, other threads just read them for statistics
+inline void bump(std::atomic<uint64_t> &counter, int64_t delta = 1)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+struct thread_cache
+{
+    std::vector<void *> free_lists[buffer_pool::kClassCount];
+    // the min size of each free list since the last scavenging, the buffers below it are not
+    // used during that time
+    size_t low_water[buffer_pool::kClassCount] = {};
+    uint32_t ops_since_scavenge = 0;
+
+    std::atomic<uint64_t> alloc_count{0};
+    std::atomic<uint64_t> hit_count{0};
+    std::atomic<uint64_t> central_hit_count{0};
+    std::atomic<uint64_t> oversize_count{0};
+    std::atomic<uint64_t> free_count{0};
+    std::atomic<uint64_t> cached_count{0};
+    std::atomic<uint64_t> cached_bytes{0};
+};
+
+struct central_list
+{
+    std::mutex lock;
+    std::vector<void *> buffers;
+};
+
+struct cache_registry
+{
+    std::mutex lock;
+    std::unordered_set<thread_cache *> caches;
+    std::atomic<uint64_t> thread_count{0};
+    // statistics of the exited threads
+    buffer_pool::stats retired;
+
+    central_list central_lists[buffer_pool::kClassCount];
+    std::atomic<uint64_t> central_cached_bytes{0};
+};
+
+// never destroyed, because the thread caches may be released after the static objects
+cache_registry &registry()
+{
+    static cache_registry *r = new cache_registry();
+    return *r;
+}
+
+// max bytes cached by the current thread
+inline uint64_t max_thread_cached_bytes()
+{
+    uint64_t thread_count = std::max<uint64_t>(
+        1, registry().thread_count.load(std::memory_order_relaxed));
+    return std::min<uint64_t>(FLAGS_buffer_pool_max_cached_bytes_per_thread,
+                              FLAGS_buffer_pool_max_cached_bytes / thread_count);
+}
+
+// Moves `count` buffers of the size class at the back of the thread cache to the central list,
+// the ones beyond the capacity of the central list are freed.
+void release_to_central(thread_cache *cache, int cls, size_t count)
+{
+    std::vector<void *> &list = cache->free_lists[cls];
+    count = std::min(count, list.size());
+    if (count == 0) {
+        return;
+    }
+
+    size_t bytes = class_size(cls);
+    cache_registry &r = registry();
+    size_t start = list.size() - count;
+    {
+        central_list &central = r.central_lists[cls];
+        std::lock_guard<std::mutex> guard(central.lock);
+        for (size_t i = start; i < list.size(); ++i) {
+            if (r.central_cached_bytes.load(std::memory_order_relaxed) + bytes <=
+                FLAGS_buffer_pool_max_central_cached_bytes) {
+                central.buffers.push_back(list[i]);
+                r.central_cached_bytes.fetch_add(bytes, std::memory_order_relaxed);
+            } else {
+                ::operator delete(list[i]);
+            }
+        }
+    }
+    list.resize(start);
+    bump(cache->cached_bytes, -static_cast<int64_t>(count * bytes));
+    cache->low_water[cls] = std::min(cache->low_water[cls], list.size());
+}
+
+// Refills the empty free list of the size class from the central list.
+void fetch_from_central(thread_cache *cache, int cls)
+{
+    std::vector<void *> &list = cache->free_lists[cls];
+    size_t bytes = class_size(cls);
+    cache_registry &r = registry();
+    size_t count = 0;
+    {
+        central_list &central = r.central_lists[cls];
+        std::lock_guard<std::mutex> guard(central.lock);
+        count = std::min(batch_count(cls), central.buffers.size());
+        list.insert(list.end(), central.buffers.end() - count, central.buffers.end());
+        central.buffers.resize(central.buffers.size() - count);
+        r.central_cached_bytes.fetch_sub(count * bytes, std::memory_order_relaxed);
+    }
+    bump(cache->cached_bytes, count * bytes);
+}
+
+// Moves half of the buffers not used since the last scavenging to the central lists.
+void scavenge(thread_cache *cache)
+{
+    cache->ops_since_scavenge = 0;
+    for (int cls = 0; cls < buffer_pool::kClassCount; ++cls) {
+        release_to_central(cache, cls, (cache->low_water[cls] + 1) / 2);
+        cache->low_water[cls] = cache->free_lists[cls].size();
+    }
+}
+
+thread_local thread_cache *t_cache = nullptr;
+// buffers may still be released by the destructors of other thread local objects after the
+// cache is destroyed, and they go to the general allocator then
+thread_local bool t_cache_destroyed = false;
+
+struct thread_cache_holder
+{
+    void touch() {}
+
+    ~thread_cache_holder()
+    {
+        t_cache_destroyed = true;
+        if (t_cache == nullptr) {
+            return;
+        }
+
+        thread_cache *cache = t_cache;
+        t_cache = nullptr;
+        // the buffers may be reused by other threads
+        for (int cls = 0; cls < buffer_pool::kClassCount; ++cls) {
+            release_to_central(cache, cls, cache->free_lists[cls].size());
+        }
+
+        cache_registry &r = registry();
+        {
+            std::lock_guard<std::mutex> guard(r.lock);
+            r.caches.erase(cache);
+            r.thread_count.store(r.caches.size(), std::memory_order_relaxed);
+            r.retired.alloc_count += cache->alloc_count.load(std::memory_order_relaxed);
+            r.retired.hit_count += cache->hit_count.load(std::memory_order_relaxed);
+            r.retired.central_hit_count +=
+                cache->central_hit_count.load(std::memory_order_relaxed);
+            r.retired.oversize_count += cache->oversize_count.load(std::memory_order_relaxed);
+            r.retired.free_count += cache->free_count.load(std::memory_order_relaxed);
+            r.retired.cached_count += cache->cached_count.load(std::memory_order_relaxed);
+        }
+        delete cache;
+    }
+};
+
+thread_local thread_cache_holder t_cache_holder;
+
+thread_cache *get_thread_cache()
+{
+    if (!FLAGS_buffer_pool_enabled) {
+        return nullptr;
+    }
+    if (dsn_likely(t_cache != nullptr)) {
+        return t_cache;
+    }
+    if (t_cache_destroyed) {
+        return nullptr;
+    }
+
+    // make sure the holder is constructed, so that the cache is released on thread exit
+    t_cache_holder.touch();
+    t_cache = new thread_cache();
+
+    cache_registry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    r.caches.insert(t_cache);
+    r.thread_count.store(r.caches.size(), std::memory_order_relaxed);
+    return t_cache;
+}
+
+struct buffer_deleter
+{
+    size_t size;
+    void operator()(char *p) const { buffer_pool::deallocate(p, size); }
+};
+
+} // anonymous namespace
+
+/*static*/ void *buffer_pool::allocate(size_t size)
+{
+    int cls = size_class(size);
+    thread_cache *cache = get_thread_cache();
+    if (cache != nullptr) {
+        bump(cache->alloc_count);
+        if (cls < 0) {
+            bump(cache->oversize_count);
+        } else {
+            std::vector<void *> &list = cache->free_lists[cls];
+            bool from_central = false;
+            if (list.empty()) {
+                fetch_from_central(cache, cls);
+                from_central = true;
+            }
+            if (!list.empty()) {
+                void *p = list.back();
+                list.pop_back();
+                bump(from_central ? cache->central_hit_count : cache->hit_count);
+                bump(cache->cached_bytes, -static_cast<int64_t>(class_size(cls)));
+                cache->low_water[cls] = std::min(cache->low_water[cls], list.size());
+                if (++cache->ops_since_scavenge >= kScavengeInterval) {
+                    scavenge(cache);
+                }
+                return p;
+            }
+        }
+    }
+
+    // always allocate the whole class, as the buffer may be cached on release anyway
+    return ::operator new(cls < 0 ? size : class_size(cls));
+}
+
+/*static*/ void buffer_pool::deallocate(void *p, size_t size)
+{
+    if (p == nullptr) {
+        return;
+    }
+
+    int cls = size_class(size);
+    thread_cache *cache = get_thread_cache();
+    if (cache != nullptr) {
+        bump(cache->free_count);
+        if (cls >= 0) {
+            std::vector<void *> &list = cache->free_lists[cls];
+            uint64_t max_bytes = max_thread_cached_bytes();
+            if (list.size() >= max_cached_count(cls) ||
+                cache->cached_bytes.load(std::memory_order_relaxed) + class_size(cls) >
+                    max_bytes) {
+                release_to_central(cache, cls, batch_count(cls));
+            }
+            // the thread cache may still be full of the other size classes
+            if (cache->cached_bytes.load(std::memory_order_relaxed) + class_size(cls) <=
+                max_bytes) {
+                list.push_back(p);
+                bump(cache->cached_count);
+                bump(cache->cached_bytes, class_size(cls));
+                if (++cache->ops_since_scavenge >= kScavengeInterval) {
+                    scavenge(cache);
+                }
+                return;
+            }
+        }
+    }
+
+    ::operator delete(p);
+}
+
+/*static*/ std::shared_ptr<char> buffer_pool::make_shared(size_t size)
+{
+    return std::shared_ptr<char>(
+        static_cast<char *>(allocate(size)), buffer_deleter{size}, pool_allocator<char>());
+}
+
+/*static*/ buffer_pool::stats buffer_pool::get_stats()
+{
+    cache_registry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+
+    stats s = r.retired;
+    for (thread_cache *cache : r.caches) {
+        s.alloc_count += cache->alloc_count.load(std::memory_order_relaxed);
+        s.hit_count += cache->hit_count.load(std::memory_order_relaxed);
+        s.central_hit_count += cache->central_hit_count.load(std::memory_order_relaxed);
+        s.oversize_count += cache->oversize_count.load(std::memory_order_relaxed);
+        s.free_count += cache->free_count.load(std::memory_order_relaxed);
+        s.cached_count += cache->cached_count.load(std::memory_order_relaxed);
+        s.cached_bytes += cache->cached_bytes.load(std::memory_order_relaxed);
+    }
+    s.central_cached_bytes = r.central_cached_bytes.load(std::memory_order_relaxed);
+    s.thread_count = r.caches.size();
+    return s;
+}
+
+std::string buffer_pool::stats::to_string() const
+{
+    return fmt::format("alloc_count = {}, hit_count = {}, central_hit_count = {}, "
+                       "hit_ratio = {:.2f}%, oversize_count = {}, free_count = {}, "
+                       "cached_count = {}, cached_bytes = {}, central_cached_bytes = {}, "
+                       "thread_count = {}",
+                       alloc_count,
+                       hit_count,
+                       central_hit_count,
+                       alloc_count == 0 ? 0.0 : 100.0 * (hit_count + central_hit_count) /
+                                                    alloc_count,
+                       oversize_count,
+                       free_count,
+                       cached_count,
+                       cached_bytes,
+                       central_cached_bytes,
+                       thread_count);
+}
+
+} // namespace utils
+} // namespace dsn
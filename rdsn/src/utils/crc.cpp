@@ -25,8 +25,19 @@
  */
 
 #include <cstdio>
+#include <cstring>
 #include <dsn/utility/crc.h>
 
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#include <smmintrin.h>
+#include <wmmintrin.h>
+#elif defined(__aarch64__) && defined(__linux__)
+#include <arm_acle.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
 namespace dsn {
 namespace utils {
 
@@ -439,12 +450,184 @@ uint64_t crc64::_crc_table[sizeof(crc64::_crc_table) / sizeof(crc64::_crc_table[
 #undef crc64_POLY
 #undef BIT64
 #undef BIT32
+
+//
+// The crc32 polynomial above is CRC-32C (Castagnoli), which is exactly what the crc32
+// instructions of SSE4.2 and ARMv8 compute, so they only need the same bitwise NOTs around.
+//
+// There is no instruction for the crc64 polynomial, it is computed by folding 128-bit blocks
+// with carry-less multiplication (PCLMULQDQ), see "Fast CRC Computation for Generic
+// Polynomials Using PCLMULQDQ Instruction" by Intel. The folded 16 bytes and the tail are
+// finished with the table.
+//
+#if defined(__x86_64__)
+
+__attribute__((target("sse4.2"))) static uint32_t
+crc32_sse42(const void *ptr, size_t size, uint32_t init_crc)
+{
+    const uint8_t *data = (const uint8_t *)ptr;
+    uint64_t crc = (uint32_t)~init_crc;
+    for (; size >= 8; size -= 8, data += 8) {
+        uint64_t v;
+        memcpy(&v, data, sizeof(v));
+        crc = _mm_crc32_u64(crc, v);
+    }
+
+    uint32_t crc32 = (uint32_t)crc;
+    for (; size > 0; size -= 1, data += 1) {
+        crc32 = _mm_crc32_u8(crc32, *data);
+    }
+    return ~crc32;
+}
+
+// Returns (x ** n) mod POLY, in the same "reversed" order as crc64::MulPoly.
+static uint64_t crc64_x_pow_mod(uint64_t n)
+{
+    uint64_t r = crc64::MSB;
+    uint64_t x = crc64::MSB >> 1;
+    for (; n != 0; n >>= 1) {
+        if (n & 1)
+            r = crc64::MulPoly(r, x);
+        x = crc64::MulPoly(x, x);
+    }
+    return r;
+}
+
+// Constants to fold a 128-bit block over `distance` bits: a "reversed" carry-less product is
+// one bit short, so both exponents are decreased by 1.
+// The low 64 bits of a block hold its high-order coefficients.
+struct crc64_fold_constants
+{
+    uint64_t low;
+    uint64_t high;
+
+    void init(uint64_t distance)
+    {
+        low = crc64_x_pow_mod(distance + 64 - 1);
+        high = crc64_x_pow_mod(distance - 1);
+    }
+};
+
+// initialized in select_crc64_calc
+static crc64_fold_constants crc64_fold_by_1;
+static crc64_fold_constants crc64_fold_by_4;
+
+__attribute__((target("pclmul,sse4.1"))) static inline __m128i fold_128(__m128i a, __m128i k)
+{
+    return _mm_xor_si128(_mm_clmulepi64_si128(a, k, 0x00), _mm_clmulepi64_si128(a, k, 0x11));
+}
+
+__attribute__((target("pclmul,sse4.1"))) static uint64_t
+crc64_pclmul(const void *ptr, size_t size, uint64_t init_crc)
+{
+    // too short to be folded
+    if (size < 32) {
+        return crc64::compute(ptr, size, init_crc);
+    }
+
+    const uint8_t *data = (const uint8_t *)ptr;
+    const __m128i k1 = _mm_set_epi64x(crc64_fold_by_1.high, crc64_fold_by_1.low);
+
+    // the initial crc is equivalent to xor-ing the first 8 bytes
+    __m128i x0 = _mm_loadu_si128((const __m128i *)data);
+    x0 = _mm_xor_si128(x0, _mm_set_epi64x(0, ~init_crc));
+    data += 16;
+    size -= 16;
+
+    if (size >= 112) {
+        const __m128i k4 = _mm_set_epi64x(crc64_fold_by_4.high, crc64_fold_by_4.low);
+        __m128i x1 = _mm_loadu_si128((const __m128i *)data);
+        __m128i x2 = _mm_loadu_si128((const __m128i *)(data + 16));
+        __m128i x3 = _mm_loadu_si128((const __m128i *)(data + 32));
+        data += 48;
+        size -= 48;
+
+        for (; size >= 64; size -= 64, data += 64) {
+            x0 = _mm_xor_si128(fold_128(x0, k4), _mm_loadu_si128((const __m128i *)data));
+            x1 = _mm_xor_si128(fold_128(x1, k4), _mm_loadu_si128((const __m128i *)(data + 16)));
+            x2 = _mm_xor_si128(fold_128(x2, k4), _mm_loadu_si128((const __m128i *)(data + 32)));
+            x3 = _mm_xor_si128(fold_128(x3, k4), _mm_loadu_si128((const __m128i *)(data + 48)));
+        }
+
+        x0 = _mm_xor_si128(fold_128(x0, k1), x1);
+        x0 = _mm_xor_si128(fold_128(x0, k1), x2);
+        x0 = _mm_xor_si128(fold_128(x0, k1), x3);
+    }
+
+    for (; size >= 16; size -= 16, data += 16) {
+        x0 = _mm_xor_si128(fold_128(x0, k1), _mm_loadu_si128((const __m128i *)data));
+    }
+
+    // the crc of the folded block starting from a zero register, then the tail
+    uint8_t folded[16];
+    _mm_storeu_si128((__m128i *)folded, x0);
+    uint64_t crc = crc64::compute(folded, sizeof(folded), ~0ULL);
+    return crc64::compute(data, size, crc);
+}
+
+#elif defined(__aarch64__) && defined(__linux__)
+
+__attribute__((target("+crc"))) static uint32_t
+crc32_armv8(const void *ptr, size_t size, uint32_t init_crc)
+{
+    const uint8_t *data = (const uint8_t *)ptr;
+    uint32_t crc = ~init_crc;
+    for (; size >= 8; size -= 8, data += 8) {
+        uint64_t v;
+        memcpy(&v, data, sizeof(v));
+        crc = __crc32cd(crc, v);
+    }
+    for (; size > 0; size -= 1, data += 1) {
+        crc = __crc32cb(crc, *data);
+    }
+    return ~crc;
+}
+
+#endif
+
+typedef uint32_t (*crc32_calc_func)(const void *, size_t, uint32_t);
+typedef uint64_t (*crc64_calc_func)(const void *, size_t, uint64_t);
+
+static crc32_calc_func select_crc32_calc()
+{
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        return crc32_sse42;
+    }
+#elif defined(__aarch64__) && defined(__linux__)
+    if (getauxval(AT_HWCAP) & HWCAP_CRC32) {
+        return crc32_armv8;
+    }
+#endif
+    return crc32::compute;
+}
+
+static crc64_calc_func select_crc64_calc()
+{
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1")) {
+        crc64_fold_by_1.init(128);
+        crc64_fold_by_4.init(512);
+        return crc64_pclmul;
+    }
+#endif
+    return crc64::compute;
+}
 }
 }
 
 namespace dsn {
 namespace utils {
 uint32_t crc32_calc(const void *ptr, size_t size, uint32_t init_crc)
+{
+    // selected on the first call, so it also works during static initialization
+    static const crc32_calc_func impl = select_crc32_calc();
+    return impl(ptr, size, init_crc);
+}
+
+uint32_t crc32_calc_portable(const void *ptr, size_t size, uint32_t init_crc)
 {
     return dsn::utils::crc32::compute(ptr, size, init_crc);
 }
@@ -462,6 +645,12 @@ uint32_t crc32_concat(uint32_t xy_init,
 }
 
 uint64_t crc64_calc(const void *ptr, size_t size, uint64_t init_crc)
+{
+    static const crc64_calc_func impl = select_crc64_calc();
+    return impl(ptr, size, init_crc);
+}
+
+uint64_t crc64_calc_portable(const void *ptr, size_t size, uint64_t init_crc)
 {
     return dsn::utils::crc64::compute(ptr, size, init_crc);
 }
@@ -0,0 +1,125 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <fmt/ostream.h>
+
+#include <dsn/c/api_layer1.h>
+#include <dsn/utility/crc.h>
+#include <dsn/utility/rand.h>
+#include <dsn/utility/string_conv.h>
+
+void print_usage(const char *cmd)
+{
+    fmt::print(stderr, "USAGE: {} <num_operations> <buffer_size> <crc_type>\n", cmd);
+    fmt::print(stderr,
+               "Run a simple benchmark that computes the crc of a buffer repeatedly, to compare "
+               "the hardware-accelerated implementations with the portable ones.\n\n");
+
+    fmt::print(stderr, "    <num_operations>       the number of crc computations\n");
+    fmt::print(stderr, "    <buffer_size>          the size of the buffer in bytes\n");
+    fmt::print(stderr,
+               "    <crc_type>             the type of crc: crc32, crc32_portable, crc64, "
+               "crc64_portable\n");
+}
+
+template <typename Func>
+void run_bench(int64_t num_operations, const std::vector<char> &buffer, const char *name, Func f)
+{
+    uint64_t crc = 0;
+
+    uint64_t start = dsn_now_ns();
+    for (int64_t i = 0; i < num_operations; ++i) {
+        crc = f(buffer.data(), buffer.size(), crc);
+    }
+    uint64_t end = dsn_now_ns();
+
+    auto duration_ns = static_cast<int64_t>(end - start);
+    std::chrono::nanoseconds nano(duration_ns);
+    auto duration_s = std::chrono::duration_cast<std::chrono::duration<double>>(nano).count();
+    double total_mb = static_cast<double>(num_operations) * buffer.size() / (1024 * 1024);
+
+    fmt::print(stdout,
+               "Running {} operations of {} on {} bytes took {} seconds, throughput = {:.2f} "
+               "MB/s, result = {}.\n",
+               num_operations,
+               name,
+               buffer.size(),
+               duration_s,
+               duration_s > 0 ? total_mb / duration_s : 0,
+               crc);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 4) {
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    int64_t num_operations;
+    if (!dsn::buf2int64(argv[1], num_operations)) {
+        fmt::print(stderr, "Invalid num_operations: {}\n\n", argv[1]);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    int64_t buffer_size;
+    if (!dsn::buf2int64(argv[2], buffer_size) || buffer_size < 0) {
+        fmt::print(stderr, "Invalid buffer_size: {}\n\n", argv[2]);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    std::vector<char> buffer(buffer_size);
+    for (auto &c : buffer) {
+        c = static_cast<char>(dsn::rand::next_u32(0, 255));
+    }
+
+    const char *crc_type = argv[3];
+    if (strcmp(crc_type, "crc32") == 0) {
+        run_bench(num_operations, buffer, crc_type, [](const char *p, size_t n, uint64_t crc) {
+            return dsn::utils::crc32_calc(p, n, static_cast<uint32_t>(crc));
+        });
+    } else if (strcmp(crc_type, "crc32_portable") == 0) {
+        run_bench(num_operations, buffer, crc_type, [](const char *p, size_t n, uint64_t crc) {
+            return dsn::utils::crc32_calc_portable(p, n, static_cast<uint32_t>(crc));
+        });
+    } else if (strcmp(crc_type, "crc64") == 0) {
+        run_bench(num_operations, buffer, crc_type, [](const char *p, size_t n, uint64_t crc) {
+            return dsn::utils::crc64_calc(p, n, crc);
+        });
+    } else if (strcmp(crc_type, "crc64_portable") == 0) {
+        run_bench(num_operations, buffer, crc_type, [](const char *p, size_t n, uint64_t crc) {
+            return dsn::utils::crc64_calc_portable(p, n, crc);
+        });
+    } else {
+        fmt::print(stderr, "Invalid crc_type: {}\n\n", crc_type);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    return 0;
+}
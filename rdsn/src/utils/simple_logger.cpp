@@ -107,15 +107,11 @@ void screen_logger::dsn_logv(const char *file,
 
 void screen_logger::flush() { ::fflush(stdout); }
 
-simple_logger::simple_logger(const char *log_dir) : logging_provider(log_dir)
+log_file_roller::log_file_roller(const std::string &log_dir) : _log_dir(log_dir)
 {
-    _log_dir = std::string(log_dir);
     // we assume all valid entries are positive
     _start_index = 0;
     _index = 1;
-    _lines = 0;
-    _log = nullptr;
-    _stderr_start_level = enum_from_string(FLAGS_stderr_start_level, LOG_LEVEL_INVALID);
 
     // check existing log files
     std::vector<std::string> sub_list;
@@ -143,20 +139,16 @@ simple_logger::simple_logger(const char *log_dir) : logging_provider(log_dir)
         _start_index = _index;
     else
         ++_index;
-
-    create_log_file();
 }
 
-void simple_logger::create_log_file()
+FILE *log_file_roller::roll(FILE *current)
 {
-    if (_log != nullptr)
-        ::fclose(_log);
-
-    _lines = 0;
+    if (current != nullptr)
+        ::fclose(current);
 
     std::stringstream str;
     str << _log_dir << "/log." << _index++ << ".txt";
-    _log = ::fopen(str.str().c_str(), "w+");
+    FILE *log = ::fopen(str.str().c_str(), "w+");
 
     // TODO: move gc out of criticial path
     while (_index - _start_index > FLAGS_max_number_of_log_files_on_disk) {
@@ -170,6 +162,22 @@ void simple_logger::create_log_file()
             }
         }
     }
+    return log;
+}
+
+simple_logger::simple_logger(const char *log_dir) : logging_provider(log_dir), _roller(log_dir)
+{
+    _lines = 0;
+    _log = nullptr;
+    _stderr_start_level = enum_from_string(FLAGS_stderr_start_level, LOG_LEVEL_INVALID);
+
+    create_log_file();
+}
+
+void simple_logger::create_log_file()
+{
+    _lines = 0;
+    _log = _roller.roll(_log);
 }
 
 simple_logger::~simple_logger(void)
@@ -218,7 +226,7 @@ void simple_logger::dsn_logv(const char *file,
         printf("\n");
     }
 
-    if (++_lines >= 200000) {
+    if (++_lines >= MAX_LINES_PER_LOG_FILE) {
         create_log_file();
     }
 }
@@ -248,7 +256,7 @@ void simple_logger::dsn_log(const char *file,
         printf("%s\n", str);
     }
 
-    if (++_lines >= 200000) {
+    if (++_lines >= MAX_LINES_PER_LOG_FILE) {
         create_log_file();
     }
 }
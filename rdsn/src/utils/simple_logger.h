@@ -63,6 +63,28 @@ private:
     bool _short_header;
 };
 
+/*
+ * log_file_roller manages the log files named "log.<index>.txt" under a directory. The
+ * indexes continue from the existing files, and the oldest files are removed once there
+ * are more than `max_number_of_log_files_on_disk` of them.
+ */
+class log_file_roller
+{
+public:
+    explicit log_file_roller(const std::string &log_dir);
+
+    // Closes `current` if it's not null, and returns the newly opened log file.
+    FILE *roll(FILE *current);
+
+private:
+    std::string _log_dir;
+    int _start_index;
+    int _index;
+};
+
+// The max number of lines in a log file.
+static const int MAX_LINES_PER_LOG_FILE = 200000;
+
 /*
  * simple_logger provides a logger which writes to file.
  * The max number of lines in a logger file is 200000.
@@ -92,12 +114,10 @@ private:
     void create_log_file();
 
 private:
-    std::string _log_dir;
+    log_file_roller _roller;
     ::dsn::utils::ex_lock _lock; // use recursive lock to avoid dead lock when flush() is called
                                  // in signal handler if cored for bad logging format reason.
     FILE *_log;
-    int _start_index;
-    int _index;
     int _lines;
     dsn_log_level_t _stderr_start_level;
 };
@@ -0,0 +1,171 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <dsn/utility/buffer_pool.h>
+
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace dsn {
+namespace utils {
+
+TEST(buffer_pool_test, size_class)
+{
+    ASSERT_EQ(0, buffer_pool::size_class(0));
+    ASSERT_EQ(0, buffer_pool::size_class(1));
+    ASSERT_EQ(0, buffer_pool::size_class(64));
+    ASSERT_EQ(1, buffer_pool::size_class(65));
+    ASSERT_EQ(1, buffer_pool::size_class(80));
+    ASSERT_EQ(2, buffer_pool::size_class(81));
+    ASSERT_EQ(buffer_pool::kClassCount - 1, buffer_pool::size_class(buffer_pool::kMaxClassSize));
+    ASSERT_EQ(-1, buffer_pool::size_class(buffer_pool::kMaxClassSize + 1));
+
+    ASSERT_EQ(64, buffer_pool::class_size(0));
+    ASSERT_EQ(80, buffer_pool::class_size(1));
+    ASSERT_EQ(128, buffer_pool::class_size(4));
+    ASSERT_EQ(64 * 1024, buffer_pool::class_size(buffer_pool::kClassCount - 1));
+
+    // a buffer wastes less than a quarter of its size
+    for (size_t size = buffer_pool::kMinClassSize + 1; size <= buffer_pool::kMaxClassSize;
+         ++size) {
+        size_t cls_size = buffer_pool::class_size(buffer_pool::size_class(size));
+        ASSERT_LE(size, cls_size);
+        ASSERT_LT(cls_size - size, size / 4) << size;
+    }
+}
+
+TEST(buffer_pool_test, reuse_in_thread)
+{
+    // run in a new thread to start with an empty cache
+    std::thread t([]() {
+        buffer_pool::stats before = buffer_pool::get_stats();
+
+        void *p1 = buffer_pool::allocate(100);
+        memset(p1, 'a', 100);
+        buffer_pool::deallocate(p1, 100);
+
+        // the same size class is served from the cache
+        void *p2 = buffer_pool::allocate(112);
+        ASSERT_EQ(p1, p2);
+        buffer_pool::deallocate(p2, 112);
+
+        // oversize buffers are never cached
+        void *p3 = buffer_pool::allocate(buffer_pool::kMaxClassSize + 1);
+        buffer_pool::deallocate(p3, buffer_pool::kMaxClassSize + 1);
+
+        buffer_pool::stats after = buffer_pool::get_stats();
+        ASSERT_EQ(3, after.alloc_count - before.alloc_count);
+        ASSERT_EQ(1, after.hit_count - before.hit_count);
+        ASSERT_EQ(1, after.oversize_count - before.oversize_count);
+        ASSERT_EQ(3, after.free_count - before.free_count);
+        ASSERT_EQ(2, after.cached_count - before.cached_count);
+    });
+    t.join();
+}
+
+TEST(buffer_pool_test, shared_buffer)
+{
+    std::thread t([]() {
+        char *raw = nullptr;
+        {
+            std::shared_ptr<char> buf = buffer_pool::make_shared(1000);
+            raw = buf.get();
+            memset(raw, 'b', 1000);
+
+            std::shared_ptr<char> copy = buf;
+            ASSERT_EQ(2, buf.use_count());
+        }
+
+        // both the buffer and the control block are back to the cache
+        std::shared_ptr<char> buf = buffer_pool::make_shared(1000);
+        ASSERT_EQ(raw, buf.get());
+    });
+    t.join();
+}
+
+TEST(buffer_pool_test, release_in_other_thread)
+{
+    std::vector<std::shared_ptr<char>> buffers;
+    std::thread producer([&buffers]() {
+        for (int i = 0; i < 1000; ++i) {
+            buffers.emplace_back(buffer_pool::make_shared(i * 10));
+        }
+    });
+    producer.join();
+
+    buffer_pool::stats before = buffer_pool::get_stats();
+    std::thread consumer([&buffers]() { buffers.clear(); });
+    consumer.join();
+
+    // the consumer has exited, so the buffers are released and its statistics are retired
+    buffer_pool::stats after = buffer_pool::get_stats();
+    ASSERT_EQ(2000, after.free_count - before.free_count);
+    ASSERT_EQ(before.thread_count, after.thread_count);
+}
+
+TEST(buffer_pool_test, reuse_buffers_released_in_other_thread)
+{
+    // a size class not used by the other tests, so the central list only holds the buffers of
+    // this test
+    const size_t size = 40000;
+    const int count = 32;
+    std::vector<void *> buffers;
+    std::thread producer([&buffers, size, count]() {
+        for (int i = 0; i < count; ++i) {
+            buffers.push_back(buffer_pool::allocate(size));
+        }
+    });
+    producer.join();
+
+    // the consumer caches a few of them, and moves the others to the central list, so does it
+    // on exit
+    std::thread consumer([&buffers, size]() {
+        for (void *p : buffers) {
+            buffer_pool::deallocate(p, size);
+        }
+        ASSERT_LT(0, buffer_pool::get_stats().central_cached_bytes);
+    });
+    consumer.join();
+
+    // the buffers are drawn from the central list by another thread
+    std::thread another_producer([&buffers, size, count]() {
+        buffer_pool::stats before = buffer_pool::get_stats();
+        std::set<void *> released(buffers.begin(), buffers.end());
+        std::vector<void *> reused;
+        for (int i = 0; i < count; ++i) {
+            reused.push_back(buffer_pool::allocate(size));
+            ASSERT_EQ(1, released.count(reused.back()));
+        }
+        buffer_pool::stats after = buffer_pool::get_stats();
+        ASSERT_EQ(count,
+                  after.hit_count + after.central_hit_count - before.hit_count -
+                      before.central_hit_count);
+        ASSERT_LT(0, after.central_hit_count - before.central_hit_count);
+
+        for (void *p : reused) {
+            buffer_pool::deallocate(p, size);
+        }
+    });
+    another_producer.join();
+}
+
+} // namespace utils
+} // namespace dsn
@@ -34,8 +34,18 @@
  */
 
 #include "utils/simple_logger.h"
+#include "utils/async_logger.h"
+#include <fstream>
 #include <gtest/gtest.h>
 #include <dsn/utility/filesystem.h>
+#include <dsn/utility/flags.h>
+#include <fmt/format.h>
+
+namespace dsn {
+namespace tools {
+DSN_DECLARE_uint32(flush_interval_ms);
+} // namespace tools
+} // namespace dsn
 
 using namespace dsn;
 using namespace dsn::tools;
@@ -94,6 +104,14 @@ void log_print(logging_provider *logger, const char *fmt, ...)
     va_end(vl);
 }
 
+void log_print_error(logging_provider *logger, const char *fmt, ...)
+{
+    va_list vl;
+    va_start(vl, fmt);
+    logger->dsn_logv(__FILE__, __FUNCTION__, __LINE__, LOG_LEVEL_ERROR, fmt, vl);
+    va_end(vl);
+}
+
 TEST(tools_common, simple_logger)
 {
     // cases for print_header
@@ -125,3 +143,91 @@ TEST(tools_common, simple_logger)
     clear_files(index);
     finish_test_dir();
 }
+
+TEST(tools_common, async_logger)
+{
+    prepare_test_dir();
+
+    const int thread_count = 4;
+    const int lines_per_thread = 10000;
+    uint64_t dropped_count = 0;
+    {
+        async_logger *logger = new async_logger("./");
+        std::vector<std::thread> threads;
+        for (int i = 0; i < thread_count; ++i) {
+            threads.emplace_back([logger]() {
+                for (int j = 0; j < lines_per_thread; ++j) {
+                    log_print(logger, "%s %d", "test_print", j);
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        logger->flush();
+        dropped_count = logger->dropped_count();
+        delete logger;
+    }
+
+    std::vector<int> index;
+    get_log_file_index(index);
+    ASSERT_EQ(1, index.size());
+
+    // every message is either written or counted as dropped
+    int lines = 0;
+    bool has_drop_report = false;
+    std::ifstream log_file(fmt::format("log.{}.txt", index[0]));
+    std::string line;
+    while (std::getline(log_file, line)) {
+        if (line.find("async_logger dropped") != std::string::npos) {
+            has_drop_report = true;
+        } else {
+            ++lines;
+        }
+    }
+    ASSERT_EQ(thread_count * lines_per_thread, lines + dropped_count);
+    ASSERT_EQ(dropped_count > 0, has_drop_report);
+
+    clear_files(index);
+    finish_test_dir();
+}
+
+TEST(tools_common, async_logger_wake_on_error)
+{
+    prepare_test_dir();
+
+    // the writer won't wake up by itself during the test
+    uint32_t old_flush_interval_ms = FLAGS_flush_interval_ms;
+    FLAGS_flush_interval_ms = 60000;
+    {
+        async_logger *logger = new async_logger("./");
+        std::vector<int> index;
+        get_log_file_index(index);
+        ASSERT_EQ(1, index.size());
+        std::string file_name = fmt::format("log.{}.txt", index[0]);
+
+        // wait for the writer to go idle
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        log_print_error(logger, "%s", "test_print_error");
+
+        bool written = false;
+        for (int i = 0; i < 100 && !written; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            std::ifstream log_file(file_name);
+            std::string line;
+            while (std::getline(log_file, line)) {
+                if (line.find("test_print_error") != std::string::npos) {
+                    written = true;
+                    break;
+                }
+            }
+        }
+        EXPECT_TRUE(written);
+
+        delete logger;
+        clear_files(index);
+    }
+    FLAGS_flush_interval_ms = old_flush_interval_ms;
+
+    finish_test_dir();
+}
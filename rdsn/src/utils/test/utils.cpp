@@ -70,6 +70,29 @@ TEST(core, crc)
     EXPECT_TRUE(c3 == c4);
 }
 
+TEST(core, crc_same_as_portable)
+{
+    std::vector<char> buffer(8192);
+    for (auto &c : buffer) {
+        c = static_cast<char>(rand::next_u32(0, 255));
+    }
+
+    // cover the unaligned heads, the folded blocks and the tails of all lengths
+    for (size_t offset = 0; offset < 16; offset++) {
+        for (size_t size = 0; size + offset <= buffer.size(); size += (size < 512 ? 1 : 509)) {
+            const char *data = buffer.data() + offset;
+            uint32_t init32 = rand::next_u32();
+            uint64_t init64 = rand::next_u64();
+            ASSERT_EQ(dsn::utils::crc32_calc_portable(data, size, init32),
+                      dsn::utils::crc32_calc(data, size, init32))
+                << "offset = " << offset << ", size = " << size;
+            ASSERT_EQ(dsn::utils::crc64_calc_portable(data, size, init64),
+                      dsn::utils::crc64_calc(data, size, init64))
+                << "offset = " << offset << ", size = " << size;
+        }
+    }
+}
+
 TEST(core, binary_io)
 {
     int value = 0xdeadbeef;
@@ -84,6 +107,37 @@ TEST(core, binary_io)
     EXPECT_TRUE(value3 == value);
 }
 
+TEST(core, binary_writer_nocopy)
+{
+    blob large = blob::create_from_bytes(std::string(binary_writer::nocopy_min_bytes, 'x'));
+    blob small = blob::create_from_bytes("small");
+
+    binary_writer writer;
+    writer.write(int32_t(1));
+    writer.write_nocopy(large);
+    writer.write_nocopy(small);
+    writer.write(int32_t(2));
+    ASSERT_EQ(sizeof(int32_t) * 2 + large.length() + small.length(), writer.total_size());
+
+    // only the large blob is linked into the buffers, the small one is copied
+    std::vector<blob> buffers;
+    writer.get_buffers(buffers);
+    ASSERT_EQ(3, buffers.size());
+    ASSERT_EQ(large.data(), buffers[1].data());
+
+    binary_reader reader(writer.get_buffer());
+    int32_t value = 0;
+    reader.read(value);
+    ASSERT_EQ(1, value);
+    blob content;
+    reader.read(content, large.length());
+    ASSERT_EQ(large.to_string(), content.to_string());
+    reader.read(content, small.length());
+    ASSERT_EQ("small", content.to_string());
+    reader.read(value);
+    ASSERT_EQ(2, value);
+}
+
 TEST(core, split_args)
 {
     std::string value = "a ,b, c ";
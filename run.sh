@@ -1481,6 +1481,13 @@ function usage_bench()
     echo "                             fillrandom_pegasus       --pegasus write N random values with random keys list"
     echo "                             readrandom_pegasus       --pegasus read N times with random keys list"
     echo "                             deleterandom_pegasus     --pegasus delete N entries with random keys list"
+    echo "                             fillseq_pegasus          --pegasus write N new keys in key id order"
+    echo "                             mixed_pegasus            --pegasus read or write N times by --read_percent"
+    echo "                             multiget_pegasus         --pegasus multi_get N hashkeys"
+    echo "                             batchget_pegasus         --pegasus get --batch_size keys concurrently N times"
+    echo "                             scan_pegasus             --pegasus scan N hashkeys"
+    echo "                             incr_pegasus             --pegasus incr N times"
+    echo "                             checkandset_pegasus      --pegasus check_and_set N times"
     echo "                             Comma-separated list of operations is going to run in the specified order."
     echo "                             default is 'fillrandom_pegasus,readrandom_pegasus,deleterandom_pegasus'"
     echo "   --num <num>               number of key/value pairs, default is 10000"
@@ -1492,6 +1499,13 @@ function usage_bench()
     echo "   --value_size <num>        value size in bytes, default is 100"
     echo "   --timeout <num>           timeout in milliseconds, default is 1000"
     echo "   --seed <num>              seed base for random number generator, When 0 it is specified as 1000. default is 1000"
+    echo "   --key_distribution <str>  distribution of accessed keys: uniform|zipfian|latest|hotspot, default is uniform."
+    echo "                             the non-uniform distributions access the keys written by fillseq_pegasus"
+    echo "   --read_percent <num>      percentage of reads in mixed_pegasus, default is 50"
+    echo "   --batch_size <num>        number of keys read by multiget/batchget/scan, default is 10"
+    echo "   --ops_per_sec <num>       total operations per second of all threads, 0 means no limit, default is 0"
+    echo "   --histogram_output <file> file to append the latency percentiles to, default is none"
+    echo "   --histogram_format <str>  format of the histogram output: csv|json, default is csv"
 }
 
 function fill_bench_config() {
@@ -1505,6 +1519,12 @@ function fill_bench_config() {
     sed -i "s/@VALUE_SIZE@/$VALUE_SIZE/g" ./config-bench.ini
     sed -i "s/@TIMEOUT_MS@/$TIMEOUT_MS/g" ./config-bench.ini
     sed -i "s/@SEED@/$SEED/g" ./config-bench.ini
+    sed -i "s/@KEY_DISTRIBUTION@/$KEY_DISTRIBUTION/g" ./config-bench.ini
+    sed -i "s/@READ_PERCENT@/$READ_PERCENT/g" ./config-bench.ini
+    sed -i "s/@BATCH_SIZE@/$BATCH_SIZE/g" ./config-bench.ini
+    sed -i "s/@OPS_PER_SEC@/$OPS_PER_SEC/g" ./config-bench.ini
+    sed -i "s|@HISTOGRAM_OUTPUT_FILE@|$HISTOGRAM_OUTPUT_FILE|g" ./config-bench.ini
+    sed -i "s/@HISTOGRAM_OUTPUT_FORMAT@/$HISTOGRAM_OUTPUT_FORMAT/g" ./config-bench.ini
 }
 
 function run_bench()
@@ -1519,6 +1539,12 @@ function run_bench()
     VALUE_SIZE=100
     TIMEOUT_MS=1000
     SEED=1000
+    KEY_DISTRIBUTION=uniform
+    READ_PERCENT=50
+    BATCH_SIZE=10
+    OPS_PER_SEC=0
+    HISTOGRAM_OUTPUT_FILE=""
+    HISTOGRAM_OUTPUT_FORMAT=csv
     while [[ $# > 0 ]]; do
         key="$1"
         case $key in
@@ -1566,6 +1592,30 @@ function run_bench()
                 SEED="$2"
                 shift
                 ;;
+            --key_distribution)
+                KEY_DISTRIBUTION="$2"
+                shift
+                ;;
+            --read_percent)
+                READ_PERCENT="$2"
+                shift
+                ;;
+            --batch_size)
+                BATCH_SIZE="$2"
+                shift
+                ;;
+            --ops_per_sec)
+                OPS_PER_SEC="$2"
+                shift
+                ;;
+            --histogram_output)
+                HISTOGRAM_OUTPUT_FILE="$2"
+                shift
+                ;;
+            --histogram_format)
+                HISTOGRAM_OUTPUT_FORMAT="$2"
+                shift
+                ;;
             *)
                 echo "ERROR: unknown option \"$key\""
                 echo
@@ -21,6 +21,7 @@
 
 #include <stdint.h>
 #include <array>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -89,6 +90,50 @@ pegasus_extract_user_data(uint32_t version, std::string &&raw_value, ::dsn::blob
     user_data.assign(std::move(buf), 0, static_cast<unsigned int>(view.length()));
 }
 
+/// Extracts user value from a raw rocksdb value without copying it.
+/// `holder` owns the memory referenced by `raw_value` (e.g. rocksdb::PinnableSlice
+/// objects pinning block cache entries), and `user_data` shares this ownership,
+/// so the memory is released only after the last reference to `user_data` is gone.
+/// \param user_data: the result.
+inline void pegasus_extract_user_data(uint32_t version,
+                                      const std::shared_ptr<void> &holder,
+                                      dsn::string_view raw_value,
+                                      ::dsn::blob &user_data)
+{
+    dassert_f(version <= PEGASUS_DATA_VERSION_MAX,
+              "data version({}) must be <= {}",
+              version,
+              PEGASUS_DATA_VERSION_MAX);
+
+    dsn::data_input input(raw_value);
+    input.skip(sizeof(uint32_t));
+    if (version == 1) {
+        input.skip(sizeof(uint64_t));
+    }
+    dsn::string_view view = input.read_str();
+
+    // aliasing constructor: points into the pinned memory, but shares `holder`'s ownership
+    std::shared_ptr<char> buf(holder, const_cast<char *>(view.data()));
+    user_data.assign(std::move(buf), 0, static_cast<unsigned int>(view.length()));
+}
+
+/// Returns the user value in a raw rocksdb value, which refers to the memory of `raw_value`.
+inline dsn::string_view pegasus_extract_user_data_view(uint32_t version,
+                                                       dsn::string_view raw_value)
+{
+    dassert_f(version <= PEGASUS_DATA_VERSION_MAX,
+              "data version({}) must be <= {}",
+              version,
+              PEGASUS_DATA_VERSION_MAX);
+
+    dsn::data_input input(raw_value);
+    input.skip(sizeof(uint32_t));
+    if (version == 1) {
+        input.skip(sizeof(uint64_t));
+    }
+    return input.read_str();
+}
+
 /// Extracts timetag from a v1 value.
 inline uint64_t pegasus_extract_timetag(int version, dsn::string_view value)
 {
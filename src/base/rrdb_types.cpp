@@ -4232,6 +4232,206 @@ void check_and_mutate_response::printTo(std::ostream &out) const
     out << ")";
 }
 
+geo_scan_filter::~geo_scan_filter() throw() {}
+
+void geo_scan_filter::__set_center_lat(const double val) { this->center_lat = val; }
+
+void geo_scan_filter::__set_center_lng(const double val) { this->center_lng = val; }
+
+void geo_scan_filter::__set_radius_m(const double val) { this->radius_m = val; }
+
+void geo_scan_filter::__set_latitude_index(const int32_t val) { this->latitude_index = val; }
+
+void geo_scan_filter::__set_longitude_index(const int32_t val) { this->longitude_index = val; }
+
+void geo_scan_filter::__set_limit(const int32_t val) { this->limit = val; }
+
+uint32_t geo_scan_filter::read(::apache::thrift::protocol::TProtocol *iprot)
+{
+
+    apache::thrift::protocol::TInputRecursionTracker tracker(*iprot);
+    uint32_t xfer = 0;
+    std::string fname;
+    ::apache::thrift::protocol::TType ftype;
+    int16_t fid;
+
+    xfer += iprot->readStructBegin(fname);
+
+    using ::apache::thrift::protocol::TProtocolException;
+
+    while (true) {
+        xfer += iprot->readFieldBegin(fname, ftype, fid);
+        if (ftype == ::apache::thrift::protocol::T_STOP) {
+            break;
+        }
+        switch (fid) {
+        case 1:
+            if (ftype == ::apache::thrift::protocol::T_DOUBLE) {
+                xfer += iprot->readDouble(this->center_lat);
+                this->__isset.center_lat = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 2:
+            if (ftype == ::apache::thrift::protocol::T_DOUBLE) {
+                xfer += iprot->readDouble(this->center_lng);
+                this->__isset.center_lng = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 3:
+            if (ftype == ::apache::thrift::protocol::T_DOUBLE) {
+                xfer += iprot->readDouble(this->radius_m);
+                this->__isset.radius_m = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 4:
+            if (ftype == ::apache::thrift::protocol::T_I32) {
+                xfer += iprot->readI32(this->latitude_index);
+                this->__isset.latitude_index = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 5:
+            if (ftype == ::apache::thrift::protocol::T_I32) {
+                xfer += iprot->readI32(this->longitude_index);
+                this->__isset.longitude_index = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 6:
+            if (ftype == ::apache::thrift::protocol::T_I32) {
+                xfer += iprot->readI32(this->limit);
+                this->__isset.limit = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        default:
+            xfer += iprot->skip(ftype);
+            break;
+        }
+        xfer += iprot->readFieldEnd();
+    }
+
+    xfer += iprot->readStructEnd();
+
+    return xfer;
+}
+
+uint32_t geo_scan_filter::write(::apache::thrift::protocol::TProtocol *oprot) const
+{
+    uint32_t xfer = 0;
+    apache::thrift::protocol::TOutputRecursionTracker tracker(*oprot);
+    xfer += oprot->writeStructBegin("geo_scan_filter");
+
+    xfer += oprot->writeFieldBegin("center_lat", ::apache::thrift::protocol::T_DOUBLE, 1);
+    xfer += oprot->writeDouble(this->center_lat);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("center_lng", ::apache::thrift::protocol::T_DOUBLE, 2);
+    xfer += oprot->writeDouble(this->center_lng);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("radius_m", ::apache::thrift::protocol::T_DOUBLE, 3);
+    xfer += oprot->writeDouble(this->radius_m);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("latitude_index", ::apache::thrift::protocol::T_I32, 4);
+    xfer += oprot->writeI32(this->latitude_index);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("longitude_index", ::apache::thrift::protocol::T_I32, 5);
+    xfer += oprot->writeI32(this->longitude_index);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("limit", ::apache::thrift::protocol::T_I32, 6);
+    xfer += oprot->writeI32(this->limit);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldStop();
+    xfer += oprot->writeStructEnd();
+    return xfer;
+}
+
+void swap(geo_scan_filter &a, geo_scan_filter &b)
+{
+    using ::std::swap;
+    swap(a.center_lat, b.center_lat);
+    swap(a.center_lng, b.center_lng);
+    swap(a.radius_m, b.radius_m);
+    swap(a.latitude_index, b.latitude_index);
+    swap(a.longitude_index, b.longitude_index);
+    swap(a.limit, b.limit);
+    swap(a.__isset, b.__isset);
+}
+
+geo_scan_filter::geo_scan_filter(const geo_scan_filter &other172)
+{
+    center_lat = other172.center_lat;
+    center_lng = other172.center_lng;
+    radius_m = other172.radius_m;
+    latitude_index = other172.latitude_index;
+    longitude_index = other172.longitude_index;
+    limit = other172.limit;
+    __isset = other172.__isset;
+}
+geo_scan_filter::geo_scan_filter(geo_scan_filter &&other173)
+{
+    center_lat = std::move(other173.center_lat);
+    center_lng = std::move(other173.center_lng);
+    radius_m = std::move(other173.radius_m);
+    latitude_index = std::move(other173.latitude_index);
+    longitude_index = std::move(other173.longitude_index);
+    limit = std::move(other173.limit);
+    __isset = std::move(other173.__isset);
+}
+geo_scan_filter &geo_scan_filter::operator=(const geo_scan_filter &other174)
+{
+    center_lat = other174.center_lat;
+    center_lng = other174.center_lng;
+    radius_m = other174.radius_m;
+    latitude_index = other174.latitude_index;
+    longitude_index = other174.longitude_index;
+    limit = other174.limit;
+    __isset = other174.__isset;
+    return *this;
+}
+geo_scan_filter &geo_scan_filter::operator=(geo_scan_filter &&other175)
+{
+    center_lat = std::move(other175.center_lat);
+    center_lng = std::move(other175.center_lng);
+    radius_m = std::move(other175.radius_m);
+    latitude_index = std::move(other175.latitude_index);
+    longitude_index = std::move(other175.longitude_index);
+    limit = std::move(other175.limit);
+    __isset = std::move(other175.__isset);
+    return *this;
+}
+void geo_scan_filter::printTo(std::ostream &out) const
+{
+    using ::apache::thrift::to_string;
+    out << "geo_scan_filter(";
+    out << "center_lat=" << to_string(center_lat);
+    out << ", "
+        << "center_lng=" << to_string(center_lng);
+    out << ", "
+        << "radius_m=" << to_string(radius_m);
+    out << ", "
+        << "latitude_index=" << to_string(latitude_index);
+    out << ", "
+        << "longitude_index=" << to_string(longitude_index);
+    out << ", "
+        << "limit=" << to_string(limit);
+    out << ")";
+}
+
 get_scanner_request::~get_scanner_request() throw() {}
 
 void get_scanner_request::__set_start_key(const ::dsn::blob &val) { this->start_key = val; }
@@ -4284,6 +4484,12 @@ void get_scanner_request::__set_full_scan(const bool val)
     __isset.full_scan = true;
 }
 
+void get_scanner_request::__set_geo_filter(const geo_scan_filter &val)
+{
+    this->geo_filter = val;
+    __isset.geo_filter = true;
+}
+
 uint32_t get_scanner_request::read(::apache::thrift::protocol::TProtocol *iprot)
 {
 
@@ -4411,6 +4617,14 @@ uint32_t get_scanner_request::read(::apache::thrift::protocol::TProtocol *iprot)
                 xfer += iprot->skip(ftype);
             }
             break;
+        case 14:
+            if (ftype == ::apache::thrift::protocol::T_STRUCT) {
+                xfer += this->geo_filter.read(iprot);
+                this->__isset.geo_filter = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
         default:
             xfer += iprot->skip(ftype);
             break;
@@ -4487,6 +4701,11 @@ uint32_t get_scanner_request::write(::apache::thrift::protocol::TProtocol *oprot
         xfer += oprot->writeBool(this->full_scan);
         xfer += oprot->writeFieldEnd();
     }
+    if (this->__isset.geo_filter) {
+        xfer += oprot->writeFieldBegin("geo_filter", ::apache::thrift::protocol::T_STRUCT, 14);
+        xfer += this->geo_filter.write(oprot);
+        xfer += oprot->writeFieldEnd();
+    }
     xfer += oprot->writeFieldStop();
     xfer += oprot->writeStructEnd();
     return xfer;
@@ -4508,6 +4727,7 @@ void swap(get_scanner_request &a, get_scanner_request &b)
     swap(a.validate_partition_hash, b.validate_partition_hash);
     swap(a.return_expire_ts, b.return_expire_ts);
     swap(a.full_scan, b.full_scan);
+    swap(a.geo_filter, b.geo_filter);
     swap(a.__isset, b.__isset);
 }
 
@@ -4526,6 +4746,7 @@ get_scanner_request::get_scanner_request(const get_scanner_request &other136)
     validate_partition_hash = other136.validate_partition_hash;
     return_expire_ts = other136.return_expire_ts;
     full_scan = other136.full_scan;
+    geo_filter = other136.geo_filter;
     __isset = other136.__isset;
 }
 get_scanner_request::get_scanner_request(get_scanner_request &&other137)
@@ -4543,6 +4764,7 @@ get_scanner_request::get_scanner_request(get_scanner_request &&other137)
     validate_partition_hash = std::move(other137.validate_partition_hash);
     return_expire_ts = std::move(other137.return_expire_ts);
     full_scan = std::move(other137.full_scan);
+    geo_filter = std::move(other137.geo_filter);
     __isset = std::move(other137.__isset);
 }
 get_scanner_request &get_scanner_request::operator=(const get_scanner_request &other138)
@@ -4560,6 +4782,7 @@ get_scanner_request &get_scanner_request::operator=(const get_scanner_request &o
     validate_partition_hash = other138.validate_partition_hash;
     return_expire_ts = other138.return_expire_ts;
     full_scan = other138.full_scan;
+    geo_filter = other138.geo_filter;
     __isset = other138.__isset;
     return *this;
 }
@@ -4578,6 +4801,7 @@ get_scanner_request &get_scanner_request::operator=(get_scanner_request &&other1
     validate_partition_hash = std::move(other139.validate_partition_hash);
     return_expire_ts = std::move(other139.return_expire_ts);
     full_scan = std::move(other139.full_scan);
+    geo_filter = std::move(other139.geo_filter);
     __isset = std::move(other139.__isset);
     return *this;
 }
@@ -4614,6 +4838,9 @@ void get_scanner_request::printTo(std::ostream &out) const
     out << ", "
         << "full_scan=";
     (__isset.full_scan ? (out << to_string(full_scan)) : (out << "<null>"));
+    out << ", "
+        << "geo_filter=";
+    (__isset.geo_filter ? (out << to_string(geo_filter)) : (out << "<null>"));
     out << ")";
 }
 
@@ -230,6 +230,16 @@ void pegasus_client_impl::pegasus_scanner_impl::_start_scan()
     req.__set_validate_partition_hash(_validate_partition_hash);
     req.__set_return_expire_ts(_options.return_expire_ts);
     req.__set_full_scan(_full_scan);
+    if (_options.geo_filter.enabled()) {
+        ::dsn::apps::geo_scan_filter geo_filter;
+        geo_filter.center_lat = _options.geo_filter.center_lat;
+        geo_filter.center_lng = _options.geo_filter.center_lng;
+        geo_filter.radius_m = _options.geo_filter.radius_m;
+        geo_filter.latitude_index = _options.geo_filter.latitude_index;
+        geo_filter.longitude_index = _options.geo_filter.longitude_index;
+        geo_filter.limit = _options.geo_filter.limit;
+        req.__set_geo_filter(geo_filter);
+    }
 
     dassert(!_rpc_started, "");
     _rpc_started = true;
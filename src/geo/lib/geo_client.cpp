@@ -19,6 +19,10 @@
 
 #include "geo_client.h"
 
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+
 #include <s2/s2earth.h>
 #include <s2/s2region_coverer.h>
 #include <s2/s2cap.h>
@@ -28,26 +32,11 @@
 
 #include "base/pegasus_key_schema.h"
 #include "base/pegasus_utils.h"
+#include "geo_result_merger.h"
 
 namespace pegasus {
 namespace geo {
 
-struct SearchResultNearer
-{
-    inline bool operator()(const SearchResult &l, const SearchResult &r)
-    {
-        return l.distance < r.distance;
-    }
-};
-
-struct SearchResultFarther
-{
-    inline bool operator()(const SearchResult &l, const SearchResult &r)
-    {
-        return l.distance > r.distance;
-    }
-};
-
 geo_client::geo_client(const char *config_file,
                        const char *cluster_name,
                        const char *common_app_name,
@@ -73,14 +62,28 @@ geo_client::geo_client(const char *config_file,
               _min_level,
               _max_level);
 
-    uint32_t latitude_index = (uint32_t)dsn_config_get_value_uint64(
+    _latitude_index = (uint32_t)dsn_config_get_value_uint64(
         "geo_client.lib", "latitude_index", 5, "latitude index in value");
 
-    uint32_t longitude_index = (uint32_t)dsn_config_get_value_uint64(
+    _longitude_index = (uint32_t)dsn_config_get_value_uint64(
         "geo_client.lib", "longitude_index", 4, "longitude index in value");
 
-    dsn::error_s s = _codec.set_latlng_indices(latitude_index, longitude_index);
-    dassert_f(s.is_ok(), "set_latlng_indices({}, {}) failed", latitude_index, longitude_index);
+    dsn::error_s s = _codec.set_latlng_indices(_latitude_index, _longitude_index);
+    dassert_f(s.is_ok(), "set_latlng_indices({}, {}) failed", _latitude_index, _longitude_index);
+
+    _server_side_filter = dsn_config_get_value_bool(
+        "geo_client.lib",
+        "server_side_filter",
+        true,
+        "whether to filter the points out of the search area on the server, which requires the "
+        "servers to support geo_scan_filter, or the filter is just ignored");
+
+    _max_concurrent_scans = (int)dsn_config_get_value_uint64(
+        "geo_client.lib",
+        "max_concurrent_scans",
+        8,
+        "max count of concurrent scans of a search with count limit in asc or random order");
+    dassert_f(_max_concurrent_scans > 0, "max_concurrent_scans must be positive");
 }
 
 dsn::error_s geo_client::set_max_level(int level)
@@ -535,10 +538,10 @@ void geo_client::async_search_radial(const S2LatLng &latlng,
                                 count,
                                 sort_type,
                                 timeout_ms,
-                                [ this, count, sort_type, cb = std::move(callback) ](
-                                    std::list<std::list<SearchResult>> && results_) {
-                                    std::list<SearchResult> result;
-                                    normalize_result(std::move(results_), count, sort_type, result);
+                                [cb = std::move(callback)](std::vector<SearchResult> &&results_) {
+                                    std::list<SearchResult> result(
+                                        std::make_move_iterator(results_.begin()),
+                                        std::make_move_iterator(results_.end()));
                                     cb(PERR_OK, std::move(result));
                                 });
 }
@@ -556,6 +559,49 @@ void geo_client::gen_cells_covered_by_cap(const S2Cap &cap, S2CellUnion &cids)
     cids = rc.GetCovering(cap);
 }
 
+struct geo_client::search_context
+{
+    search_context(std::shared_ptr<S2Cap> cap_ptr_,
+                   int count,
+                   SortType sort_type,
+                   int timeout_ms_,
+                   scan_all_area_callback_t &&callback_)
+        : cap_ptr(std::move(cap_ptr_)),
+          center(cap_ptr->center()),
+          radius_m(S2Earth::ToMeters(cap_ptr->radius())),
+          // the data in an area is scanned in the order of cell id rather than distance, so all
+          // of it is needed to sort
+          single_scan_count(sort_type == SortType::random ? count : -1),
+          // all the scans of the search share one deadline
+          deadline_ms(dsn_now_ms() + timeout_ms_),
+          merger(count, sort_type),
+          callback(std::move(callback_))
+    {
+    }
+
+    const std::shared_ptr<S2Cap> cap_ptr;
+    const S2LatLng center;
+    const double radius_m;
+    const int single_scan_count;
+    const uint64_t deadline_ms;
+    std::vector<scan_area> areas;
+    geo_result_merger merger;
+    scan_all_area_callback_t callback;
+
+    std::mutex lock;
+    // protected by `lock`
+    size_t next_area = 0;
+    int running_scans = 0;
+    bool finished = false;
+
+    // the time left before the deadline, 0 if it has passed
+    int remaining_ms() const
+    {
+        uint64_t now_ms = dsn_now_ms();
+        return now_ms < deadline_ms ? (int)(deadline_ms - now_ms) : 0;
+    }
+};
+
 void geo_client::async_get_result_from_cells(const S2CellUnion &cids,
                                              std::shared_ptr<S2Cap> cap_ptr,
                                              int count,
@@ -563,124 +609,116 @@ void geo_client::async_get_result_from_cells(const S2CellUnion &cids,
                                              int timeout_ms,
                                              scan_all_area_callback_t &&callback)
 {
-    int single_scan_count = count;
-    if (sort_type == SortType::asc || sort_type == SortType::desc) {
-        single_scan_count = -1; // scan all data to make full sort
+    auto ctx = std::make_shared<search_context>(
+        std::move(cap_ptr), count, sort_type, timeout_ms, std::move(callback));
+    gen_scan_areas(cids, *ctx->cap_ptr, ctx->areas);
+
+    // all areas are needed without count limit or in desc order, so scan them all at once
+    size_t concurrency = ctx->areas.size();
+    if (count > 0 && sort_type != SortType::desc) {
+        concurrency = std::min(concurrency, (size_t)_max_concurrent_scans);
     }
+    concurrency = std::max(concurrency, (size_t)1);
+    for (size_t i = 0; i < concurrency; ++i) {
+        scan_next_area(ctx);
+    }
+}
 
-    // scan all cell ids
-    std::shared_ptr<std::list<std::list<SearchResult>>> results =
-        std::make_shared<std::list<std::list<SearchResult>>>();
-    std::shared_ptr<std::atomic<bool>> send_finish = std::make_shared<std::atomic<bool>>(false);
-    std::shared_ptr<std::atomic<int>> scan_count = std::make_shared<std::atomic<int>>(0);
-    auto single_scan_finish_callback =
-        [ send_finish, scan_count, results, cb = std::move(callback) ]()
-    {
-        // NOTE: make sure fetch_sub is at first of the if expression to make it always execute
-        if (scan_count->fetch_sub(1) == 1 && send_finish->load()) {
-            cb(std::move(*results.get()));
-        }
+void geo_client::gen_scan_areas(const S2CellUnion &cids,
+                                const S2Cap &cap,
+                                std::vector<scan_area> &areas)
+{
+    S2Point center = cap.center();
+    auto min_distance_m = [&center](const S2CellId &cid) {
+        return S2Earth::ToMeters(S1Angle(S2Cell(cid).GetDistance(center)));
     };
 
     for (const auto &cid : cids) {
-        if (cap_ptr->Contains(S2Cell(cid))) {
+        if (cap.Contains(S2Cell(cid))) {
             // for the full contained cell, scan all data in this cell(which is at the `_min_level`)
-            results->emplace_back(std::list<SearchResult>());
-            scan_count->fetch_add(1);
-            start_scan(cid.ToString(),
-                       "",
-                       "",
-                       cap_ptr,
-                       single_scan_count,
-                       timeout_ms,
-                       single_scan_finish_callback,
-                       results->back());
-        } else {
-            // for the partial contained cell, scan cells covered by the cap at the `_max_level`
-            // which is more accurate than the ones at `_min_level`, but it will cost more time on
-            // calculating here.
-            std::string hash_key = cid.parent(_min_level).ToString();
-            std::pair<std::string, std::string> start_stop_sort_keys;
-            S2CellId pre;
-            // traverse all sub cell ids of `cid` on `_max_level` along the Hilbert curve, to find
-            // the needed ones.
-            for (S2CellId cur = cid.child_begin(_max_level); cur != cid.child_end(_max_level);
-                 cur = cur.next()) {
-                if (cap_ptr->MayIntersect(S2Cell(cur))) {
-                    // only cells whose any vertex is contained by the cap is needed
-                    if (!pre.is_valid()) {
-                        // `cur` is the very first cell in Hilbert curve contained by the cap
-                        pre = cur;
-                        start_stop_sort_keys.first = gen_start_sort_key(pre, hash_key);
-                    } else {
-                        if (pre.next() != cur) {
-                            // `pre` is the last cell in Hilbert curve contained by the cap
-                            // `cur` is a new start cell in Hilbert curve contained by the cap
-                            start_stop_sort_keys.second = gen_stop_sort_key(pre, hash_key);
-                            results->emplace_back(std::list<SearchResult>());
-                            scan_count->fetch_add(1);
-                            start_scan(hash_key,
-                                       std::move(start_stop_sort_keys.first),
-                                       std::move(start_stop_sort_keys.second),
-                                       cap_ptr,
-                                       single_scan_count,
-                                       timeout_ms,
-                                       single_scan_finish_callback,
-                                       results->back());
-
-                            start_stop_sort_keys.first = gen_start_sort_key(cur, hash_key);
-                            start_stop_sort_keys.second.clear();
-                        }
-                        pre = cur;
-                    }
-                }
+            areas.push_back({cid.ToString(), "", "", min_distance_m(cid)});
+            continue;
+        }
+
+        // for the partial contained cell, scan cells covered by the cap at the `_max_level`
+        // which is more accurate than the ones at `_min_level`, but it will cost more time on
+        // calculating here.
+        std::string hash_key = cid.parent(_min_level).ToString();
+        S2CellId pre;
+        scan_area area;
+        // traverse all sub cell ids of `cid` on `_max_level` along the Hilbert curve, to find
+        // the needed ones, the adjacent ones are merged into one area.
+        for (S2CellId cur = cid.child_begin(_max_level); cur != cid.child_end(_max_level);
+             cur = cur.next()) {
+            if (!cap.MayIntersect(S2Cell(cur))) {
+                continue;
             }
 
-            dassert(!start_stop_sort_keys.first.empty(), "");
-            // the last sub slice of current `cid` on `_max_level` in Hilbert curve covered by `cap`
-            if (start_stop_sort_keys.second.empty()) {
-                start_stop_sort_keys.second = gen_stop_sort_key(pre, hash_key);
-                results->emplace_back(std::list<SearchResult>());
-                scan_count->fetch_add(1);
-                start_scan(hash_key,
-                           std::move(start_stop_sort_keys.first),
-                           std::move(start_stop_sort_keys.second),
-                           cap_ptr,
-                           single_scan_count,
-                           timeout_ms,
-                           single_scan_finish_callback,
-                           results->back());
+            if (pre.is_valid() && pre.next() != cur) {
+                // `pre` is the last cell of the area, `cur` starts a new one
+                area.stop_sort_key = gen_stop_sort_key(pre, hash_key);
+                areas.emplace_back(std::move(area));
+                pre = S2CellId();
+            }
+            if (!pre.is_valid()) {
+                area.hash_key = hash_key;
+                area.start_sort_key = gen_start_sort_key(cur, hash_key);
+                area.min_distance_m = min_distance_m(cur);
+            } else {
+                area.min_distance_m = std::min(area.min_distance_m, min_distance_m(cur));
             }
+            pre = cur;
         }
+
+        dassert(pre.is_valid(), "");
+        // the last area of current `cid`
+        area.stop_sort_key = gen_stop_sort_key(pre, hash_key);
+        areas.emplace_back(std::move(area));
     }
 
-    // when all scan rpc have received before send_finish is set to true, the callback will never be
-    // called, so we add 2 lines tricky code as follows
-    scan_count->fetch_add(1);
-    send_finish->store(true);
-    single_scan_finish_callback();
+    std::stable_sort(areas.begin(), areas.end(), [](const scan_area &l, const scan_area &r) {
+        return l.min_distance_m < r.min_distance_m;
+    });
 }
 
-void geo_client::normalize_result(std::list<std::list<SearchResult>> &&results,
-                                  int count,
-                                  SortType sort_type,
-                                  std::list<SearchResult> &result)
+void geo_client::scan_next_area(std::shared_ptr<search_context> ctx)
 {
-    result.clear();
-    for (auto &r : results) {
-        result.splice(result.end(), r);
-        if (sort_type == SortType::random && count > 0 && result.size() >= count) {
-            break;
+    const scan_area *area = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(ctx->lock);
+        if (ctx->next_area < ctx->areas.size() &&
+            ctx->merger.can_skip(ctx->areas[ctx->next_area].min_distance_m)) {
+            // the areas are sorted by distance, so the rest can't contain better results either
+            ctx->next_area = ctx->areas.size();
+        }
+        if (ctx->next_area < ctx->areas.size() && ctx->remaining_ms() == 0) {
+            dwarn_f("search timeout, skip the rest {} areas",
+                    ctx->areas.size() - ctx->next_area);
+            ctx->next_area = ctx->areas.size();
+        }
+
+        if (ctx->next_area < ctx->areas.size()) {
+            area = &ctx->areas[ctx->next_area++];
+            ctx->running_scans++;
+        } else if (ctx->running_scans > 0 || ctx->finished) {
+            return;
+        } else {
+            ctx->finished = true;
         }
     }
 
-    if (sort_type == SortType::asc) {
-        result = utils::top_n<SearchResult, SearchResultNearer>(result, count).to();
-    } else if (sort_type == SortType::desc) {
-        result = utils::top_n<SearchResult, SearchResultFarther>(result, count).to();
-    } else if (count > 0 && result.size() > count) {
-        result.resize((size_t)count);
+    if (area == nullptr) {
+        ctx->callback(ctx->merger.finish());
+        return;
     }
+
+    start_scan(ctx, *area, [this, ctx]() {
+        {
+            std::lock_guard<std::mutex> guard(ctx->lock);
+            ctx->running_scans--;
+        }
+        scan_next_area(ctx);
+    });
 }
 
 bool geo_client::generate_geo_keys(const std::string &hash_key,
@@ -819,30 +857,35 @@ void geo_client::async_del_geo_data(const std::string &geo_hash_key,
         timeout_ms);
 }
 
-void geo_client::start_scan(const std::string &hash_key,
-                            std::string &&start_sort_key,
-                            std::string &&stop_sort_key,
-                            std::shared_ptr<S2Cap> cap_ptr,
-                            int count,
-                            int timeout_ms,
-                            scan_one_area_callback_t &&callback,
-                            std::list<SearchResult> &result)
+void geo_client::start_scan(std::shared_ptr<search_context> ctx,
+                            const scan_area &area,
+                            scan_one_area_callback_t &&callback)
 {
     pegasus_client::scan_options options;
     options.start_inclusive = true;
     options.stop_inclusive = true;
     options.batch_size = 1000;
-    options.timeout_ms = timeout_ms;
+    options.timeout_ms = std::max(ctx->remaining_ms(), 1);
+    if (_server_side_filter) {
+        // the distance is checked again in do_scan, which also makes it work with the servers
+        // ignoring the filter
+        options.geo_filter.center_lat = ctx->center.lat().degrees();
+        options.geo_filter.center_lng = ctx->center.lng().degrees();
+        options.geo_filter.radius_m = ctx->radius_m;
+        options.geo_filter.latitude_index = _latitude_index;
+        options.geo_filter.longitude_index = _longitude_index;
+        options.geo_filter.limit = ctx->single_scan_count;
+    }
 
     _geo_data_client->async_get_scanner(
-        hash_key,
-        start_sort_key,
-        stop_sort_key,
+        area.hash_key,
+        area.start_sort_key,
+        area.stop_sort_key,
         options,
-        [ this, cap_ptr, count, cb = std::move(callback), &result ](
+        [ this, ctx, &area, cb = std::move(callback) ](
             int error_code, pegasus_client::pegasus_scanner *hash_scanner) mutable {
             if (error_code == PERR_OK) {
-                do_scan(hash_scanner->get_smart_wrapper(), cap_ptr, count, std::move(cb), result);
+                do_scan(hash_scanner->get_smart_wrapper(), ctx, area, std::move(cb));
             } else {
                 cb();
             }
@@ -850,13 +893,12 @@ void geo_client::start_scan(const std::string &hash_key,
 }
 
 void geo_client::do_scan(pegasus_client::pegasus_scanner_wrapper scanner_wrapper,
-                         std::shared_ptr<S2Cap> cap_ptr,
-                         int count,
-                         scan_one_area_callback_t &&callback,
-                         std::list<SearchResult> &result)
+                         std::shared_ptr<search_context> ctx,
+                         const scan_area &area,
+                         scan_one_area_callback_t &&callback)
 {
     scanner_wrapper->async_next(
-        [ this, cap_ptr, count, scanner_wrapper, cb = std::move(callback), &result ](
+        [ this, ctx, &area, scanner_wrapper, cb = std::move(callback) ](
             int ret,
             std::string &&geo_hash_key,
             std::string &&geo_sort_key,
@@ -881,8 +923,8 @@ void geo_client::do_scan(pegasus_client::pegasus_scanner_wrapper scanner_wrapper
                 return;
             }
 
-            double distance = S2Earth::GetDistanceMeters(S2LatLng(cap_ptr->center()), latlng);
-            if (distance <= S2Earth::ToMeters(cap_ptr->radius())) {
+            double distance = S2Earth::GetDistanceMeters(ctx->center, latlng);
+            if (distance <= ctx->radius_m) {
                 std::string origin_hash_key, origin_sort_key;
                 if (!restore_origin_keys(geo_sort_key, origin_hash_key, origin_sort_key)) {
                     derror_f("restore_origin_keys failed. geo_sort_key={}", geo_sort_key);
@@ -890,20 +932,21 @@ void geo_client::do_scan(pegasus_client::pegasus_scanner_wrapper scanner_wrapper
                     return;
                 }
 
-                result.emplace_back(SearchResult(latlng.lat().degrees(),
-                                                 latlng.lng().degrees(),
-                                                 distance,
-                                                 std::move(origin_hash_key),
-                                                 std::move(origin_sort_key),
-                                                 std::move(value)));
+                ctx->merger.add(SearchResult(latlng.lat().degrees(),
+                                             latlng.lng().degrees(),
+                                             distance,
+                                             std::move(origin_hash_key),
+                                             std::move(origin_sort_key),
+                                             std::move(value)));
             }
 
-            if (count != -1 && result.size() >= count) {
+            // stop once the rest of this area can't be in the result, or the search times out
+            if (ctx->merger.can_skip(area.min_distance_m) || ctx->remaining_ms() == 0) {
                 cb();
                 return;
             }
 
-            do_scan(scanner_wrapper, cap_ptr, count, std::move(cb), result);
+            do_scan(scanner_wrapper, ctx, area, std::move(cb));
         });
 }
 
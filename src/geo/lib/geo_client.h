@@ -20,6 +20,7 @@
 #pragma once
 
 #include <sstream>
+#include <vector>
 #include <s2/s2latlng_rect.h>
 #include <s2/s2cell_union.h>
 #include <s2/util/units/length-units.h>
@@ -378,8 +379,7 @@ private:
 
     using update_callback_t = std::function<void(
         int error_code, pegasus_client::internal_info &&info, DataType data_type)>;
-    using scan_all_area_callback_t =
-        std::function<void(std::list<std::list<SearchResult>> &&results)>;
+    using scan_all_area_callback_t = std::function<void(std::vector<SearchResult> &&results)>;
     using scan_one_area_callback_t = std::function<void()>;
 
     // generate hash_key and sort_key in geo database from hash_key and sort_key in common data
@@ -435,7 +435,21 @@ private:
     // generate cell ids covered by the cap on a pre-defined level
     void gen_cells_covered_by_cap(const S2Cap &cap, S2CellUnion &cids);
 
-    // search data covered by `cap` in all `cids`
+    // a range of sort keys under a hash key in the geo app to scan
+    struct scan_area
+    {
+        std::string hash_key;
+        std::string start_sort_key;
+        std::string stop_sort_key;
+        // min distance from the area to the search center, in meter
+        double min_distance_m;
+    };
+
+    // the state of a search shared by all its scans, defined in geo_client.cpp
+    struct search_context;
+
+    // search data covered by `cap` in all `cids`, the results are limited by count and sorted
+    // by sort type
     void async_get_result_from_cells(const S2CellUnion &cids,
                                      std::shared_ptr<S2Cap> cap_ptr,
                                      int count,
@@ -443,11 +457,12 @@ private:
                                      int timeout_ms,
                                      scan_all_area_callback_t &&callback);
 
-    // normalize the result by count, sort type, ...
-    void normalize_result(std::list<std::list<SearchResult>> &&results,
-                          int count,
-                          SortType sort_type,
-                          std::list<SearchResult> &result);
+    // generate the areas to scan for `cap` in all `cids`, nearest first
+    void gen_scan_areas(const S2CellUnion &cids, const S2Cap &cap, std::vector<scan_area> &areas);
+
+    // start to scan the next area of the search which can't be skipped, or finish the search
+    // if there is none
+    void scan_next_area(std::shared_ptr<search_context> ctx);
 
     // generate sort key of `max_level_cid` under `hash_key`
     std::string gen_sort_key(const S2CellId &max_level_cid, const std::string &hash_key);
@@ -456,20 +471,14 @@ private:
     // generate stop sort key of `max_level_cid` under `hash_key`
     std::string gen_stop_sort_key(const S2CellId &max_level_cid, const std::string &hash_key);
 
-    void start_scan(const std::string &hash_key,
-                    std::string &&start_sort_key,
-                    std::string &&stop_sort_key,
-                    std::shared_ptr<S2Cap> cap_ptr,
-                    int count,
-                    int timeout_ms,
-                    scan_one_area_callback_t &&callback,
-                    std::list<SearchResult> &result);
+    void start_scan(std::shared_ptr<search_context> ctx,
+                    const scan_area &area,
+                    scan_one_area_callback_t &&callback);
 
     void do_scan(pegasus_client::pegasus_scanner_wrapper scanner_wrapper,
-                 std::shared_ptr<S2Cap> cap_ptr,
-                 int count,
-                 scan_one_area_callback_t &&callback,
-                 std::list<SearchResult> &result);
+                 std::shared_ptr<search_context> ctx,
+                 const scan_area &area,
+                 scan_one_area_callback_t &&callback);
 
 private:
     // cell id at this level is the hash-key in pegasus
@@ -486,6 +495,14 @@ private:
     dsn::task_tracker _tracker;
 
     latlng_codec _codec;
+    uint32_t _latitude_index = 5;
+    uint32_t _longitude_index = 4;
+    // whether to filter the scanned points by the search area on the server side
+    bool _server_side_filter = true;
+    // max count of concurrent scans of a search with count limit in asc or random order, the
+    // scans are started nearest first, so that the farther ones can be skipped once enough
+    // results are found
+    int _max_concurrent_scans = 8;
     pegasus_client *_common_data_client = nullptr;
     pegasus_client *_geo_data_client = nullptr;
 };
@@ -0,0 +1,120 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include "geo_client.h"
+
+namespace pegasus {
+namespace geo {
+
+// Merges the results of the concurrent scans of a radius search as they arrive.
+//
+// With a count limit, a bounded heap keeps only the best `count` results for the sort type, so
+// that the K-th best distance is known during the search, and the areas which can't contain
+// better results can be skipped.
+class geo_result_merger
+{
+public:
+    geo_result_merger(int count, geo_client::SortType sort_type)
+        : _count(count), _sort_type(sort_type)
+    {
+        if (_count > 0) {
+            _results.reserve(_count);
+        }
+    }
+
+    // Adds a result, thread-safe.
+    void add(SearchResult &&result)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (_count <= 0 || _results.size() < static_cast<size_t>(_count)) {
+            _results.emplace_back(std::move(result));
+            if (_count > 0 && is_sorted()) {
+                std::push_heap(_results.begin(), _results.end(), comparator());
+            }
+            return;
+        }
+
+        // the heap is full, its front is the worst one of the kept results
+        if (is_sorted() && comparator()(result, _results.front())) {
+            std::pop_heap(_results.begin(), _results.end(), comparator());
+            _results.back() = std::move(result);
+            std::push_heap(_results.begin(), _results.end(), comparator());
+        }
+    }
+
+    // Returns true if the results at least `min_distance_m` away can't be in the final result
+    // any more, thread-safe.
+    bool can_skip(double min_distance_m) const
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (_count <= 0 || _results.size() < static_cast<size_t>(_count)) {
+            return false;
+        }
+        switch (_sort_type) {
+        case geo_client::SortType::random:
+            return true;
+        case geo_client::SortType::asc:
+            return min_distance_m > _results.front().distance;
+        default:
+            return false;
+        }
+    }
+
+    // Returns the final results, must be called after all results are added.
+    std::vector<SearchResult> finish()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (is_sorted()) {
+            if (_count > 0) {
+                std::sort_heap(_results.begin(), _results.end(), comparator());
+            } else {
+                std::stable_sort(_results.begin(), _results.end(), comparator());
+            }
+        }
+        return std::move(_results);
+    }
+
+private:
+    struct comparator_t
+    {
+        bool nearer;
+        bool operator()(const SearchResult &l, const SearchResult &r) const
+        {
+            return nearer ? l.distance < r.distance : l.distance > r.distance;
+        }
+    };
+
+    bool is_sorted() const { return _sort_type != geo_client::SortType::random; }
+    comparator_t comparator() const { return {_sort_type == geo_client::SortType::asc}; }
+
+    const int _count;
+    const geo_client::SortType _sort_type;
+
+    mutable std::mutex _lock;
+    std::vector<SearchResult> _results;
+};
+
+} // namespace geo
+} // namespace pegasus
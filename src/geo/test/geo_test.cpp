@@ -18,6 +18,7 @@
  */
 
 #include "geo/lib/geo_client.h"
+#include "geo/lib/geo_result_merger.h"
 #include <gtest/gtest.h>
 #include <s2/s2cap.h>
 #include <s2/s2testing.h>
@@ -60,14 +61,6 @@ public:
         return _geo_client->restore_origin_keys(geo_sort_key, origin_hash_key, origin_sort_key);
     }
 
-    void normalize_result(std::list<std::list<SearchResult>> &&results,
-                          int count,
-                          geo::geo_client::SortType sort_type,
-                          std::list<SearchResult> &result)
-    {
-        _geo_client->normalize_result(std::move(results), count, sort_type, result);
-    }
-
     void gen_search_cap(const S2LatLng &latlng, double radius_m, S2Cap &cap)
     {
         _geo_client->gen_search_cap(latlng, radius_m, cap);
@@ -416,93 +409,128 @@ TEST_F(geo_client_test, generate_and_restore_geo_keys)
     ASSERT_EQ(test_sort_key, restore_sort_key);
 }
 
-TEST_F(geo_client_test, normalize_result_random_order)
+TEST(geo_result_merger_test, random_order)
 {
     geo::SearchResult r1(1.1, 1.1, 1, "test_hash_key_1", "test_sort_key_1", "value_1");
     geo::SearchResult r2(2.2, 2.2, 2, "test_hash_key_2", "test_sort_key_2", "value_2");
     int count = 100;
-    std::list<geo::SearchResult> result;
 
     {
-        std::list<std::list<geo::SearchResult>> results;
-        results.push_back({geo::SearchResult(r1)});
-        normalize_result(std::move(results), count, geo::geo_client::SortType::random, result);
+        geo_result_merger merger(count, geo::geo_client::SortType::random);
+        merger.add(geo::SearchResult(r1));
+        ASSERT_FALSE(merger.can_skip(0));
+        auto result = merger.finish();
         ASSERT_EQ(result.size(), 1);
         ASSERT_EQ(result.front(), r1);
     }
 
     {
-        std::list<std::list<geo::SearchResult>> results;
-        results.push_back({geo::SearchResult(r1)});
-        results.push_back({geo::SearchResult(r2)});
-        normalize_result(std::move(results), 1, geo::geo_client::SortType::random, result);
+        geo_result_merger merger(1, geo::geo_client::SortType::random);
+        merger.add(geo::SearchResult(r1));
+        // enough results are found, no matter where they are
+        ASSERT_TRUE(merger.can_skip(0));
+        merger.add(geo::SearchResult(r2));
+        auto result = merger.finish();
         ASSERT_EQ(result.size(), 1);
         ASSERT_EQ(result.front(), r1);
     }
 
     {
-        std::list<std::list<geo::SearchResult>> results;
-        results.push_back({geo::SearchResult(r1)});
-        results.push_back({geo::SearchResult(r2)});
-        normalize_result(std::move(results), count, geo::geo_client::SortType::random, result);
+        geo_result_merger merger(count, geo::geo_client::SortType::random);
+        merger.add(geo::SearchResult(r1));
+        merger.add(geo::SearchResult(r2));
+        auto result = merger.finish();
         ASSERT_EQ(result.size(), 2);
         ASSERT_EQ(result.front(), r1);
         ASSERT_EQ(result.back(), r2);
     }
 
     {
-        std::list<std::list<geo::SearchResult>> results;
-        results.push_back({geo::SearchResult(r1)});
-        results.push_back({geo::SearchResult(r2)});
-        normalize_result(std::move(results), -1, geo::geo_client::SortType::random, result);
+        geo_result_merger merger(-1, geo::geo_client::SortType::random);
+        merger.add(geo::SearchResult(r1));
+        merger.add(geo::SearchResult(r2));
+        ASSERT_FALSE(merger.can_skip(0));
+        auto result = merger.finish();
         ASSERT_EQ(result.size(), 2);
         ASSERT_EQ(result.front(), r1);
         ASSERT_EQ(result.back(), r2);
     }
 }
 
-TEST_F(geo_client_test, normalize_result_distance_order)
+TEST(geo_result_merger_test, distance_order)
 {
     geo::SearchResult r1(1.1, 1.1, 1, "test_hash_key_1", "test_sort_key_1", "value_1");
     geo::SearchResult r2(2.2, 2.2, 2, "test_hash_key_2", "test_sort_key_2", "value_2");
     int count = 100;
-    std::list<geo::SearchResult> result;
 
     {
-        std::list<std::list<geo::SearchResult>> results;
-        results.push_back({geo::SearchResult(r2)});
-        normalize_result(std::move(results), count, geo::geo_client::SortType::asc, result);
+        geo_result_merger merger(count, geo::geo_client::SortType::asc);
+        merger.add(geo::SearchResult(r2));
+        auto result = merger.finish();
         ASSERT_EQ(result.size(), 1);
         ASSERT_EQ(result.front(), r2);
     }
 
     {
-        std::list<std::list<geo::SearchResult>> results;
-        results.push_back({geo::SearchResult(r1)});
-        normalize_result(std::move(results), 1, geo::geo_client::SortType::asc, result);
+        geo_result_merger merger(1, geo::geo_client::SortType::asc);
+        merger.add(geo::SearchResult(r2));
+        merger.add(geo::SearchResult(r1));
+        auto result = merger.finish();
         ASSERT_EQ(result.size(), 1);
         ASSERT_EQ(result.front(), r1);
     }
 
     {
-        std::list<std::list<geo::SearchResult>> results;
-        results.push_back({geo::SearchResult(r1)});
-        results.push_back({geo::SearchResult(r2)});
-        normalize_result(std::move(results), count, geo::geo_client::SortType::asc, result);
+        geo_result_merger merger(count, geo::geo_client::SortType::asc);
+        merger.add(geo::SearchResult(r2));
+        merger.add(geo::SearchResult(r1));
+        auto result = merger.finish();
         ASSERT_EQ(result.size(), 2);
         ASSERT_EQ(result.front(), r1);
         ASSERT_EQ(result.back(), r2);
     }
 
     {
-        std::list<std::list<geo::SearchResult>> results;
-        results.push_back({geo::SearchResult(r1)});
-        results.push_back({geo::SearchResult(r2)});
-        normalize_result(std::move(results), -1, geo::geo_client::SortType::asc, result);
+        geo_result_merger merger(-1, geo::geo_client::SortType::asc);
+        merger.add(geo::SearchResult(r2));
+        merger.add(geo::SearchResult(r1));
+        auto result = merger.finish();
         ASSERT_EQ(result.size(), 2);
         ASSERT_EQ(result.front(), r1);
         ASSERT_EQ(result.back(), r2);
     }
+
+    {
+        geo_result_merger merger(1, geo::geo_client::SortType::desc);
+        merger.add(geo::SearchResult(r1));
+        merger.add(geo::SearchResult(r2));
+        auto result = merger.finish();
+        ASSERT_EQ(result.size(), 1);
+        ASSERT_EQ(result.front(), r2);
+    }
+}
+
+TEST(geo_result_merger_test, top_k)
+{
+    int count = 10;
+    geo_result_merger merger(count, geo::geo_client::SortType::asc);
+    for (int i = 100; i > 0; --i) {
+        merger.add(geo::SearchResult(0, 0, i));
+        if (i > 91) {
+            // the heap isn't full
+            ASSERT_FALSE(merger.can_skip(1000));
+        } else {
+            // the areas farther than the 10th nearest result can be skipped
+            ASSERT_TRUE(merger.can_skip(i + 9.5));
+            ASSERT_FALSE(merger.can_skip(i + 9));
+        }
+    }
+
+    auto result = merger.finish();
+    ASSERT_EQ(result.size(), count);
+    for (int i = 0; i < count; ++i) {
+        ASSERT_EQ(result[i].distance, i + 1);
+    }
 }
 
 TEST_F(geo_client_test, distance)
@@ -264,6 +264,18 @@ struct check_and_mutate_response
     8:string         server;
 }
 
+// Evaluated on the replica for the scans of geo_client: only the values whose coordinates are
+// within radius_m meters from the center are returned.
+struct geo_scan_filter
+{
+    1:double    center_lat;       // in degrees
+    2:double    center_lng;       // in degrees
+    3:double    radius_m;
+    4:i32       latitude_index;   // index of latitude in value split by '|'
+    5:i32       longitude_index;  // index of longitude in value split by '|'
+    6:i32       limit;            // stop the scan after so many values matched, -1 means no limit
+}
+
 struct get_scanner_request
 {
     1:dsn.blob  start_key;
@@ -279,6 +291,7 @@ struct get_scanner_request
     11:optional bool    validate_partition_hash;
     12:optional bool    return_expire_ts;
     13:optional bool full_scan; // true means client want to build 'full scan' context with the server side, false otherwise
+    14:optional geo_scan_filter geo_filter;
 }
 
 struct scan_request
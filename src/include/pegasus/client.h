@@ -240,6 +240,30 @@ public:
         }
     };
 
+    // Filters the scanned values on the server by the coordinates in them, used by geo_client.
+    // Only the values whose coordinates are within radius_m meters from the center are
+    // returned. The coordinates are the fields at latitude_index and longitude_index of the
+    // value split by '|'.
+    struct geo_filter_options
+    {
+        double center_lat; // in degrees
+        double center_lng; // in degrees
+        double radius_m;   // disabled if not positive
+        int latitude_index;
+        int longitude_index;
+        int limit; // stop the scan after so many values returned, -1 means no limit
+        geo_filter_options()
+            : center_lat(0),
+              center_lng(0),
+              radius_m(0),
+              latitude_index(-1),
+              longitude_index(-1),
+              limit(-1)
+        {
+        }
+        bool enabled() const { return radius_m > 0; }
+    };
+
     struct scan_options
     {
         int timeout_ms;       // RPC call timeout param, in milliseconds
@@ -252,6 +276,7 @@ public:
         std::string sort_key_filter_pattern;
         bool no_value; // only fetch hash_key and sort_key, but not fetch value
         bool return_expire_ts;
+        geo_filter_options geo_filter;
         scan_options()
             : timeout_ms(5000),
               batch_size(100),
@@ -273,7 +298,8 @@ public:
               sort_key_filter_type(o.sort_key_filter_type),
               sort_key_filter_pattern(o.sort_key_filter_pattern),
               no_value(o.no_value),
-              return_expire_ts(o.return_expire_ts)
+              return_expire_ts(o.return_expire_ts),
+              geo_filter(o.geo_filter)
         {
         }
     };
@@ -462,6 +462,12 @@ public:
         return rpc.call(_resolver, tracker, std::forward<TCallback &&>(callback));
     }
 
+    // partition index of partition_hash, or -1 if the partition count is still unknown
+    int get_partition_index(uint64_t partition_hash)
+    {
+        return _resolver->get_current_partition_index(partition_hash);
+    }
+
 private:
     dsn::replication::partition_resolver_ptr _resolver;
     dsn::task_tracker _tracker;
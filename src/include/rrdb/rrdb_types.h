@@ -115,6 +115,8 @@ class check_and_mutate_request;
 
 class check_and_mutate_response;
 
+class geo_scan_filter;
+
 class get_scanner_request;
 
 class scan_request;
@@ -1793,6 +1795,98 @@ inline std::ostream &operator<<(std::ostream &out, const check_and_mutate_respon
     return out;
 }
 
+typedef struct _geo_scan_filter__isset
+{
+    _geo_scan_filter__isset()
+        : center_lat(false),
+          center_lng(false),
+          radius_m(false),
+          latitude_index(false),
+          longitude_index(false),
+          limit(false)
+    {
+    }
+    bool center_lat : 1;
+    bool center_lng : 1;
+    bool radius_m : 1;
+    bool latitude_index : 1;
+    bool longitude_index : 1;
+    bool limit : 1;
+} _geo_scan_filter__isset;
+
+class geo_scan_filter
+{
+public:
+    geo_scan_filter(const geo_scan_filter &);
+    geo_scan_filter(geo_scan_filter &&);
+    geo_scan_filter &operator=(const geo_scan_filter &);
+    geo_scan_filter &operator=(geo_scan_filter &&);
+    geo_scan_filter()
+        : center_lat(0),
+          center_lng(0),
+          radius_m(0),
+          latitude_index(0),
+          longitude_index(0),
+          limit(0)
+    {
+    }
+
+    virtual ~geo_scan_filter() throw();
+    double center_lat;
+    double center_lng;
+    double radius_m;
+    int32_t latitude_index;
+    int32_t longitude_index;
+    int32_t limit;
+
+    _geo_scan_filter__isset __isset;
+
+    void __set_center_lat(const double val);
+
+    void __set_center_lng(const double val);
+
+    void __set_radius_m(const double val);
+
+    void __set_latitude_index(const int32_t val);
+
+    void __set_longitude_index(const int32_t val);
+
+    void __set_limit(const int32_t val);
+
+    bool operator==(const geo_scan_filter &rhs) const
+    {
+        if (!(center_lat == rhs.center_lat))
+            return false;
+        if (!(center_lng == rhs.center_lng))
+            return false;
+        if (!(radius_m == rhs.radius_m))
+            return false;
+        if (!(latitude_index == rhs.latitude_index))
+            return false;
+        if (!(longitude_index == rhs.longitude_index))
+            return false;
+        if (!(limit == rhs.limit))
+            return false;
+        return true;
+    }
+    bool operator!=(const geo_scan_filter &rhs) const { return !(*this == rhs); }
+
+    bool operator<(const geo_scan_filter &) const;
+
+    uint32_t read(::apache::thrift::protocol::TProtocol *iprot);
+    uint32_t write(::apache::thrift::protocol::TProtocol *oprot) const;
+
+    virtual void printTo(std::ostream &out) const;
+};
+
+void swap(geo_scan_filter &a, geo_scan_filter &b);
+
+inline std::ostream &operator<<(std::ostream &out, const geo_scan_filter &obj)
+{
+    obj.printTo(out);
+    return out;
+}
+
 typedef struct _get_scanner_request__isset
 {
     _get_scanner_request__isset()
@@ -1808,7 +1902,8 @@ typedef struct _get_scanner_request__isset
           sort_key_filter_pattern(false),
           validate_partition_hash(false),
           return_expire_ts(false),
-          full_scan(false)
+          full_scan(false),
+          geo_filter(false)
     {
     }
     bool start_key : 1;
@@ -1824,6 +1919,7 @@ typedef struct _get_scanner_request__isset
     bool validate_partition_hash : 1;
     bool return_expire_ts : 1;
     bool full_scan : 1;
+    bool geo_filter : 1;
 } _get_scanner_request__isset;
 
 class get_scanner_request
@@ -1860,6 +1956,7 @@ public:
     bool validate_partition_hash;
     bool return_expire_ts;
     bool full_scan;
+    geo_scan_filter geo_filter;
 
     _get_scanner_request__isset __isset;
 
@@ -1889,6 +1986,8 @@ public:
 
     void __set_full_scan(const bool val);
 
+    void __set_geo_filter(const geo_scan_filter &val);
+
     bool operator==(const get_scanner_request &rhs) const
     {
         if (!(start_key == rhs.start_key))
@@ -1924,6 +2023,10 @@ public:
             return false;
         else if (__isset.full_scan && !(full_scan == rhs.full_scan))
             return false;
+        if (__isset.geo_filter != rhs.__isset.geo_filter)
+            return false;
+        else if (__isset.geo_filter && !(geo_filter == rhs.geo_filter))
+            return false;
         return true;
     }
     bool operator!=(const get_scanner_request &rhs) const { return !(*this == rhs); }
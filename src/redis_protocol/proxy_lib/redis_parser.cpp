@@ -22,7 +22,9 @@
 #include <rocksdb/status.h>
 #include <dsn/dist/fmt_logging.h>
 #include <dsn/dist/replication/replication_other_types.h>
+#include <dsn/utility/buffer_pool.h>
 #include <dsn/utility/string_conv.h>
+#include <dsn/utility/string_view.h>
 
 #include <rrdb/rrdb.client.h>
 #include <pegasus/error.h>
@@ -44,6 +46,10 @@ std::unordered_map<std::string, redis_parser::redis_call_handler> redis_parser::
     {"SETEX", redis_parser::g_setex},
     {"TTL", redis_parser::g_ttl},
     {"PTTL", redis_parser::g_ttl},
+    {"MGET", redis_parser::g_mget},
+    {"MSET", redis_parser::g_mset},
+    {"EXISTS", redis_parser::g_exists},
+    {"EXPIRE", redis_parser::g_expire},
     {"GEOADD", redis_parser::g_geo_add},
     {"GEODIST", redis_parser::g_geo_dist},
     {"GEOPOS", redis_parser::g_geo_pos},
@@ -71,8 +77,6 @@ redis_parser::redis_parser(proxy_stub *op, dsn::message_ex *first_msg)
       _status(kStartArray),
       _current_size(),
       _total_length(0),
-      _current_buffer(nullptr),
-      _current_buffer_length(0),
       _current_cursor(0)
 {
     ::dsn::apps::rrdb_client *r;
@@ -100,29 +104,26 @@ redis_parser::~redis_parser()
 
 void redis_parser::prepare_current_buffer()
 {
-    void *msg_buffer;
-    if (_current_buffer == nullptr) {
+    if (_current_buffer.data() == nullptr) {
         dsn::message_ex *first_msg = _recv_buffers.front();
         dassert(
-            first_msg->read_next(&msg_buffer, &_current_buffer_length),
+            first_msg->read_next(_current_buffer),
             "read dsn::message_ex* failed, msg from_address = %s, to_address = %s, rpc_name = %s",
             first_msg->header->from_address.to_string(),
             first_msg->to_address.to_string(),
             first_msg->header->rpc_name);
-        _current_buffer = static_cast<char *>(msg_buffer);
         _current_cursor = 0;
-    } else if (_current_cursor >= _current_buffer_length) {
+    } else if (_current_cursor >= _current_buffer.length()) {
         dsn::message_ex *first_msg = _recv_buffers.front();
-        first_msg->read_commit(_current_buffer_length);
-        if (first_msg->read_next(&msg_buffer, &_current_buffer_length)) {
-            _current_buffer = static_cast<char *>(msg_buffer);
+        first_msg->read_commit(_current_buffer.length());
+        if (first_msg->read_next(_current_buffer)) {
             _current_cursor = 0;
         } else {
             // we have consume this message all over
             // reference is added in append message
             first_msg->release_ref();
             _recv_buffers.pop();
-            _current_buffer = nullptr;
+            _current_buffer = dsn::blob();
             prepare_current_buffer();
         }
     }
@@ -138,11 +139,10 @@ void redis_parser::reset_parser()
 
     // clear the data stream
     _total_length = 0;
-    if (_current_buffer) {
-        _recv_buffers.front()->read_commit(_current_buffer_length);
+    if (_current_buffer.data() != nullptr) {
+        _recv_buffers.front()->read_commit(_current_buffer.length());
     }
-    _current_buffer = nullptr;
-    _current_buffer_length = 0;
+    _current_buffer = dsn::blob();
     _current_cursor = 0;
     while (!_recv_buffers.empty()) {
         _recv_buffers.front()->release_ref();
@@ -153,7 +153,7 @@ void redis_parser::reset_parser()
 char redis_parser::peek()
 {
     prepare_current_buffer();
-    return _current_buffer[_current_cursor];
+    return _current_buffer.data()[_current_cursor];
 }
 
 bool redis_parser::eat(char c)
@@ -174,17 +174,49 @@ void redis_parser::eat_all(char *dest, size_t length)
     while (length > 0) {
         prepare_current_buffer();
 
-        size_t eat_size = _current_buffer_length - _current_cursor;
+        size_t eat_size = _current_buffer.length() - _current_cursor;
         if (eat_size > length) {
             eat_size = length;
         }
-        memcpy(dest, _current_buffer + _current_cursor, eat_size);
+        memcpy(dest, _current_buffer.data() + _current_cursor, eat_size);
         dest += eat_size;
         _current_cursor += eat_size;
         length -= eat_size;
     }
 }
 
+dsn::blob redis_parser::eat_bulk_string_data(size_t length)
+{
+    prepare_current_buffer();
+    // a bulk string is mostly received in one buffer, slice it out of the message instead of
+    // copying. buffers not owned by the message (no holder) may not outlive it, so they're copied.
+    if (_current_buffer.length() - _current_cursor >= length &&
+        _current_buffer.buffer_ptr() != nullptr) {
+        dsn::blob data = _current_buffer.range(_current_cursor, length);
+        _current_cursor += length;
+        _total_length -= length;
+        return data;
+    }
+
+    std::shared_ptr<char> buffer = dsn::utils::buffer_pool::make_shared(length);
+    eat_all(buffer.get(), length);
+    return dsn::blob(std::move(buffer), length);
+}
+
+void redis_parser::eat_size_line()
+{
+    prepare_current_buffer();
+    // append the digits before CR in the current buffer at once, memchr is much faster than
+    // testing the bytes one by one
+    const char *begin = _current_buffer.data() + _current_cursor;
+    size_t available = _current_buffer.length() - _current_cursor;
+    const char *end = static_cast<const char *>(memchr(begin, CR, available));
+    size_t size = (end == nullptr) ? available : end - begin;
+    _current_size.append(begin, size);
+    _current_cursor += size;
+    _total_length -= size;
+}
+
 bool redis_parser::end_array_size()
 {
     int32_t count = 0;
@@ -264,7 +296,6 @@ void redis_parser::append_message(dsn::message_ex *msg)
 // refererence: http://redis.io/topics/protocol
 bool redis_parser::parse_stream()
 {
-    char t;
     while (_total_length > 0) {
         switch (_status) {
         case kStartArray:
@@ -277,8 +308,7 @@ bool redis_parser::parse_stream()
             break;
         case kInArraySize:
         case kInBulkStringSize:
-            t = peek();
-            if (t == CR) {
+            if (peek() == CR) {
                 if (_total_length > 1) {
                     dverify(eat(CR));
                     dverify(eat(LF));
@@ -291,17 +321,14 @@ bool redis_parser::parse_stream()
                     return true;
                 }
             } else {
-                _current_size.push_back(t);
-                dverify(eat(t));
+                eat_size_line();
             }
             break;
         case kStartBulkStringData:
             // string content + CR + LF
             if (_total_length >= _current_str.length + 2) {
                 if (_current_str.length > 0) {
-                    std::string str_data(_current_str.length, '\0');
-                    eat_all(const_cast<char *>(str_data.data()), _current_str.length);
-                    _current_str.data = dsn::blob::create_from_bytes(std::move(str_data));
+                    _current_str.data = eat_bulk_string_data(_current_str.length);
                 }
                 dverify(eat(CR));
                 dverify(eat(LF));
@@ -658,11 +685,13 @@ void redis_parser::del(message_entry &entry)
 void redis_parser::del_internal(message_entry &entry)
 {
     redis_request &redis_req = entry.request;
-    if (redis_req.sub_requests.size() != 2) {
+    if (redis_req.sub_requests.size() < 2) {
         ddebug("%s: del command seqid(%" PRId64 ") with invalid arguments",
                _remote_address.to_string(),
                entry.sequence_id);
         simple_error_reply(entry, "wrong number of arguments for 'del' command");
+    } else if (redis_req.sub_requests.size() > 2) {
+        del_multi_keys(entry);
     } else {
         dinfo("%s: send del command seqid(%" PRId64 ")",
               _remote_address.to_string(),
@@ -807,6 +836,439 @@ void redis_parser::ttl(message_entry &entry)
     }
 }
 
+void redis_parser::multi_key_context::set_error(std::string &&err)
+{
+    dsn::zauto_lock l(error_lock);
+    if (error.empty()) {
+        error = std::move(err);
+    }
+}
+
+void redis_parser::multi_key_context::finish_request()
+{
+    // the last finished sub request builds the reply, the acq_rel ordering makes the values
+    // written by the other sub requests visible to it
+    if (pending_requests.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        on_finished(*this);
+    }
+}
+
+std::vector<std::vector<size_t>> redis_parser::group_keys_by_partition(
+    const std::vector<redis_bulk_string> &keys,
+    const std::function<int(const ::dsn::blob &)> &get_partition_index)
+{
+    std::vector<std::vector<size_t>> groups;
+    std::unordered_map<int, size_t> partition_to_group;
+    // keys[0] is the command name
+    for (size_t i = 1; i < keys.size(); ++i) {
+        int partition_index = get_partition_index(keys[i].data);
+        if (partition_index < 0) {
+            // the partition count isn't known yet, let the key be routed alone
+            groups.push_back({i - 1});
+            continue;
+        }
+        auto iter = partition_to_group.find(partition_index);
+        if (iter == partition_to_group.end()) {
+            partition_to_group.emplace(partition_index, groups.size());
+            groups.push_back({i - 1});
+        } else {
+            groups[iter->second].push_back(i - 1);
+        }
+    }
+    return groups;
+}
+
+void redis_parser::batch_get_internal(message_entry &entry,
+                                      const char *command,
+                                      std::function<void(multi_key_context &)> &&on_finished)
+{
+    const std::vector<redis_bulk_string> &keys = entry.request.sub_requests;
+    std::vector<std::vector<size_t>> groups =
+        group_keys_by_partition(keys, [this](const ::dsn::blob &key) {
+            ::dsn::blob full_key;
+            pegasus_generate_key(full_key, key, ::dsn::blob());
+            return client->get_partition_index(pegasus_key_hash(full_key));
+        });
+
+    auto context = std::make_shared<multi_key_context>(keys.size() - 1, (int)groups.size());
+    context->on_finished = std::move(on_finished);
+    dinfo_f("{}: send {} command seqid({}) with {} keys in {} rpcs",
+            _remote_address.to_string(),
+            command,
+            entry.sequence_id,
+            keys.size() - 1,
+            groups.size());
+
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    for (std::vector<size_t> &group : groups) {
+        ::dsn::blob first_key;
+        pegasus_generate_key(first_key, keys[group[0] + 1].data, ::dsn::blob());
+        auto partition_hash = pegasus_key_hash(first_key);
+
+        if (group.size() == 1) {
+            size_t pos = group[0];
+            auto on_get_reply = [ref_this, this, &entry, command, context, pos](
+                ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+                if (_is_session_reset.load(std::memory_order_acquire)) {
+                    ddebug_f("{}: {} command seqid({}) got reply, but session has reset",
+                             _remote_address.to_string(),
+                             command,
+                             entry.sequence_id);
+                    return;
+                }
+
+                if (::dsn::ERR_OK != ec) {
+                    context->set_error(ec.to_string());
+                } else {
+                    ::dsn::apps::read_response rrdb_response;
+                    ::dsn::unmarshall(response, rrdb_response);
+                    if (rrdb_response.error == 0) {
+                        context->values[pos] = redis_bulk_string(rrdb_response.value);
+                    } else if (rrdb_response.error != rocksdb::Status::kNotFound) {
+                        context->set_error("internal error " +
+                                           std::to_string(rrdb_response.error));
+                    }
+                }
+                context->finish_request();
+            };
+            // TODO: set the timeout
+            client->get(
+                first_key, on_get_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+            continue;
+        }
+
+        ::dsn::apps::batch_get_request req;
+        req.keys.resize(group.size());
+        for (size_t i = 0; i < group.size(); ++i) {
+            req.keys[i].hash_key = keys[group[i] + 1].data;
+        }
+        auto on_batch_get_reply = [ref_this, this, &entry, command, context, group](
+            ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+            if (_is_session_reset.load(std::memory_order_acquire)) {
+                ddebug_f("{}: {} command seqid({}) got reply, but session has reset",
+                         _remote_address.to_string(),
+                         command,
+                         entry.sequence_id);
+                return;
+            }
+
+            if (::dsn::ERR_OK != ec) {
+                context->set_error(ec.to_string());
+            } else {
+                ::dsn::apps::batch_get_response rrdb_response;
+                ::dsn::unmarshall(response, rrdb_response);
+                if (rrdb_response.error != 0) {
+                    context->set_error("internal error " + std::to_string(rrdb_response.error));
+                } else {
+                    // the found keys are returned in the order they are requested, the missing
+                    // ones are skipped
+                    const std::vector<redis_bulk_string> &keys = entry.request.sub_requests;
+                    size_t cursor = 0;
+                    for (size_t pos : group) {
+                        if (cursor < rrdb_response.data.size() &&
+                            dsn::string_view(rrdb_response.data[cursor].hash_key) ==
+                                dsn::string_view(keys[pos + 1].data)) {
+                            context->values[pos] =
+                                redis_bulk_string(rrdb_response.data[cursor].value);
+                            ++cursor;
+                        }
+                    }
+                }
+            }
+            context->finish_request();
+        };
+        // TODO: set the timeout
+        client->batch_get(
+            req, on_batch_get_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+    }
+}
+
+// command format:
+// MGET key [key ...]
+void redis_parser::mget(message_entry &entry)
+{
+    if (entry.request.sub_requests.size() < 2) {
+        simple_error_reply(entry, "wrong number of arguments for 'mget' command");
+        return;
+    }
+
+    batch_get_internal(entry, "mget", [this, &entry](multi_key_context &context) {
+        if (!context.error.empty()) {
+            simple_error_reply(entry, context.error);
+            return;
+        }
+        redis_array result;
+        result.resize(context.values.size());
+        for (size_t i = 0; i < context.values.size(); ++i) {
+            result.array[i] = std::make_shared<redis_bulk_string>(std::move(context.values[i]));
+        }
+        reply_message(entry, result);
+    });
+}
+
+// command format:
+// EXISTS key [key ...]
+// NOTE: a key is counted as many times as it is given, just like Redis.
+void redis_parser::exists(message_entry &entry)
+{
+    if (entry.request.sub_requests.size() < 2) {
+        simple_error_reply(entry, "wrong number of arguments for 'exists' command");
+        return;
+    }
+
+    batch_get_internal(entry, "exists", [this, &entry](multi_key_context &context) {
+        if (!context.error.empty()) {
+            simple_error_reply(entry, context.error);
+            return;
+        }
+        int64_t count = 0;
+        for (const redis_bulk_string &value : context.values) {
+            if (value.length >= 0) {
+                ++count;
+            }
+        }
+        simple_integer_reply(entry, count);
+    });
+}
+
+// command format:
+// MSET key value [key value ...]
+// NOTE: pegasus has no atomic write across hash keys, so the keys are written by concurrent puts
+// and a failed MSET may be partially applied.
+void redis_parser::mset(message_entry &entry)
+{
+    const std::vector<redis_bulk_string> &args = entry.request.sub_requests;
+    if (args.size() < 3 || args.size() % 2 == 0) {
+        simple_error_reply(entry, "wrong number of arguments for 'mset' command");
+        return;
+    }
+
+    // concurrent puts on the same key are not ordered, only write the last value of a key
+    std::unordered_map<std::string, size_t> last_pos;
+    for (size_t i = 1; i < args.size(); i += 2) {
+        last_pos[args[i].data.to_string()] = i;
+    }
+
+    auto context = std::make_shared<multi_key_context>(0, (int)last_pos.size());
+    context->on_finished = [this, &entry](multi_key_context &context) {
+        if (!context.error.empty()) {
+            simple_error_reply(entry, context.error);
+        } else {
+            simple_ok_reply(entry);
+        }
+    };
+    dinfo_f("{}: send mset command seqid({}) with {} keys",
+            _remote_address.to_string(),
+            entry.sequence_id,
+            last_pos.size());
+
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    for (const auto &kv : last_pos) {
+        auto on_set_reply = [ref_this, this, &entry, context](
+            ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+            if (_is_session_reset.load(std::memory_order_acquire)) {
+                ddebug_f("{}: mset command seqid({}) got reply, but session has reset",
+                         _remote_address.to_string(),
+                         entry.sequence_id);
+                return;
+            }
+
+            if (::dsn::ERR_OK != ec) {
+                context->set_error(ec.to_string());
+            } else {
+                ::dsn::apps::update_response rrdb_response;
+                ::dsn::unmarshall(response, rrdb_response);
+                if (rrdb_response.error != 0) {
+                    context->set_error("internal error " + std::to_string(rrdb_response.error));
+                }
+            }
+            context->finish_request();
+        };
+
+        ::dsn::apps::update_request req;
+        pegasus_generate_key(req.key, args[kv.second].data, ::dsn::blob());
+        req.value = args[kv.second + 1].data;
+        req.expire_ts_seconds = 0;
+        auto partition_hash = pegasus_key_hash(req.key);
+        // TODO: set the timeout
+        client->put(req, on_set_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+    }
+}
+
+// DEL with more than one key, the keys are removed by concurrent rpcs.
+// NOTE: like the single key DEL, every distinct key is counted as deleted.
+void redis_parser::del_multi_keys(message_entry &entry)
+{
+    const std::vector<redis_bulk_string> &args = entry.request.sub_requests;
+    // key => position of its first occurrence
+    std::unordered_map<std::string, size_t> distinct_keys;
+    for (size_t i = 1; i < args.size(); ++i) {
+        distinct_keys.emplace(args[i].data.to_string(), i);
+    }
+
+    auto context = std::make_shared<multi_key_context>(0, (int)distinct_keys.size());
+    int64_t deleted_count = distinct_keys.size();
+    context->on_finished = [this, &entry, deleted_count](multi_key_context &context) {
+        if (!context.error.empty()) {
+            simple_error_reply(entry, context.error);
+        } else {
+            simple_integer_reply(entry, deleted_count);
+        }
+    };
+    dinfo_f("{}: send del command seqid({}) with {} keys",
+            _remote_address.to_string(),
+            entry.sequence_id,
+            distinct_keys.size());
+
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    for (const auto &kv : distinct_keys) {
+        auto on_del_reply = [ref_this, this, &entry, context](
+            ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+            if (_is_session_reset.load(std::memory_order_acquire)) {
+                ddebug_f("{}: del command seqid({}) got reply, but session has reset",
+                         _remote_address.to_string(),
+                         entry.sequence_id);
+                return;
+            }
+
+            if (::dsn::ERR_OK != ec) {
+                context->set_error(ec.to_string());
+            } else {
+                ::dsn::apps::update_response rrdb_response;
+                ::dsn::unmarshall(response, rrdb_response);
+                if (rrdb_response.error != 0) {
+                    context->set_error("internal error " + std::to_string(rrdb_response.error));
+                }
+            }
+            context->finish_request();
+        };
+
+        ::dsn::blob req;
+        pegasus_generate_key(req, args[kv.second].data, ::dsn::blob());
+        auto partition_hash = pegasus_key_hash(req);
+        // TODO: set the timeout
+        client->remove(req, on_del_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+    }
+}
+
+// command format:
+// EXPIRE key seconds
+// NOTE: pegasus can't update the ttl alone, so the value is read and then written back by a
+// check_and_set, which fails rather than overwrites if the value is changed in between. Replies 1
+// if the timeout is set, 0 if the key doesn't exist or is changed concurrently.
+void redis_parser::expire(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    if (redis_req.sub_requests.size() != 3) {
+        simple_error_reply(entry, "wrong number of arguments for 'expire' command");
+        return;
+    }
+    int ttl_seconds;
+    if (!dsn::buf2int32(redis_req.sub_requests[2].data, ttl_seconds)) {
+        simple_error_reply(entry, "value is not an integer or out of range");
+        return;
+    }
+
+    dinfo_f("{}: send expire command seqid({})", _remote_address.to_string(), entry.sequence_id);
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto on_get_reply = [ref_this, this, &entry, ttl_seconds](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            ddebug_f("{}: expire command seqid({}) got reply, but session has reset",
+                     _remote_address.to_string(),
+                     entry.sequence_id);
+            return;
+        }
+
+        if (::dsn::ERR_OK != ec) {
+            simple_error_reply(entry, ec.to_string());
+            return;
+        }
+        ::dsn::apps::read_response rrdb_response;
+        ::dsn::unmarshall(response, rrdb_response);
+        if (rrdb_response.error == rocksdb::Status::kNotFound) {
+            simple_integer_reply(entry, 0);
+        } else if (rrdb_response.error != 0) {
+            simple_error_reply(entry, "internal error " + std::to_string(rrdb_response.error));
+        } else {
+            expire_existing_key(entry, rrdb_response.value, ttl_seconds);
+        }
+    };
+
+    ::dsn::blob req;
+    pegasus_generate_key(req, redis_req.sub_requests[1].data, ::dsn::blob());
+    auto partition_hash = pegasus_key_hash(req);
+    // TODO: set the timeout
+    client->get(req, on_get_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+}
+
+void redis_parser::expire_existing_key(message_entry &entry,
+                                       const ::dsn::blob &value,
+                                       int ttl_seconds)
+{
+    const ::dsn::blob &key = entry.request.sub_requests[1].data;
+    ::dsn::blob full_key;
+    pegasus_generate_key(full_key, key, ::dsn::blob());
+    auto partition_hash = pegasus_key_hash(full_key);
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+
+    if (ttl_seconds <= 0) {
+        // a non-positive timeout deletes the key, the same as Redis
+        auto on_del_reply = [ref_this, this, &entry](
+            ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+            if (_is_session_reset.load(std::memory_order_acquire)) {
+                return;
+            }
+            if (::dsn::ERR_OK != ec) {
+                simple_error_reply(entry, ec.to_string());
+                return;
+            }
+            ::dsn::apps::update_response rrdb_response;
+            ::dsn::unmarshall(response, rrdb_response);
+            if (rrdb_response.error != 0) {
+                simple_error_reply(entry, "internal error " + std::to_string(rrdb_response.error));
+            } else {
+                simple_integer_reply(entry, 1);
+            }
+        };
+        // TODO: set the timeout
+        client->remove(
+            full_key, on_del_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+        return;
+    }
+
+    ::dsn::apps::check_and_set_request req;
+    req.hash_key = key;
+    req.check_type = ::dsn::apps::cas_check_type::CT_VALUE_BYTES_EQUAL;
+    req.check_operand = value;
+    req.set_diff_sort_key = false;
+    req.set_value = value;
+    req.set_expire_ts_seconds = pegasus::utils::epoch_now() + ttl_seconds;
+    req.return_check_value = false;
+    auto on_cas_reply = [ref_this, this, &entry](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            return;
+        }
+        if (::dsn::ERR_OK != ec) {
+            simple_error_reply(entry, ec.to_string());
+            return;
+        }
+        ::dsn::apps::check_and_set_response rrdb_response;
+        ::dsn::unmarshall(response, rrdb_response);
+        if (rrdb_response.error == rocksdb::Status::kTryAgain) {
+            // the value is changed or deleted after it is read
+            simple_integer_reply(entry, 0);
+        } else if (rrdb_response.error != 0) {
+            simple_error_reply(entry, "internal error " + std::to_string(rrdb_response.error));
+        } else {
+            simple_integer_reply(entry, 1);
+        }
+    };
+    // TODO: set the timeout
+    client->check_and_set(req, on_cas_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+}
+
 // command format:
 // GEORADIUS key longitude latitude radius m|km|ft|mi [WITHCOORD] [WITHDIST] [WITHHASH] [COUNT
 // count] [ASC|DESC] [STORE key] [STOREDIST key]
@@ -1335,13 +1797,22 @@ void redis_parser::handle_command(std::unique_ptr<message_entry> &&entry)
     handler(this, e);
 }
 
+void redis_parser::write_line(::dsn::binary_writer &write_stream, char prefix, int64_t value)
+{
+    // format on stack and write the line with one copy into the response buffer
+    fmt::format_int value_str(value);
+    // prefix + at most 20 chars of an int64 + CR LF
+    char line[24];
+    line[0] = prefix;
+    memcpy(line + 1, value_str.data(), value_str.size());
+    line[1 + value_str.size()] = CR;
+    line[2 + value_str.size()] = LF;
+    write_stream.write(line, (int)value_str.size() + 3);
+}
+
 void redis_parser::redis_integer::marshalling(::dsn::binary_writer &write_stream) const
 {
-    write_stream.write_pod(':');
-    std::string result = std::to_string(value);
-    write_stream.write(result.c_str(), (int)result.length());
-    write_stream.write_pod(CR);
-    write_stream.write_pod(LF);
+    write_line(write_stream, ':', value);
 }
 
 void redis_parser::redis_simple_string::marshalling(::dsn::binary_writer &write_stream) const
@@ -1358,11 +1829,7 @@ void redis_parser::redis_bulk_string::marshalling(::dsn::binary_writer &write_st
               "{} VS {}",
               data.length(),
               length);
-    write_stream.write_pod('$');
-    std::string length_str = std::to_string(length);
-    write_stream.write(length_str.c_str(), (int)length_str.length());
-    write_stream.write_pod(CR);
-    write_stream.write_pod(LF);
+    write_line(write_stream, '$', length);
     if (length >= 0) {
         write_stream.write(data.data(), length);
         write_stream.write_pod(CR);
@@ -1376,11 +1843,7 @@ void redis_parser::redis_array::marshalling(::dsn::binary_writer &write_stream)
               "{} VS {}",
               array.size(),
               count);
-    write_stream.write_pod('*');
-    std::string count_str = std::to_string(count);
-    write_stream.write(count_str.c_str(), (int)count_str.length());
-    write_stream.write_pod(CR);
-    write_stream.write_pod(LF);
+    write_line(write_stream, '*', count);
     for (const auto &elem : array) {
         elem->marshalling(write_stream);
     }
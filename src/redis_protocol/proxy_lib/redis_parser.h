@@ -21,6 +21,7 @@
 
 #include <queue>
 #include <deque>
+#include <functional>
 #include <list>
 #include "proxy_layer.h"
 #include "geo/lib/geo_client.h"
@@ -140,8 +141,9 @@ private:
     // data stream content
     std::queue<dsn::message_ex *> _recv_buffers;
     size_t _total_length;
-    char *_current_buffer;
-    size_t _current_buffer_length;
+    // the buffer of _recv_buffers.front() under parsing, it shares memory with the message so
+    // that bulk strings can be sliced out of it without copying
+    dsn::blob _current_buffer;
     size_t _current_cursor;
     // ]
 
@@ -156,6 +158,8 @@ protected:
     char peek();
     bool eat(char c);
     void eat_all(char *dest, size_t length);
+    dsn::blob eat_bulk_string_data(size_t length);
+    void eat_size_line();
     void reset_parser();
 
     // function for parser
@@ -177,6 +181,10 @@ protected:
     DECLARE_REDIS_HANDLER(del)
     DECLARE_REDIS_HANDLER(setex)
     DECLARE_REDIS_HANDLER(ttl)
+    DECLARE_REDIS_HANDLER(mget)
+    DECLARE_REDIS_HANDLER(mset)
+    DECLARE_REDIS_HANDLER(exists)
+    DECLARE_REDIS_HANDLER(expire)
     DECLARE_REDIS_HANDLER(geo_add)
     DECLARE_REDIS_HANDLER(geo_dist)
     DECLARE_REDIS_HANDLER(geo_pos)
@@ -192,6 +200,39 @@ protected:
     void set_geo_internal(message_entry &entry);
     void del_internal(message_entry &entry);
     void del_geo_internal(message_entry &entry);
+    void del_multi_keys(message_entry &entry);
+    void expire_existing_key(message_entry &entry, const ::dsn::blob &value, int ttl_seconds);
+
+    // state shared by the sub requests which a multi-key command is split into, the reply of
+    // the command is built by 'on_finished' once all the sub requests are done
+    struct multi_key_context
+    {
+        multi_key_context(size_t key_count, int request_count)
+            : values(key_count), pending_requests(request_count)
+        {
+        }
+
+        // values of the keys in the order of the command, nil for the missing ones
+        std::vector<redis_bulk_string> values;
+        std::atomic<int> pending_requests;
+        std::function<void(multi_key_context &)> on_finished;
+
+        // the first error of the sub requests, empty if all of them succeed
+        dsn::zlock error_lock;
+        std::string error;
+
+        void set_error(std::string &&err);
+        void finish_request();
+    };
+
+    // read the keys sub_requests[1..] of 'entry'. keys located in the same partition are packed
+    // into one batch_get, so a MGET on n keys costs at most one rpc per partition.
+    void batch_get_internal(message_entry &entry,
+                            const char *command,
+                            std::function<void(multi_key_context &)> &&on_finished);
+    static std::vector<std::vector<size_t>>
+    group_keys_by_partition(const std::vector<redis_bulk_string> &keys,
+                            const std::function<int(const ::dsn::blob &)> &get_partition_index);
     void counter_internal(message_entry &entry);
     static void parse_set_parameters(const std::vector<redis_bulk_string> &opts, int &ttl_seconds);
     static void parse_geo_radius_parameters(const std::vector<redis_bulk_string> &opts,
@@ -246,6 +287,9 @@ protected:
     static const char CR;
     static const char LF;
 
+    // write "<prefix><value>\r\n" of RESP
+    static void write_line(::dsn::binary_writer &write_stream, char prefix, int64_t value);
+
 public:
     redis_parser(proxy_stub *op, dsn::message_ex *first_msg);
     ~redis_parser() override;
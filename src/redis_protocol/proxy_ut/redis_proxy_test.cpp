@@ -18,6 +18,7 @@
  */
 
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <string>
 #include <boost/asio.hpp>
@@ -133,6 +134,7 @@ protected:
         }
 
         _got_a_message = true;
+        _last_request = act_request;
         ++_entry_index;
     }
 
@@ -147,10 +149,13 @@ private:
     FRIEND_TEST(proxy_test, test_nil_bulk_string);
     FRIEND_TEST(proxy_test, test_random_cases);
     FRIEND_TEST(proxy_test, test_parse_parameters);
+    FRIEND_TEST(proxy_test, test_group_keys_by_partition);
+    FRIEND_TEST(proxy_test, test_zero_copy_bulk_string);
 
     std::vector<std::unique_ptr<message_entry>> _reserved_entry;
     int _entry_index;
     bool _got_a_message;
+    redis_request _last_request;
 };
 
 class proxy_test : public ::testing::Test
@@ -174,6 +179,7 @@ public:
     bool parse(dsn::message_ex *msg) { return _parser->parse(msg); }
     bool got_message() { return _parser->_got_a_message; }
     int parsed_entry_count() { return _parser->_entry_index; }
+    const redis_parser::redis_request &last_request() { return _parser->_last_request; }
 
 private:
     std::shared_ptr<redis_test_parser> _parser;
@@ -499,6 +505,53 @@ TEST_F(proxy_test, test_parse_parameters)
     }
 }
 
+TEST_F(proxy_test, test_zero_copy_bulk_string)
+{
+    set_msg(0, redis_test_parser::redis_request(3, {{"SET"}, {"foo"}, {"bar"}}));
+    set_msg(1, redis_test_parser::redis_request(3, {{"SET"}, {"foo"}, {"barbar"}}));
+
+    // bulk strings are sliced out of a message owning its buffer
+    dsn::blob data = dsn::blob::create_from_bytes(
+        std::string("*3\r\n$3\r\nSET\r\n$3\r\nfoo\r\n$3\r\nbar\r\n"));
+    auto request = dsn::message_ex::create_receive_message_with_standalone_header(data);
+    ASSERT_TRUE(parse(request));
+    ASSERT_EQ(1, parsed_entry_count());
+    const dsn::blob &value = last_request().sub_requests[2].data;
+    ASSERT_EQ(data.buffer_ptr(), value.buffer_ptr());
+    ASSERT_EQ("bar", value.to_string());
+
+    // a bulk string across buffers is copied
+    dsn::blob data1 = dsn::blob::create_from_bytes(std::string("*3\r\n$3\r\nSET\r\n$3\r\nfoo"));
+    dsn::blob data2 = dsn::blob::create_from_bytes(std::string("\r\n$6\r\nbar"));
+    dsn::blob data3 = dsn::blob::create_from_bytes(std::string("bar\r\n"));
+    auto request1 = dsn::message_ex::create_receive_message_with_standalone_header(data1);
+    auto request2 = dsn::message_ex::create_receive_message_with_standalone_header(data2);
+    auto request3 = dsn::message_ex::create_receive_message_with_standalone_header(data3);
+    ASSERT_TRUE(parse(request1));
+    ASSERT_TRUE(parse(request2));
+    ASSERT_TRUE(parse(request3));
+    ASSERT_EQ(2, parsed_entry_count());
+    ASSERT_EQ("barbar", last_request().sub_requests[2].data.to_string());
+}
+
+TEST_F(proxy_test, test_group_keys_by_partition)
+{
+    std::vector<redis_test_parser::redis_bulk_string> keys(
+        {{"MGET"}, {"k0"}, {"k1"}, {"k2"}, {"k3"}, {"k0"}});
+    std::map<std::string, int> partitions({{"k0", 1}, {"k1", 0}, {"k2", 1}, {"k3", 2}});
+
+    auto groups = redis_test_parser::group_keys_by_partition(
+        keys, [&partitions](const dsn::blob &key) { return partitions[key.to_string()]; });
+    std::vector<std::vector<size_t>> expected({{0, 2, 4}, {1}, {3}});
+    ASSERT_EQ(expected, groups);
+
+    // keys are sent alone while the partition count is unknown
+    groups = redis_test_parser::group_keys_by_partition(
+        keys, [](const dsn::blob &) { return -1; });
+    expected = {{0}, {1}, {2}, {3}, {4}};
+    ASSERT_EQ(expected, groups);
+}
+
 TEST(proxy, connection)
 {
     ::dsn::rpc_address redis_address("127.0.0.1", 12345);
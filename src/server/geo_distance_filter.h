@@ -0,0 +1,144 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include <dsn/utility/string_conv.h>
+#include <dsn/utility/string_view.h>
+#include <rrdb/rrdb_types.h>
+
+namespace pegasus {
+namespace server {
+
+// Evaluates dsn::apps::geo_scan_filter on the user data of the scanned values, so that only
+// the points within the search circle of geo_client are returned.
+//
+// The coordinates are extracted the same way as geo::latlng_codec, and the distance is
+// calculated by the haversine formula on the sphere used by S2Earth, without depending on S2.
+class geo_distance_filter
+{
+public:
+    // Returns false if `filter` is invalid.
+    static bool validate(const ::dsn::apps::geo_scan_filter &filter)
+    {
+        return filter.radius_m > 0 && filter.latitude_index >= 0 &&
+               filter.longitude_index >= 0 && filter.latitude_index != filter.longitude_index &&
+               valid_latlng(filter.center_lat, filter.center_lng);
+    }
+
+    explicit geo_distance_filter(const ::dsn::apps::geo_scan_filter &filter)
+        : _center_lat(to_radians(filter.center_lat)),
+          _center_lng(to_radians(filter.center_lng)),
+          _cos_center_lat(std::cos(_center_lat)),
+          _radius(filter.radius_m / kEarthRadiusMeters + kRadiusSlack),
+          _latlng_order(filter.latitude_index < filter.longitude_index),
+          _first_index(std::min(filter.latitude_index, filter.longitude_index)),
+          _second_index(std::max(filter.latitude_index, filter.longitude_index)),
+          _limit(filter.limit)
+    {
+    }
+
+    // Returns true if the point in `user_data` is within the circle. Values which can't be
+    // decoded are filtered out, as geo_client does.
+    bool match(dsn::string_view user_data) const
+    {
+        dsn::string_view first, second;
+        if (!extract(user_data, first, second)) {
+            return false;
+        }
+
+        double lat_degrees = 0.0;
+        double lng_degrees = 0.0;
+        if (!dsn::buf2double(_latlng_order ? first : second, lat_degrees) ||
+            !dsn::buf2double(_latlng_order ? second : first, lng_degrees) ||
+            !valid_latlng(lat_degrees, lng_degrees)) {
+            return false;
+        }
+
+        double lat = to_radians(lat_degrees);
+        double lng = to_radians(lng_degrees);
+        double dlat = std::sin(0.5 * (lat - _center_lat));
+        double dlng = std::sin(0.5 * (lng - _center_lng));
+        double x = dlat * dlat + dlng * dlng * _cos_center_lat * std::cos(lat);
+        return 2 * std::asin(std::sqrt(std::min(1.0, x))) <= _radius;
+    }
+
+    // Called for every value returned, returns true once the limit is reached.
+    bool add_matched()
+    {
+        ++_matched;
+        return _limit >= 0 && _matched >= _limit;
+    }
+
+private:
+    // the same as S2Earth::RadiusMeters()
+    static constexpr double kEarthRadiusMeters = 6371010.0;
+    // tolerates rounding errors near the edge, geo_client checks the distance again anyway
+    static constexpr double kRadiusSlack = 1e-12;
+
+    static double to_radians(double degrees) { return degrees * M_PI / 180; }
+
+    static bool valid_latlng(double lat_degrees, double lng_degrees)
+    {
+        return std::fabs(lat_degrees) <= 90 && std::fabs(lng_degrees) <= 180;
+    }
+
+    // Extracts the fields at _first_index and _second_index of `value` split by '|'.
+    bool extract(dsn::string_view value, dsn::string_view &first, dsn::string_view &second) const
+    {
+        int index = 0;
+        size_t begin = 0;
+        while (index <= _second_index) {
+            size_t end = value.find("|", begin);
+            if (end == dsn::string_view::npos) {
+                end = value.size();
+            }
+            if (index == _first_index) {
+                first = value.substr(begin, end - begin);
+            } else if (index == _second_index) {
+                second = value.substr(begin, end - begin);
+                return true;
+            }
+            if (end == value.size()) {
+                return false;
+            }
+            begin = end + 1;
+            ++index;
+        }
+        return false;
+    }
+
+    const double _center_lat;
+    const double _center_lng;
+    const double _cos_center_lat;
+    // in radians
+    const double _radius;
+    const bool _latlng_order;
+    const int _first_index;
+    const int _second_index;
+    const int _limit;
+    int _matched = 0;
+};
+
+} // namespace server
+} // namespace pegasus
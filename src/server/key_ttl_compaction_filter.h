@@ -188,6 +188,11 @@ public:
         dsn::utils::auto_write_lock l(_lock);
         _user_specified_operations.clear();
     }
+    bool has_user_specified_ops()
+    {
+        dsn::utils::auto_read_lock l(_lock);
+        return !_user_specified_operations.empty();
+    }
 
 private:
     std::atomic<uint32_t> _pegasus_data_version;
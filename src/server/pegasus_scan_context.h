@@ -19,7 +19,9 @@
 
 #pragma once
 
+#include <list>
 #include <map>
+#include <unordered_map>
 #include <rocksdb/db.h>
 #include <dsn/tool_api.h>
 #include <dsn/utility/rand.h>
@@ -27,6 +29,7 @@
 
 #include "base/pegasus_const.h"
 #include "base/pegasus_utils.h"
+#include "geo_distance_filter.h"
 
 namespace pegasus {
 namespace server {
@@ -80,8 +83,18 @@ public:
     bool no_value;
     bool validate_partition_hash;
     bool return_expire_ts;
+    // set if the scan is from geo_client, see geo_distance_filter
+    std::unique_ptr<geo_distance_filter> geo_filter;
 };
 
+// Holds the contexts of incomplete scans between batches.
+//
+// Every scan context holds a rocksdb iterator, which pins the memtables and sst files of
+// its super version, so the contexts must not be kept for too long. All contexts share
+// the same time-to-live and are refreshed on every batch (fetched and put again), so the
+// contexts are kept in a list ordered by their last put time: the oldest ones are always
+// at the front, which makes both expiration and eviction by count O(1) per context,
+// without scheduling a delayed task for every batch.
 class pegasus_context_cache
 {
 public:
@@ -104,15 +117,22 @@ public:
 
     void clear()
     {
-        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
-        _map.clear();
+        std::list<entry> cleared;
+        {
+            ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
+            _map.clear();
+            cleared.swap(_lru);
+        }
+        // the iterators are released out of the lock
     }
 
     int64_t put(std::unique_ptr<pegasus_scan_context> context)
     {
+        uint64_t now_ms = dsn_now_ms();
         ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
         int64_t handle = _counter++;
-        _map[handle] = std::move(context);
+        _lru.push_back(entry{handle, now_ms, std::move(context)});
+        _map[handle] = std::prev(_lru.end());
         return handle;
     }
 
@@ -122,15 +142,53 @@ public:
         auto kv = _map.find(handle);
         if (kv == _map.end())
             return nullptr;
-        std::unique_ptr<pegasus_scan_context> ret = std::move(kv->second);
+        std::unique_ptr<pegasus_scan_context> ret = std::move(kv->second->context);
+        _lru.erase(kv->second);
         _map.erase(kv);
         return ret;
     }
 
+    // Removes the contexts which were put more than `ttl_ms` milliseconds ago, and then the
+    // least recently put ones until at most `max_count` contexts are left.
+    // Returns the count of removed contexts.
+    size_t evict(uint64_t ttl_ms, size_t max_count)
+    {
+        uint64_t now_ms = dsn_now_ms();
+        std::list<entry> evicted;
+        {
+            ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
+            auto it = _lru.begin();
+            size_t left = _lru.size();
+            while (it != _lru.end() && (left > max_count || it->put_time_ms + ttl_ms <= now_ms)) {
+                _map.erase(it->handle);
+                ++it;
+                --left;
+            }
+            evicted.splice(evicted.end(), _lru, _lru.begin(), it);
+        }
+        // the iterators are released out of the lock
+        return evicted.size();
+    }
+
+    size_t size() const
+    {
+        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
+        return _map.size();
+    }
+
 private:
+    struct entry
+    {
+        int64_t handle;
+        uint64_t put_time_ms;
+        std::unique_ptr<pegasus_scan_context> context;
+    };
+
     int64_t _counter;
-    std::unordered_map<int64_t, std::unique_ptr<pegasus_scan_context>> _map;
-    ::dsn::utils::ex_lock_nr_spin _lock;
+    // ordered by put time, the oldest at the front
+    std::list<entry> _lru;
+    std::unordered_map<int64_t, std::list<entry>::iterator> _map;
+    mutable ::dsn::utils::ex_lock_nr_spin _lock;
 };
 }
 }
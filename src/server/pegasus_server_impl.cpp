@@ -48,8 +48,30 @@ namespace pegasus {
 namespace server {
 
 DEFINE_TASK_CODE(LPC_PEGASUS_SERVER_DELAY, TASK_PRIORITY_COMMON, ::dsn::THREAD_POOL_DEFAULT)
+DEFINE_TASK_CODE(LPC_PEGASUS_SCAN_CONTEXT_EVICT_TIMER,
+                 TASK_PRIORITY_COMMON,
+                 ::dsn::THREAD_POOL_DEFAULT)
 DSN_DECLARE_int32(read_amp_bytes_per_bit);
 
+DSN_DEFINE_uint64("pegasus.server",
+                  scan_context_ttl_seconds,
+                  300,
+                  "the scan contexts which are not used for more than this many seconds will "
+                  "be removed, so that the rocksdb iterators held by them are released");
+DSN_TAG_VARIABLE(scan_context_ttl_seconds, FT_MUTABLE);
+
+DSN_DEFINE_uint64("pegasus.server",
+                  max_scan_contexts_per_replica,
+                  2000,
+                  "max count of scan contexts held by a replica, the least recently used ones "
+                  "will be removed once exceeded");
+DSN_TAG_VARIABLE(max_scan_contexts_per_replica, FT_MUTABLE);
+
+DSN_DEFINE_uint32("pegasus.server",
+                  scan_context_evict_interval_seconds,
+                  10,
+                  "interval in seconds to remove the expired scan contexts of a replica");
+
 DSN_DEFINE_int32("pegasus.server",
                  hotkey_analyse_time_interval_s,
                  10,
@@ -283,11 +305,12 @@ void pegasus_server_impl::on_get(get_rpc rpc)
     }
 
     rocksdb::Slice skey(key.data(), key.length());
-    std::string value;
-    rocksdb::Status status = _db->Get(_data_cf_rd_opts, _data_cf, skey, &value);
+    // the value stays pinned until the response holding it is released
+    auto value = std::make_shared<rocksdb::PinnableSlice>();
+    rocksdb::Status status = _db->Get(_data_cf_rd_opts, _data_cf, skey, value.get());
 
     if (status.ok()) {
-        if (check_if_record_expired(utils::epoch_now(), value)) {
+        if (check_if_record_expired(utils::epoch_now(), *value)) {
             _pfc_recent_expire_count->increment();
             if (_verbose_log) {
                 derror("%s: rocksdb data expired for get from %s",
@@ -324,7 +347,7 @@ void pegasus_server_impl::on_get(get_rpc rpc)
 #endif
 
     uint64_t time_used = dsn_now_ns() - start_time;
-    if (is_get_abnormal(time_used, value.size())) {
+    if (is_get_abnormal(time_used, value->size())) {
         ::dsn::blob hash_key, sort_key;
         pegasus_restore_key(key, hash_key, sort_key);
         dwarn_replica("rocksdb abnormal get from {}: "
@@ -334,14 +357,15 @@ void pegasus_server_impl::on_get(get_rpc rpc)
                       ::pegasus::utils::c_escape_string(hash_key),
                       ::pegasus::utils::c_escape_string(sort_key),
                       status.ToString(),
-                      value.size(),
+                      value->size(),
                       time_used);
         _pfc_recent_abnormal_count->increment();
     }
 
     resp.error = status.code();
     if (status.ok()) {
-        pegasus_extract_user_data(_pegasus_data_version, std::move(value), resp.value);
+        pegasus_extract_user_data(
+            _pegasus_data_version, value, utils::to_string_view(*value), resp.value);
     }
 
     _cu_calculator->add_get_cu(rpc.dsn_request(), resp.error, key, resp.value);
@@ -654,7 +678,6 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
         bool exceed_limit = false;
         std::vector<::dsn::blob> keys_holder;
         std::vector<rocksdb::Slice> keys;
-        std::vector<std::string> values;
         keys_holder.reserve(request.sort_keys.size());
         keys.reserve(request.sort_keys.size());
         for (auto &sort_key : request.sort_keys) {
@@ -664,10 +687,13 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
             keys_holder.emplace_back(std::move(raw_key));
         }
 
-        std::vector<rocksdb::Status> statuses = _db->MultiGet(_data_cf_rd_opts, keys, &values);
+        // the values stay pinned until all the responses holding them are released
+        auto values = std::make_shared<std::vector<rocksdb::PinnableSlice>>(keys.size());
+        std::vector<rocksdb::Status> statuses;
+        batch_get_from_data_cf(keys, *values, statuses);
         for (int i = 0; i < keys.size(); i++) {
             rocksdb::Status &status = statuses[i];
-            std::string &value = values[i];
+            const rocksdb::PinnableSlice &value = (*values)[i];
             // print log
             if (!status.ok()) {
                 if (_verbose_log) {
@@ -687,8 +713,7 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
             }
             // check ttl
             if (status.ok()) {
-                uint32_t expire_ts = pegasus_extract_expire_ts(_pegasus_data_version, value);
-                if (expire_ts > 0 && expire_ts <= epoch_now) {
+                if (check_if_record_expired(epoch_now, value)) {
                     expire_count++;
                     if (_verbose_log) {
                         derror("%s: rocksdb data expired for multi_get from %s",
@@ -708,7 +733,8 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
                 ::dsn::apps::key_value kv;
                 kv.key = request.sort_keys[i];
                 if (!request.no_value) {
-                    pegasus_extract_user_data(_pegasus_data_version, std::move(value), kv.value);
+                    pegasus_extract_user_data(
+                        _pegasus_data_version, values, utils::to_string_view(value), kv.value);
                 }
                 count++;
                 size += kv.key.length() + kv.value.length();
@@ -819,8 +845,10 @@ void pegasus_server_impl::on_batch_get(batch_get_rpc rpc)
     bool error_occurred = false;
     int64_t total_data_size = 0;
     uint32_t epoch_now = pegasus::utils::epoch_now();
-    std::vector<std::string> values;
-    std::vector<rocksdb::Status> statuses = _db->MultiGet(_data_cf_rd_opts, keys, &values);
+    // the values stay pinned until all the responses holding them are released
+    auto values = std::make_shared<std::vector<rocksdb::PinnableSlice>>(keys.size());
+    std::vector<rocksdb::Status> statuses;
+    batch_get_from_data_cf(keys, *values, statuses);
     response.data.reserve(request.keys.size());
     for (int i = 0; i < keys.size(); i++) {
         const auto &status = statuses[i];
@@ -830,7 +858,7 @@ void pegasus_server_impl::on_batch_get(batch_get_rpc rpc)
 
         const ::dsn::blob &hash_key = request.keys[i].hash_key;
         const ::dsn::blob &sort_key = request.keys[i].sort_key;
-        std::string &value = values[i];
+        const rocksdb::PinnableSlice &value = (*values)[i];
 
         if (dsn_likely(status.ok())) {
             if (check_if_record_expired(epoch_now, value)) {
@@ -845,7 +873,8 @@ void pegasus_server_impl::on_batch_get(batch_get_rpc rpc)
             }
 
             dsn::blob real_value;
-            pegasus_extract_user_data(_pegasus_data_version, std::move(value), real_value);
+            pegasus_extract_user_data(
+                _pegasus_data_version, values, utils::to_string_view(value), real_value);
             dsn::apps::full_data current_data;
             current_data.hash_key = hash_key;
             current_data.sort_key = sort_key;
@@ -893,6 +922,27 @@ void pegasus_server_impl::on_batch_get(batch_get_rpc rpc)
     _pfc_batch_get_latency->set(time_used);
 }
 
+void pegasus_server_impl::batch_get_from_data_cf(const std::vector<rocksdb::Slice> &keys,
+                                                 std::vector<rocksdb::PinnableSlice> &values,
+                                                 std::vector<rocksdb::Status> &statuses)
+{
+    dcheck_eq_replica(values.size(), keys.size());
+
+    statuses.resize(keys.size());
+    if (keys.empty()) {
+        return;
+    }
+    // The batched interface sorts the keys internally, so that lookups falling into the
+    // same data block share one block read, and pins the values instead of copying them.
+    _db->MultiGet(_data_cf_rd_opts,
+                  _data_cf,
+                  keys.size(),
+                  keys.data(),
+                  values.data(),
+                  statuses.data(),
+                  /*sorted_input=*/false);
+}
+
 void pegasus_server_impl::on_sortkey_count(sortkey_count_rpc rpc)
 {
     dassert(_is_open, "");
@@ -1087,6 +1137,26 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
 
         return;
     }
+    std::unique_ptr<geo_distance_filter> geo_filter;
+    if (request.__isset.geo_filter) {
+        if (!geo_distance_filter::validate(request.geo_filter)) {
+            derror_replica("invalid argument for get_scanner from {}: invalid geo filter, "
+                           "center = ({}, {}), radius_m = {}, latitude_index = {}, "
+                           "longitude_index = {}",
+                           rpc.remote_address().to_string(),
+                           request.geo_filter.center_lat,
+                           request.geo_filter.center_lng,
+                           request.geo_filter.radius_m,
+                           request.geo_filter.latitude_index,
+                           request.geo_filter.longitude_index);
+            resp.error = rocksdb::Status::kInvalidArgument;
+            _cu_calculator->add_scan_cu(req, resp.error, resp.kvs);
+            _pfc_scan_latency->set(dsn_now_ns() - start_time);
+
+            return;
+        }
+        geo_filter = dsn::make_unique<geo_distance_filter>(request.geo_filter);
+    }
 
     rocksdb::ReadOptions rd_opts(_data_cf_rd_opts);
     if (_data_cf_opts.prefix_extractor) {
@@ -1198,7 +1268,8 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
             epoch_now,
             request.no_value,
             request.__isset.validate_partition_hash ? request.validate_partition_hash : true,
-            return_expire_ts);
+            return_expire_ts,
+            geo_filter.get());
         switch (state) {
         case range_iteration_state::kNormal:
             count++;
@@ -1213,6 +1284,13 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
             break;
         }
 
+        if (geo_filter != nullptr && state == range_iteration_state::kNormal &&
+            geo_filter->add_matched()) {
+            // enough values are found for the geo search
+            complete = true;
+            break;
+        }
+
         if (c == 0) {
             // seek to the last position
             complete = true;
@@ -1275,16 +1353,10 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
             request.no_value,
             request.__isset.validate_partition_hash ? request.validate_partition_hash : true,
             return_expire_ts));
-        int64_t handle = _context_cache.put(std::move(context));
-        resp.context_id = handle;
+        context->geo_filter = std::move(geo_filter);
         // if the context is used, it will be fetched and re-put into cache,
-        // which will change the handle,
-        // then the delayed task will fetch null context by old handle, and do nothing.
-        ::dsn::tasking::enqueue(LPC_PEGASUS_SERVER_DELAY,
-                                &_tracker,
-                                [this, handle]() { _context_cache.fetch(handle); },
-                                0,
-                                std::chrono::minutes(5));
+        // which will change the handle.
+        resp.context_id = put_scan_context(std::move(context));
     } else {
         // scan completed
         resp.context_id = pegasus::SCAN_CONTEXT_ID_COMPLETED;
@@ -1331,6 +1403,7 @@ void pegasus_server_impl::on_scan(scan_rpc rpc)
         bool no_value = context->no_value;
         bool validate_hash = context->validate_partition_hash;
         bool return_expire_ts = context->return_expire_ts;
+        geo_distance_filter *geo_filter = context->geo_filter.get();
         bool complete = false;
         uint32_t epoch_now = ::pegasus::utils::epoch_now();
         uint64_t expire_count = 0;
@@ -1365,7 +1438,8 @@ void pegasus_server_impl::on_scan(scan_rpc rpc)
                                                    epoch_now,
                                                    no_value,
                                                    validate_hash,
-                                                   return_expire_ts);
+                                                   return_expire_ts,
+                                                   geo_filter);
             switch (state) {
             case range_iteration_state::kNormal:
                 count++;
@@ -1380,6 +1454,13 @@ void pegasus_server_impl::on_scan(scan_rpc rpc)
                 break;
             }
 
+            if (geo_filter != nullptr && state == range_iteration_state::kNormal &&
+                geo_filter->add_matched()) {
+                // enough values are found for the geo search
+                complete = true;
+                break;
+            }
+
             if (c == 0) {
                 // seek to the last position
                 complete = true;
@@ -1427,13 +1508,7 @@ void pegasus_server_impl::on_scan(scan_rpc rpc)
                           limiter->max_duration_time());
         } else if (it->Valid() && !complete) {
             // scan not completed
-            int64_t handle = _context_cache.put(std::move(context));
-            resp.context_id = handle;
-            ::dsn::tasking::enqueue(LPC_PEGASUS_SERVER_DELAY,
-                                    &_tracker,
-                                    [this, handle]() { _context_cache.fetch(handle); },
-                                    0,
-                                    std::chrono::minutes(5));
+            resp.context_id = put_scan_context(std::move(context));
         } else {
             // scan completed
             resp.context_id = pegasus::SCAN_CONTEXT_ID_COMPLETED;
@@ -1455,6 +1530,25 @@ void pegasus_server_impl::on_scan(scan_rpc rpc)
 
 void pegasus_server_impl::on_clear_scanner(const int64_t &args) { _context_cache.fetch(args); }
 
+int64_t pegasus_server_impl::put_scan_context(std::unique_ptr<pegasus_scan_context> context)
+{
+    int64_t handle = _context_cache.put(std::move(context));
+    // keep the cache within its capacity on every put, the contexts of idle replicas are
+    // removed by the periodic eviction
+    evict_scan_contexts();
+    return handle;
+}
+
+void pegasus_server_impl::evict_scan_contexts()
+{
+    size_t evicted = _context_cache.evict(FLAGS_scan_context_ttl_seconds * 1000,
+                                          FLAGS_max_scan_contexts_per_replica);
+    if (evicted > 0) {
+        _pfc_recent_scan_context_evict_count->add(evicted);
+    }
+    _pfc_scan_context_count->set(_context_cache.size());
+}
+
 dsn::error_code pegasus_server_impl::start(int argc, char **argv)
 {
     dassert_replica(!_is_open, "replica is already opened.");
@@ -1703,6 +1797,12 @@ dsn::error_code pegasus_server_impl::start(int argc, char **argv)
         update_usage_scenario(envs);
     }
 
+    _evict_scan_context_timer = dsn::tasking::enqueue_timer(
+        LPC_PEGASUS_SCAN_CONTEXT_EVICT_TIMER,
+        &_tracker,
+        [this]() { evict_scan_contexts(); },
+        std::chrono::seconds(FLAGS_scan_context_evict_interval_seconds));
+
     dinfo_replica("start the update replica-level rocksdb statistics timer task");
     _update_replica_rdb_stat =
         dsn::tasking::enqueue_timer(LPC_REPLICATION_LONG_COMMON,
@@ -1765,6 +1865,10 @@ void pegasus_server_impl::cancel_background_work(bool wait)
     cancel_background_work(true);
 
     // stop all tracked tasks when pegasus server is stopped.
+    if (_evict_scan_context_timer != nullptr) {
+        _evict_scan_context_timer->cancel(true);
+        _evict_scan_context_timer = nullptr;
+    }
     if (_update_replica_rdb_stat != nullptr) {
         _update_replica_rdb_stat->cancel(true);
         _update_replica_rdb_stat = nullptr;
@@ -2274,7 +2378,8 @@ pegasus_server_impl::append_key_value_for_scan(std::vector<::dsn::apps::key_valu
                                                uint32_t epoch_now,
                                                bool no_value,
                                                bool request_validate_hash,
-                                               bool request_expire_ts)
+                                               bool request_expire_ts,
+                                               const geo_distance_filter *geo_filter)
 {
     if (check_if_record_expired(epoch_now, value)) {
         if (_verbose_log) {
@@ -2316,6 +2421,11 @@ pegasus_server_impl::append_key_value_for_scan(std::vector<::dsn::apps::key_valu
             return range_iteration_state::kFiltered;
         }
     }
+    if (geo_filter != nullptr &&
+        !geo_filter->match(pegasus_extract_user_data_view(_pegasus_data_version,
+                                                          utils::to_string_view(value)))) {
+        return range_iteration_state::kFiltered;
+    }
     std::shared_ptr<char> key_buf(::dsn::utils::make_shared_array<char>(raw_key.length()));
     ::memcpy(key_buf.get(), raw_key.data(), raw_key.length());
     kv.key.assign(std::move(key_buf), 0, raw_key.length());
@@ -235,7 +235,8 @@ private:
                               uint32_t epoch_now,
                               bool no_value,
                               bool request_validate_hash,
-                              bool request_expire_ts);
+                              bool request_expire_ts,
+                              const geo_distance_filter *geo_filter);
 
     range_iteration_state
     append_key_value_for_multi_get(std::vector<::dsn::apps::key_value> &kvs,
@@ -246,6 +247,18 @@ private:
                                    uint32_t epoch_now,
                                    bool no_value);
 
+    // Looks up `keys` in the data column family with one batched MultiGet.
+    // `values` must have the same size as `keys`, `statuses` is resized to match.
+    void batch_get_from_data_cf(const std::vector<rocksdb::Slice> &keys,
+                                std::vector<rocksdb::PinnableSlice> &values,
+                                std::vector<rocksdb::Status> &statuses);
+
+    // put the context of an incomplete scan into the cache, return its handle
+    int64_t put_scan_context(std::unique_ptr<pegasus_scan_context> context);
+
+    // remove the expired scan contexts, and the oldest ones if the cache exceeds its capacity
+    void evict_scan_contexts();
+
     // return true if the filter type is supported
     bool is_filter_type_supported(::dsn::apps::filter_type::type filter_type)
     {
@@ -445,6 +458,7 @@ private:
     pegasus_context_cache _context_cache;
 
     std::chrono::seconds _update_rdb_stat_interval;
+    ::dsn::task_ptr _evict_scan_context_timer;
     ::dsn::task_ptr _update_replica_rdb_stat;
     static ::dsn::task_ptr _update_server_rdb_stat;
 
@@ -477,6 +491,8 @@ private:
     ::dsn::perf_counter_wrapper _pfc_recent_expire_count;
     ::dsn::perf_counter_wrapper _pfc_recent_filter_count;
     ::dsn::perf_counter_wrapper _pfc_recent_abnormal_count;
+    ::dsn::perf_counter_wrapper _pfc_scan_context_count;
+    ::dsn::perf_counter_wrapper _pfc_recent_scan_context_evict_count;
 
     // rocksdb internal statistics
     // server level
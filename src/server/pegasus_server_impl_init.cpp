@@ -669,6 +669,17 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
                                                 COUNTER_TYPE_VOLATILE_NUMBER,
                                                 "statistic the recent abnormal read count");
 
+    snprintf(name, 255, "scan.context.count@%s", str_gpid.c_str());
+    _pfc_scan_context_count.init_app_counter(
+        "app.pegasus", name, COUNTER_TYPE_NUMBER, "statistic the count of cached scan contexts");
+
+    snprintf(name, 255, "recent.scan.context.evict.count@%s", str_gpid.c_str());
+    _pfc_recent_scan_context_evict_count.init_app_counter(
+        "app.pegasus",
+        name,
+        COUNTER_TYPE_VOLATILE_NUMBER,
+        "statistic the recent count of scan contexts removed for expiration or capacity");
+
     snprintf(name, 255, "disk.storage.sst.count@%s", str_gpid.c_str());
     _pfc_rdb_sst_count.init_app_counter(
         "app.pegasus", name, COUNTER_TYPE_NUMBER, "statistic the count of sstable files");
@@ -20,6 +20,7 @@
 #include <dsn/cpp/message_utils.h>
 #include <dsn/dist/replication/duplication_common.h>
 #include <dsn/utility/defer.h>
+#include <dsn/utility/flags.h>
 
 #include "base/pegasus_key_schema.h"
 #include "pegasus_server_write.h"
@@ -30,6 +31,37 @@
 namespace pegasus {
 namespace server {
 
+// Every replica of a partition must be able to apply the batches formed by the primary,
+// so only turn this on after all replica servers of the cluster have been upgraded.
+DSN_DEFINE_bool("pegasus.server",
+                batch_read_modify_write_enabled,
+                false,
+                "whether to batch incr/check_and_set/check_and_mutate with other writes");
+
+namespace {
+
+bool is_read_modify_write(dsn::task_code rpc_code)
+{
+    return rpc_code == dsn::apps::RPC_RRDB_RRDB_INCR ||
+           rpc_code == dsn::apps::RPC_RRDB_RRDB_CHECK_AND_SET ||
+           rpc_code == dsn::apps::RPC_RRDB_RRDB_CHECK_AND_MUTATE;
+}
+
+} // anonymous namespace
+
+/*static*/ void pegasus_server_write::init_read_modify_write_batching()
+{
+    if (!FLAGS_batch_read_modify_write_enabled) {
+        return;
+    }
+    for (dsn::task_code code : {dsn::apps::RPC_RRDB_RRDB_INCR,
+                                dsn::apps::RPC_RRDB_RRDB_CHECK_AND_SET,
+                                dsn::apps::RPC_RRDB_RRDB_CHECK_AND_MUTATE}) {
+        dsn::task_spec::get(code)->rpc_request_is_write_allow_batch = true;
+    }
+    ddebug("batching of incr/check_and_set/check_and_mutate is enabled");
+}
+
 pegasus_server_write::pegasus_server_write(pegasus_server_impl *server, bool verbose_log)
     : replica_base(server), _write_svc(new pegasus_write_service(server)), _verbose_log(verbose_log)
 {
@@ -59,8 +91,12 @@ int pegasus_server_write::on_batched_write_requests(dsn::message_ex **requests,
     }
 
     try {
-        auto iter = _non_batch_write_handlers.find(requests[0]->rpc_code());
-        if (iter != _non_batch_write_handlers.end()) {
+        // INCR, CHECK_AND_SET and CHECK_AND_MUTATE may be batched with other writes
+        // (see `init_read_modify_write_batching`), otherwise they are applied alone.
+        dsn::task_code rpc_code(requests[0]->rpc_code());
+        auto iter = _non_batch_write_handlers.find(rpc_code);
+        if (iter != _non_batch_write_handlers.end() &&
+            (count == 1 || !is_read_modify_write(rpc_code))) {
             dassert_f(count == 1, "count = {}", count);
             return iter->second(requests[0]);
         }
@@ -81,7 +117,14 @@ int pegasus_server_write::on_batched_writes(dsn::message_ex **requests, int coun
 {
     int err = 0;
     {
-        _write_svc->batch_prepare(_decree);
+        bool read_modify_write = false;
+        for (int i = 0; i < count; ++i) {
+            if (is_read_modify_write(requests[i]->rpc_code())) {
+                read_modify_write = true;
+                break;
+            }
+        }
+        _write_svc->batch_prepare(_decree, read_modify_write);
 
         for (int i = 0; i < count; ++i) {
             dassert(requests[i] != nullptr, "request[%d] is null", i);
@@ -100,6 +143,18 @@ int pegasus_server_write::on_batched_writes(dsn::message_ex **requests, int coun
                     auto rpc = remove_rpc::auto_reply(requests[i]);
                     local_err = on_single_remove_in_batch(rpc);
                     _remove_rpc_batch.emplace_back(std::move(rpc));
+                } else if (rpc_code == dsn::apps::RPC_RRDB_RRDB_INCR) {
+                    auto rpc = incr_rpc::auto_reply(requests[i]);
+                    local_err = on_single_incr_in_batch(rpc);
+                    _incr_rpc_batch.emplace_back(std::move(rpc));
+                } else if (rpc_code == dsn::apps::RPC_RRDB_RRDB_CHECK_AND_SET) {
+                    auto rpc = check_and_set_rpc::auto_reply(requests[i]);
+                    local_err = on_single_check_and_set_in_batch(rpc);
+                    _check_and_set_rpc_batch.emplace_back(std::move(rpc));
+                } else if (rpc_code == dsn::apps::RPC_RRDB_RRDB_CHECK_AND_MUTATE) {
+                    auto rpc = check_and_mutate_rpc::auto_reply(requests[i]);
+                    local_err = on_single_check_and_mutate_in_batch(rpc);
+                    _check_and_mutate_rpc_batch.emplace_back(std::move(rpc));
                 } else {
                     if (_non_batch_write_handlers.find(rpc_code) !=
                         _non_batch_write_handlers.end()) {
@@ -120,7 +175,10 @@ int pegasus_server_write::on_batched_writes(dsn::message_ex **requests, int coun
             }
         }
 
-        if (dsn_unlikely(err != 0 || _put_rpc_batch.size() + _remove_rpc_batch.size() == 0)) {
+        size_t rpc_count = _put_rpc_batch.size() + _remove_rpc_batch.size() +
+                           _incr_rpc_batch.size() + _check_and_set_rpc_batch.size() +
+                           _check_and_mutate_rpc_batch.size();
+        if (dsn_unlikely(err != 0 || rpc_count == 0)) {
             _write_svc->batch_abort(_decree, err == 0 ? -1 : err);
         } else {
             err = _write_svc->batch_commit(_decree);
@@ -130,6 +188,9 @@ int pegasus_server_write::on_batched_writes(dsn::message_ex **requests, int coun
     // reply the batched RPCs
     _put_rpc_batch.clear();
     _remove_rpc_batch.clear();
+    _incr_rpc_batch.clear();
+    _check_and_set_rpc_batch.clear();
+    _check_and_mutate_rpc_batch.clear();
     return err;
 }
 
@@ -48,6 +48,11 @@ public:
 
     void set_default_ttl(uint32_t ttl);
 
+    /// Allow INCR, CHECK_AND_SET and CHECK_AND_MUTATE to be batched with other
+    /// writes by the replication layer, if `batch_read_modify_write_enabled` is set.
+    /// Must be called before any replica is opened.
+    static void init_read_modify_write_batching();
+
 private:
     /// Delay replying for the batched requests until all of them complete.
     int on_batched_writes(dsn::message_ex **requests, int count);
@@ -66,6 +71,23 @@ private:
         return err;
     }
 
+    int on_single_incr_in_batch(incr_rpc &rpc)
+    {
+        int err = _write_svc->batch_incr(_decree, rpc.request(), rpc.response());
+        request_key_check(_decree, rpc.dsn_request(), rpc.request().key);
+        return err;
+    }
+
+    int on_single_check_and_set_in_batch(check_and_set_rpc &rpc)
+    {
+        return _write_svc->batch_check_and_set(_decree, rpc.request(), rpc.response());
+    }
+
+    int on_single_check_and_mutate_in_batch(check_and_mutate_rpc &rpc)
+    {
+        return _write_svc->batch_check_and_mutate(_decree, rpc.request(), rpc.response());
+    }
+
     // Ensure that the write request is directed to the right partition.
     // In verbose mode it will log for every request.
     void request_key_check(int64_t decree, dsn::message_ex *m, const dsn::blob &key);
@@ -81,6 +103,9 @@ private:
     std::unique_ptr<pegasus_write_service> _write_svc;
     std::vector<put_rpc> _put_rpc_batch;
     std::vector<remove_rpc> _remove_rpc_batch;
+    std::vector<incr_rpc> _incr_rpc_batch;
+    std::vector<check_and_set_rpc> _check_and_set_rpc_batch;
+    std::vector<check_and_mutate_rpc> _check_and_mutate_rpc_batch;
 
     db_write_context _write_ctx;
     int64_t _decree;
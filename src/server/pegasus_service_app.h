@@ -24,6 +24,7 @@
 #include <pegasus/version.h>
 #include <pegasus/git_commit.h>
 #include "reporter/pegasus_counter_reporter.h"
+#include "pegasus_server_write.h"
 
 namespace pegasus {
 namespace server {
@@ -43,6 +44,7 @@ public:
         std::vector<std::string> args_new(args);
         args_new.emplace_back(PEGASUS_VERSION);
         args_new.emplace_back(PEGASUS_GIT_COMMIT);
+        pegasus_server_write::init_read_modify_write_batching();
         ::dsn::error_code ret = ::dsn::replication::replication_service_app::start(args_new);
 
         if (ret == ::dsn::ERR_OK) {
@@ -232,12 +232,15 @@ int pegasus_write_service::check_and_mutate(int64_t decree,
     return err;
 }
 
-void pegasus_write_service::batch_prepare(int64_t decree)
+void pegasus_write_service::batch_prepare(int64_t decree, bool read_modify_write)
 {
     dassert(_batch_start_time == 0,
             "batch_prepare and batch_commit/batch_abort must be called in pair");
 
     _batch_start_time = dsn_now_ns();
+    if (read_modify_write) {
+        _impl->enable_batch_read_modify_write();
+    }
 }
 
 int pegasus_write_service::batch_put(const db_write_context &ctx,
@@ -274,6 +277,63 @@ int pegasus_write_service::batch_remove(int64_t decree,
     return err;
 }
 
+int pegasus_write_service::batch_incr(int64_t decree,
+                                      const dsn::apps::incr_request &update,
+                                      dsn::apps::incr_response &resp)
+{
+    dassert(_batch_start_time != 0, "batch_incr must be called after batch_prepare");
+
+    _batch_qps_perfcounters.push_back(_pfc_incr_qps.get());
+    _batch_latency_perfcounters.push_back(_pfc_incr_latency.get());
+    int err = _impl->batch_incr(decree, update, resp);
+
+    if (_server->is_primary()) {
+        _cu_calculator->add_incr_cu(resp.error, update.key);
+    }
+
+    return err;
+}
+
+int pegasus_write_service::batch_check_and_set(int64_t decree,
+                                               const dsn::apps::check_and_set_request &update,
+                                               dsn::apps::check_and_set_response &resp)
+{
+    dassert(_batch_start_time != 0, "batch_check_and_set must be called after batch_prepare");
+
+    _batch_qps_perfcounters.push_back(_pfc_check_and_set_qps.get());
+    _batch_latency_perfcounters.push_back(_pfc_check_and_set_latency.get());
+    int err = _impl->batch_check_and_set(decree, update, resp);
+
+    if (_server->is_primary()) {
+        _cu_calculator->add_check_and_set_cu(resp.error,
+                                             update.hash_key,
+                                             update.check_sort_key,
+                                             update.set_sort_key,
+                                             update.set_value);
+    }
+
+    return err;
+}
+
+int pegasus_write_service::batch_check_and_mutate(
+    int64_t decree,
+    const dsn::apps::check_and_mutate_request &update,
+    dsn::apps::check_and_mutate_response &resp)
+{
+    dassert(_batch_start_time != 0, "batch_check_and_mutate must be called after batch_prepare");
+
+    _batch_qps_perfcounters.push_back(_pfc_check_and_mutate_qps.get());
+    _batch_latency_perfcounters.push_back(_pfc_check_and_mutate_latency.get());
+    int err = _impl->batch_check_and_mutate(decree, update, resp);
+
+    if (_server->is_primary()) {
+        _cu_calculator->add_check_and_mutate_cu(
+            resp.error, update.hash_key, update.check_sort_key, update.mutate_list);
+    }
+
+    return err;
+}
+
 int pegasus_write_service::batch_commit(int64_t decree)
 {
     dassert(_batch_start_time != 0, "batch_commit must be called after batch_prepare");
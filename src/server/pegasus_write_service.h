@@ -149,7 +149,9 @@ public:
     /// For batch write.
 
     // Prepare batch write.
-    void batch_prepare(int64_t decree);
+    // `read_modify_write` should be true if the batch contains INCR, CHECK_AND_SET or
+    // CHECK_AND_MUTATE, so that they see the updates before them in the same batch.
+    void batch_prepare(int64_t decree, bool read_modify_write = false);
 
     // Add PUT record in batch write.
     // \returns 0 if success, non-0 if failure.
@@ -163,6 +165,27 @@ public:
     // NOTE that `resp` should not be moved or freed while the batch is not committed.
     int batch_remove(int64_t decree, const dsn::blob &key, dsn::apps::update_response &resp);
 
+    // Add INCR record in batch write.
+    // \returns 0 if success, non-0 if failure.
+    // NOTE that `resp` should not be moved or freed while the batch is not committed.
+    int batch_incr(int64_t decree,
+                   const dsn::apps::incr_request &update,
+                   dsn::apps::incr_response &resp);
+
+    // Add CHECK_AND_SET record in batch write.
+    // \returns 0 if success, non-0 if failure.
+    // NOTE that `resp` should not be moved or freed while the batch is not committed.
+    int batch_check_and_set(int64_t decree,
+                            const dsn::apps::check_and_set_request &update,
+                            dsn::apps::check_and_set_response &resp);
+
+    // Add CHECK_AND_MUTATE record in batch write.
+    // \returns 0 if success, non-0 if failure.
+    // NOTE that `resp` should not be moved or freed while the batch is not committed.
+    int batch_check_and_mutate(int64_t decree,
+                               const dsn::apps::check_and_mutate_request &update,
+                               dsn::apps::check_and_mutate_response &resp);
+
     // Commit batch write.
     // \returns 0 if success, non-0 if failure.
     // NOTE that if the batch contains no updates, 0 is returned.
@@ -177,6 +177,48 @@ public:
     }
 
     int incr(int64_t decree, const dsn::apps::incr_request &update, dsn::apps::incr_response &resp)
+    {
+        auto cleanup = dsn::defer([this]() { _rocksdb_wrapper->clear_up_write_batch(); });
+        int err = append_incr(decree, update, resp);
+        if (err != 0) {
+            return err;
+        }
+        return commit_read_modify_write(decree, resp.error);
+    }
+
+    int check_and_set(int64_t decree,
+                      const dsn::apps::check_and_set_request &update,
+                      dsn::apps::check_and_set_response &resp)
+    {
+        auto cleanup = dsn::defer([this]() { _rocksdb_wrapper->clear_up_write_batch(); });
+        int err = append_check_and_set(decree, update, resp);
+        if (err != 0) {
+            return err;
+        }
+        return commit_read_modify_write(decree, resp.error);
+    }
+
+    int check_and_mutate(int64_t decree,
+                         const dsn::apps::check_and_mutate_request &update,
+                         dsn::apps::check_and_mutate_response &resp)
+    {
+        auto cleanup = dsn::defer([this]() { _rocksdb_wrapper->clear_up_write_batch(); });
+        int err = append_check_and_mutate(decree, update, resp);
+        if (err != 0) {
+            return err;
+        }
+        return commit_read_modify_write(decree, resp.error);
+    }
+
+    // The read-modify-write operations below only append their updates into the write batch,
+    // without committing it. They see the uncommitted updates appended before them in the
+    // same batch.
+    // \returns 0 if success, or the rocksdb error. An invalid argument or a failed check is
+    // not an error, it's only returned to the user by `resp.error`, with nothing appended.
+
+    int append_incr(int64_t decree,
+                    const dsn::apps::incr_request &update,
+                    dsn::apps::incr_response &resp)
     {
         resp.app_id = get_gpid().get_app_id();
         resp.partition_index = get_gpid().get_partition_index();
@@ -216,8 +258,7 @@ public:
                                    decree,
                                    utils::c_escape_string(old_value));
                     resp.error = rocksdb::Status::kInvalidArgument;
-                    // we should write empty record to update rocksdb's last flushed decree
-                    return empty_put(decree);
+                    return 0;
                 }
                 new_value = old_value_int + update.increment;
                 if ((update.increment > 0 && new_value < old_value_int) ||
@@ -230,8 +271,7 @@ public:
                                    update.increment);
                     resp.error = rocksdb::Status::kInvalidArgument;
                     resp.new_value = old_value_int;
-                    // we should write empty record to update rocksdb's last flushed decree
-                    return empty_put(decree);
+                    return 0;
                 }
             }
             // set new ttl
@@ -244,23 +284,17 @@ public:
             }
         }
 
-        auto cleanup = dsn::defer([this]() { _rocksdb_wrapper->clear_up_write_batch(); });
         resp.error = _rocksdb_wrapper->write_batch_put(
             decree, update.key, std::to_string(new_value), new_expire_ts);
-        if (resp.error) {
-            return resp.error;
-        }
-
-        resp.error = _rocksdb_wrapper->write(decree);
         if (resp.error == 0) {
             resp.new_value = new_value;
         }
         return resp.error;
     }
 
-    int check_and_set(int64_t decree,
-                      const dsn::apps::check_and_set_request &update,
-                      dsn::apps::check_and_set_response &resp)
+    int append_check_and_set(int64_t decree,
+                             const dsn::apps::check_and_set_request &update,
+                             dsn::apps::check_and_set_response &resp)
     {
         resp.app_id = get_gpid().get_app_id();
         resp.partition_index = get_gpid().get_partition_index();
@@ -273,8 +307,7 @@ public:
                            "check type {} not supported",
                            update.check_type);
             resp.error = rocksdb::Status::kInvalidArgument;
-            // we should write empty record to update rocksdb's last flushed decree
-            return empty_put(decree);
+            return 0;
         }
 
         ::dsn::blob check_key;
@@ -330,34 +363,18 @@ public:
                 set_key,
                 update.set_value,
                 static_cast<uint32_t>(update.set_expire_ts_seconds));
-        } else {
-            // check not passed, write empty record to update rocksdb's last flushed decree
-            resp.error = _rocksdb_wrapper->write_batch_put(
-                decree, dsn::string_view(), dsn::string_view(), 0);
-        }
-
-        auto cleanup = dsn::defer([this]() { _rocksdb_wrapper->clear_up_write_batch(); });
-        if (resp.error) {
             return resp.error;
         }
 
-        resp.error = _rocksdb_wrapper->write(decree);
-        if (resp.error) {
-            return resp.error;
-        }
-
-        if (!passed) {
-            // check not passed, return proper error code to user
-            resp.error =
-                invalid_argument ? rocksdb::Status::kInvalidArgument : rocksdb::Status::kTryAgain;
-        }
-
+        // check not passed, return proper error code to user
+        resp.error =
+            invalid_argument ? rocksdb::Status::kInvalidArgument : rocksdb::Status::kTryAgain;
         return 0;
     }
 
-    int check_and_mutate(int64_t decree,
-                         const dsn::apps::check_and_mutate_request &update,
-                         dsn::apps::check_and_mutate_response &resp)
+    int append_check_and_mutate(int64_t decree,
+                                const dsn::apps::check_and_mutate_request &update,
+                                dsn::apps::check_and_mutate_response &resp)
     {
         resp.app_id = get_gpid().get_app_id();
         resp.partition_index = get_gpid().get_partition_index();
@@ -369,8 +386,7 @@ public:
                            decree,
                            "mutate list is empty");
             resp.error = rocksdb::Status::kInvalidArgument;
-            // we should write empty record to update rocksdb's last flushed decree
-            return empty_put(decree);
+            return 0;
         }
 
         for (int i = 0; i < update.mutate_list.size(); ++i) {
@@ -383,8 +399,7 @@ public:
                                i,
                                mu.operation);
                 resp.error = rocksdb::Status::kInvalidArgument;
-                // we should write empty record to update rocksdb's last flushed decree
-                return empty_put(decree);
+                return 0;
             }
         }
 
@@ -394,8 +409,7 @@ public:
                            "check type {} not supported",
                            update.check_type);
             resp.error = rocksdb::Status::kInvalidArgument;
-            // we should write empty record to update rocksdb's last flushed decree
-            return empty_put(decree);
+            return 0;
         }
 
         ::dsn::blob check_key;
@@ -456,27 +470,12 @@ public:
                 if (resp.error)
                     break;
             }
-        } else {
-            // check not passed, write empty record to update rocksdb's last flushed decree
-            resp.error = _rocksdb_wrapper->write_batch_put(
-                decree, dsn::string_view(), dsn::string_view(), 0);
-        }
-
-        auto cleanup = dsn::defer([this]() { _rocksdb_wrapper->clear_up_write_batch(); });
-        if (resp.error) {
             return resp.error;
         }
 
-        resp.error = _rocksdb_wrapper->write(decree);
-        if (resp.error) {
-            return resp.error;
-        }
-
-        if (!passed) {
-            // check not passed, return proper error code to user
-            resp.error =
-                invalid_argument ? rocksdb::Status::kInvalidArgument : rocksdb::Status::kTryAgain;
-        }
+        // check not passed, return proper error code to user
+        resp.error =
+            invalid_argument ? rocksdb::Status::kInvalidArgument : rocksdb::Status::kTryAgain;
         return 0;
     }
 
@@ -535,9 +534,49 @@ public:
         return resp.error;
     }
 
+    // Makes the uncommitted updates in the batch visible to the read-modify-write operations
+    // appended after them. Must be called before any update is appended.
+    void enable_batch_read_modify_write() { _rocksdb_wrapper->enable_write_batch_overlay(); }
+
+    int batch_incr(int64_t decree,
+                   const dsn::apps::incr_request &update,
+                   dsn::apps::incr_response &resp)
+    {
+        int err = append_incr(decree, update, resp);
+        _read_modify_write_errors.emplace_back(&resp.error);
+        return err;
+    }
+
+    int batch_check_and_set(int64_t decree,
+                            const dsn::apps::check_and_set_request &update,
+                            dsn::apps::check_and_set_response &resp)
+    {
+        int err = append_check_and_set(decree, update, resp);
+        _read_modify_write_errors.emplace_back(&resp.error);
+        return err;
+    }
+
+    int batch_check_and_mutate(int64_t decree,
+                               const dsn::apps::check_and_mutate_request &update,
+                               dsn::apps::check_and_mutate_response &resp)
+    {
+        int err = append_check_and_mutate(decree, update, resp);
+        _read_modify_write_errors.emplace_back(&resp.error);
+        return err;
+    }
+
     int batch_commit(int64_t decree)
     {
-        int err = _rocksdb_wrapper->write(decree);
+        int err = 0;
+        if (_rocksdb_wrapper->is_write_batch_empty()) {
+            // none of the read-modify-write operations in the batch wrote anything,
+            // we should write empty record to update rocksdb's last flushed decree
+            err = _rocksdb_wrapper->write_batch_put(
+                decree, dsn::string_view(), dsn::string_view(), 0);
+        }
+        if (err == 0) {
+            err = _rocksdb_wrapper->write(decree);
+        }
         clear_up_batch_states(decree, err);
         return err;
     }
@@ -562,9 +601,35 @@ private:
             _update_responses.clear();
         }
 
+        // the read-modify-write operations keep their own results if the batch is committed
+        if (err != 0) {
+            for (int32_t *error : _read_modify_write_errors) {
+                *error = err;
+            }
+        }
+        _read_modify_write_errors.clear();
+
         _rocksdb_wrapper->clear_up_write_batch();
     }
 
+    // Commits the write batch of a single read-modify-write operation. If the operation
+    // appended nothing, we should write empty record to update rocksdb's last flushed decree.
+    int commit_read_modify_write(int64_t decree, int32_t &resp_error)
+    {
+        int err = 0;
+        if (_rocksdb_wrapper->is_write_batch_empty()) {
+            err = _rocksdb_wrapper->write_batch_put(
+                decree, dsn::string_view(), dsn::string_view(), 0);
+        }
+        if (err == 0) {
+            err = _rocksdb_wrapper->write(decree);
+        }
+        if (err != 0) {
+            resp_error = err;
+        }
+        return err;
+    }
+
     static dsn::blob composite_raw_key(dsn::string_view hash_key, dsn::string_view sort_key)
     {
         dsn::blob raw_key;
@@ -696,6 +761,9 @@ private:
 
     // for setting update_response.error after committed.
     std::vector<dsn::apps::update_response *> _update_responses;
+
+    // for setting the errors of read-modify-write responses if the batch failed.
+    std::vector<int32_t *> _read_modify_write_errors;
 };
 
 } // namespace server
@@ -20,58 +20,163 @@
 #include "rocksdb_wrapper.h"
 
 #include <dsn/utility/fail_point.h>
+#include <dsn/utility/flags.h>
 #include <rocksdb/db.h>
+#include <rocksdb/write_batch.h>
 #include "pegasus_write_service_impl.h"
 #include "base/pegasus_value_schema.h"
+#include "key_ttl_compaction_filter.h"
+#include "write_row_cache.h"
 
 namespace pegasus {
 namespace server {
 
+DSN_DEFINE_uint32("pegasus.server",
+                  write_row_cache_capacity,
+                  1024,
+                  "max count of keys cached by a replica for read-modify-write operations "
+                  "(incr, check_and_set, check_and_mutate), 0 means disable the cache");
+
+DSN_DEFINE_uint32("pegasus.server",
+                  write_row_cache_max_value_bytes,
+                  4096,
+                  "the values larger than this size won't be kept in the write row cache");
+
+// Applies the puts and deletes of the data column family in a committed write batch to the
+// keys already in the row cache.
+class row_cache_updater : public rocksdb::WriteBatch::Handler
+{
+public:
+    explicit row_cache_updater(write_row_cache *cache) : _cache(cache) {}
+
+    rocksdb::Status PutCF(uint32_t column_family_id,
+                          const rocksdb::Slice &key,
+                          const rocksdb::Slice &value) override
+    {
+        if (column_family_id == 0) {
+            _cache->update(utils::to_string_view(key), true, utils::to_string_view(value));
+        }
+        return rocksdb::Status::OK();
+    }
+
+    rocksdb::Status DeleteCF(uint32_t column_family_id, const rocksdb::Slice &key) override
+    {
+        if (column_family_id == 0) {
+            _cache->update(utils::to_string_view(key), false, dsn::string_view());
+        }
+        return rocksdb::Status::OK();
+    }
+
+private:
+    write_row_cache *_cache;
+};
+
 rocksdb_wrapper::rocksdb_wrapper(pegasus_server_impl *server)
     : replica_base(server),
       _db(server->_db),
       _rd_opts(server->_data_cf_rd_opts),
       _meta_cf(server->_meta_cf),
+      _key_ttl_compaction_filter_factory(server->_key_ttl_compaction_filter_factory),
       _pegasus_data_version(server->_pegasus_data_version),
       _pfc_recent_expire_count(server->_pfc_recent_expire_count),
       _default_ttl(0)
 {
     _write_batch = dsn::make_unique<rocksdb::WriteBatch>();
     _value_generator = dsn::make_unique<pegasus_value_generator>();
+    _row_cache = dsn::make_unique<write_row_cache>(FLAGS_write_row_cache_capacity,
+                                                   FLAGS_write_row_cache_max_value_bytes);
 
     _wt_opts = dsn::make_unique<rocksdb::WriteOptions>();
     // disable write ahead logging as replication handles logging instead now
     _wt_opts->disableWAL = true;
+
+    std::string str_gpid = fmt::format("{}", get_gpid());
+    std::string name = fmt::format("recent.write_row_cache.hit.count@{}", str_gpid);
+    _pfc_recent_row_cache_hit_count.init_app_counter(
+        "app.pegasus",
+        name.c_str(),
+        COUNTER_TYPE_VOLATILE_NUMBER,
+        "statistic the recent count of read-before-write served by the write row cache");
+
+    name = fmt::format("recent.write_row_cache.total.count@{}", str_gpid);
+    _pfc_recent_row_cache_total_count.init_app_counter(
+        "app.pegasus",
+        name.c_str(),
+        COUNTER_TYPE_VOLATILE_NUMBER,
+        "statistic the recent count of read-before-write looked up in the write row cache");
 }
 
+rocksdb_wrapper::~rocksdb_wrapper() = default;
+
 int rocksdb_wrapper::get(dsn::string_view raw_key, /*out*/ db_get_context *ctx)
 {
     FAIL_POINT_INJECT_F("db_get", [](dsn::string_view) -> int { return FAIL_DB_GET; });
 
-    rocksdb::Status s = _db->Get(_rd_opts, utils::to_rocksdb_slice(raw_key), &(ctx->raw_value));
-    if (dsn_likely(s.ok())) {
-        // success
-        ctx->found = true;
-        ctx->expire_ts = pegasus_extract_expire_ts(_pegasus_data_version, ctx->raw_value);
-        if (check_if_ts_expired(utils::epoch_now(), ctx->expire_ts)) {
-            ctx->expired = true;
-            _pfc_recent_expire_count->increment();
+    if (_write_batch_overlay_enabled) {
+        auto iter = _write_batch_overlay.find(std::string(raw_key.data(), raw_key.size()));
+        if (iter != _write_batch_overlay.end()) {
+            if (iter->second == nullptr) {
+                ctx->found = false;
+                return rocksdb::Status::kOk;
+            }
+            ctx->found = true;
+            ctx->raw_value = *iter->second;
+            ctx->expire_ts = pegasus_extract_expire_ts(_pegasus_data_version, ctx->raw_value);
+            ctx->expired = check_if_ts_expired(utils::epoch_now(), ctx->expire_ts);
+            return rocksdb::Status::kOk;
         }
-        return rocksdb::Status::kOk;
-    } else if (s.IsNotFound()) {
-        // NotFound is an acceptable error
-        ctx->found = false;
-        return rocksdb::Status::kOk;
-    }
-
-    dsn::blob hash_key, sort_key;
-    pegasus_restore_key(dsn::blob(raw_key.data(), 0, raw_key.size()), hash_key, sort_key);
-    derror_rocksdb("Get",
-                   s.ToString(),
-                   "hash_key: {}, sort_key: {}",
-                   utils::c_escape_string(hash_key),
-                   utils::c_escape_string(sort_key));
-    return s.code();
+    }
+
+    bool use_row_cache = is_row_cache_usable();
+    const write_row_cache::entry *cached = nullptr;
+    if (use_row_cache) {
+        _pfc_recent_row_cache_total_count->increment();
+        cached = _row_cache->find(raw_key);
+    }
+
+    if (cached != nullptr) {
+        _pfc_recent_row_cache_hit_count->increment();
+        if (!cached->found) {
+            ctx->found = false;
+            return rocksdb::Status::kOk;
+        }
+        ctx->raw_value = cached->raw_value;
+    } else {
+        rocksdb::Status s =
+            _db->Get(_rd_opts, utils::to_rocksdb_slice(raw_key), &(ctx->raw_value));
+        if (s.IsNotFound()) {
+            // NotFound is an acceptable error
+            ctx->found = false;
+            if (use_row_cache) {
+                _row_cache->insert(raw_key, false, dsn::string_view());
+            }
+            return rocksdb::Status::kOk;
+        }
+        if (dsn_unlikely(!s.ok())) {
+            dsn::blob hash_key, sort_key;
+            pegasus_restore_key(dsn::blob(raw_key.data(), 0, raw_key.size()), hash_key, sort_key);
+            derror_rocksdb("Get",
+                           s.ToString(),
+                           "hash_key: {}, sort_key: {}",
+                           utils::c_escape_string(hash_key),
+                           utils::c_escape_string(sort_key));
+            return s.code();
+        }
+    }
+
+    // success
+    ctx->found = true;
+    ctx->expire_ts = pegasus_extract_expire_ts(_pegasus_data_version, ctx->raw_value);
+    if (check_if_ts_expired(utils::epoch_now(), ctx->expire_ts)) {
+        ctx->expired = true;
+        _pfc_recent_expire_count->increment();
+    }
+    // the records without ttl may be given the default ttl by compaction, so they are not
+    // cached while the default ttl is set
+    if (cached == nullptr && use_row_cache && (_default_ttl == 0 || ctx->expire_ts != 0)) {
+        _row_cache->insert(raw_key, true, ctx->raw_value);
+    }
+    return rocksdb::Status::kOk;
 }
 
 int rocksdb_wrapper::write_batch_put(int64_t decree,
@@ -122,7 +227,9 @@ int rocksdb_wrapper::write_batch_put_ctx(const db_write_context &ctx,
     rocksdb::SliceParts svalue = _value_generator->generate_value(
         _pegasus_data_version, value, db_expire_ts(expire_sec), new_timetag);
     rocksdb::Status s = _write_batch->Put(skey_parts, svalue);
-    if (dsn_unlikely(!s.ok())) {
+    if (dsn_likely(s.ok())) {
+        update_write_batch_overlay(raw_key, true, &svalue);
+    } else {
         ::dsn::blob hash_key, sort_key;
         pegasus_restore_key(::dsn::blob(raw_key.data(), 0, raw_key.size()), hash_key, sort_key);
         derror_rocksdb("WriteBatchPut",
@@ -155,7 +262,12 @@ int rocksdb_wrapper::write(int64_t decree)
     status = _db->Write(*_wt_opts, _write_batch.get());
     if (dsn_unlikely(!status.ok())) {
         derror_rocksdb("Write", status.ToString(), "write rocksdb error, decree: {}", decree);
+        return status.code();
     }
+
+    // the row cache is updated only after the batch is committed, an aborted batch
+    // leaves it untouched
+    update_row_cache();
     return status.code();
 }
 
@@ -165,7 +277,9 @@ int rocksdb_wrapper::write_batch_delete(int64_t decree, dsn::string_view raw_key
                         [](dsn::string_view) -> int { return FAIL_DB_WRITE_BATCH_DELETE; });
 
     rocksdb::Status s = _write_batch->Delete(utils::to_rocksdb_slice(raw_key));
-    if (dsn_unlikely(!s.ok())) {
+    if (dsn_likely(s.ok())) {
+        update_write_batch_overlay(raw_key, false, nullptr);
+    } else {
         dsn::blob hash_key, sort_key;
         pegasus_restore_key(dsn::blob(raw_key.data(), 0, raw_key.size()), hash_key, sort_key);
         derror_rocksdb("write_batch_delete",
@@ -178,7 +292,32 @@ int rocksdb_wrapper::write_batch_delete(int64_t decree, dsn::string_view raw_key
     return s.code();
 }
 
-void rocksdb_wrapper::clear_up_write_batch() { _write_batch->Clear(); }
+void rocksdb_wrapper::clear_up_write_batch()
+{
+    _write_batch->Clear();
+    _write_batch_overlay.clear();
+    _write_batch_overlay_enabled = false;
+}
+
+bool rocksdb_wrapper::is_write_batch_empty() const { return _write_batch->Count() == 0; }
+
+void rocksdb_wrapper::update_write_batch_overlay(dsn::string_view raw_key,
+                                                 bool found,
+                                                 const rocksdb::SliceParts *raw_value)
+{
+    if (!_write_batch_overlay_enabled || raw_key.empty()) {
+        return;
+    }
+
+    std::unique_ptr<std::string> value;
+    if (found) {
+        value = dsn::make_unique<std::string>();
+        for (int i = 0; i < raw_value->num_parts; i++) {
+            value->append(raw_value->parts[i].data(), raw_value->parts[i].size());
+        }
+    }
+    _write_batch_overlay[std::string(raw_key.data(), raw_key.size())] = std::move(value);
+}
 
 int rocksdb_wrapper::ingest_files(int64_t decree,
                                   const std::vector<std::string> &sst_file_list,
@@ -188,6 +327,8 @@ int rocksdb_wrapper::ingest_files(int64_t decree,
     ifo.move_files = true;
     ifo.ingest_behind = ingest_behind;
     rocksdb::Status s = _db->IngestExternalFile(sst_file_list, ifo);
+    // the ingested files may overwrite any key
+    _row_cache->clear();
     if (dsn_unlikely(!s.ok())) {
         derror_rocksdb("IngestExternalFile",
                        s.ToString(),
@@ -207,6 +348,8 @@ void rocksdb_wrapper::set_default_ttl(uint32_t ttl)
 {
     if (_default_ttl != ttl) {
         _default_ttl = ttl;
+        // the cached records without ttl may be given the new default ttl by compaction
+        _row_cache->clear();
         ddebug_replica("update _default_ttl to {}", ttl);
     }
 }
@@ -220,5 +363,33 @@ uint32_t rocksdb_wrapper::db_expire_ts(uint32_t expire_ts)
 
     return expire_ts;
 }
+
+bool rocksdb_wrapper::is_row_cache_usable()
+{
+    if (!_row_cache->enabled()) {
+        return false;
+    }
+    // user specified compaction operations may delete records or update their ttl
+    // in background
+    if (dsn_unlikely(_key_ttl_compaction_filter_factory->has_user_specified_ops())) {
+        _row_cache->clear();
+        return false;
+    }
+    return true;
+}
+
+void rocksdb_wrapper::update_row_cache()
+{
+    if (_row_cache->size() == 0) {
+        return;
+    }
+    row_cache_updater updater(_row_cache.get());
+    rocksdb::Status s = _write_batch->Iterate(&updater);
+    if (dsn_unlikely(!s.ok())) {
+        // should not happen, drop all the cached records in case they're stale
+        derror_rocksdb("Iterate", s.ToString(), "update write row cache error");
+        _row_cache->clear();
+    }
+}
 } // namespace server
 } // namespace pegasus
@@ -20,19 +20,19 @@
 #pragma once
 
 #include <dsn/dist/replication/replica_base.h>
+#include <dsn/perf_counter/perf_counter_wrapper.h>
 #include <gtest/gtest_prod.h>
+#include <unordered_map>
 
 namespace rocksdb {
 class DB;
 class ReadOptions;
 class WriteBatch;
 class ColumnFamilyHandle;
+struct SliceParts;
 class WriteOptions;
 } // namespace rocksdb
 
-namespace dsn {
-class perf_counter_wrapper;
-} // namespace dsn
 
 namespace pegasus {
 class pegasus_value_generator;
@@ -41,13 +41,19 @@ namespace server {
 struct db_get_context;
 struct db_write_context;
 class pegasus_server_impl;
+class write_row_cache;
+class KeyWithTTLCompactionFilterFactory;
 
 class rocksdb_wrapper : public dsn::replication::replica_base
 {
 public:
     rocksdb_wrapper(pegasus_server_impl *server);
+    ~rocksdb_wrapper();
 
     /// Calls RocksDB Get and store the result into `db_get_context`.
+    /// The values of recently read keys are served from the write row cache, which is
+    /// updated with every committed write batch, so the result always reflects the
+    /// latest committed write.
     /// \returns 0 if Get succeeded. On failure, a non-zero rocksdb status code is returned.
     /// \result ctx.expired=true if record expired. Still 0 is returned.
     /// \result ctx.found=false if record is not found. Still 0 is returned.
@@ -64,6 +70,11 @@ public:
     int write(int64_t decree);
     int write_batch_delete(int64_t decree, dsn::string_view raw_key);
     void clear_up_write_batch();
+    bool is_write_batch_empty() const;
+
+    /// Records the updates appended into the write batch from now on, so that `get` sees
+    /// them before the batch is committed. Disabled again by `clear_up_write_batch`.
+    void enable_write_batch_overlay() { _write_batch_overlay_enabled = true; }
     int ingest_files(int64_t decree,
                      const std::vector<std::string> &sst_file_list,
                      const bool ingest_behind);
@@ -73,23 +84,45 @@ public:
 private:
     uint32_t db_expire_ts(uint32_t expire_ts);
 
+    // Returns false if the row cache is disabled, or its values can't be trusted because
+    // compaction may rewrite them, in which case the row cache is cleared as well.
+    bool is_row_cache_usable();
+
+    // Applies the committed write batch to the cached keys.
+    void update_row_cache();
+
+    void update_write_batch_overlay(dsn::string_view raw_key,
+                                    bool found,
+                                    const rocksdb::SliceParts *raw_value);
+
     rocksdb::DB *_db;
     rocksdb::ReadOptions &_rd_opts;
     std::unique_ptr<pegasus_value_generator> _value_generator;
     std::unique_ptr<rocksdb::WriteBatch> _write_batch;
     std::unique_ptr<rocksdb::WriteOptions> _wt_opts;
     rocksdb::ColumnFamilyHandle *_meta_cf;
+    std::shared_ptr<KeyWithTTLCompactionFilterFactory> _key_ttl_compaction_filter_factory;
+    std::unique_ptr<write_row_cache> _row_cache;
+
+    // The latest updates of the keys in the uncommitted write batch, the value is
+    // nullptr for a deleted key.
+    bool _write_batch_overlay_enabled{false};
+    std::unordered_map<std::string, std::unique_ptr<std::string>> _write_batch_overlay;
 
     const uint32_t _pegasus_data_version;
     dsn::perf_counter_wrapper &_pfc_recent_expire_count;
     volatile uint32_t _default_ttl;
 
+    dsn::perf_counter_wrapper _pfc_recent_row_cache_hit_count;
+    dsn::perf_counter_wrapper _pfc_recent_row_cache_total_count;
+
     friend class rocksdb_wrapper_test;
     friend class pegasus_write_service_test;
     friend class pegasus_server_write_test;
     FRIEND_TEST(rocksdb_wrapper_test, put_verify_timetag);
     FRIEND_TEST(rocksdb_wrapper_test, verify_timetag_compatible_with_version_0);
     FRIEND_TEST(rocksdb_wrapper_test, get);
+    FRIEND_TEST(rocksdb_wrapper_test, get_from_row_cache);
 };
 } // namespace server
 } // namespace pegasus
@@ -0,0 +1,95 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "server/geo_distance_filter.h"
+
+#include <gtest/gtest.h>
+
+namespace pegasus {
+namespace server {
+
+static ::dsn::apps::geo_scan_filter
+make_filter(double lat, double lng, double radius_m, int lat_index, int lng_index, int limit)
+{
+    ::dsn::apps::geo_scan_filter filter;
+    filter.center_lat = lat;
+    filter.center_lng = lng;
+    filter.radius_m = radius_m;
+    filter.latitude_index = lat_index;
+    filter.longitude_index = lng_index;
+    filter.limit = limit;
+    return filter;
+}
+
+TEST(geo_distance_filter_test, validate)
+{
+    ASSERT_TRUE(geo_distance_filter::validate(make_filter(39.9, 116.4, 1000, 5, 4, -1)));
+    ASSERT_FALSE(geo_distance_filter::validate(make_filter(39.9, 116.4, 0, 5, 4, -1)));
+    ASSERT_FALSE(geo_distance_filter::validate(make_filter(39.9, 116.4, 1000, 4, 4, -1)));
+    ASSERT_FALSE(geo_distance_filter::validate(make_filter(39.9, 116.4, 1000, -1, 4, -1)));
+    ASSERT_FALSE(geo_distance_filter::validate(make_filter(91, 116.4, 1000, 5, 4, -1)));
+    ASSERT_FALSE(geo_distance_filter::validate(make_filter(39.9, 181, 1000, 5, 4, -1)));
+}
+
+TEST(geo_distance_filter_test, match)
+{
+    // one degree of latitude is about 111195m on the sphere of S2Earth
+    geo_distance_filter filter(make_filter(39.9, 116.4, 56000, 5, 4, -1));
+
+    ASSERT_TRUE(filter.match("0|1|2|3|116.4|39.9"));
+    ASSERT_TRUE(filter.match("0|1|2|3|116.4|40.4|6|7"));
+    ASSERT_TRUE(filter.match("0|1|2|3|116.4|39.4|"));
+    ASSERT_FALSE(filter.match("0|1|2|3|116.4|40.41"));
+    ASSERT_FALSE(filter.match("0|1|2|3|117.4|39.9"));
+
+    // invalid values
+    ASSERT_FALSE(filter.match(""));
+    ASSERT_FALSE(filter.match("0|1|2|3|116.4"));
+    ASSERT_FALSE(filter.match("0|1|2|3|116.4|"));
+    ASSERT_FALSE(filter.match("0|1|2|3|116.4|abc"));
+    ASSERT_FALSE(filter.match("0|1|2|3|116.4|91"));
+
+    // longitude before latitude
+    geo_distance_filter reversed(make_filter(39.9, 116.4, 56000, 0, 1, -1));
+    ASSERT_TRUE(reversed.match("40.4|116.4"));
+    ASSERT_FALSE(reversed.match("116.4|40.4"));
+}
+
+TEST(geo_distance_filter_test, across_antimeridian)
+{
+    geo_distance_filter filter(make_filter(0, 179.9, 30000, 0, 1, -1));
+    ASSERT_TRUE(filter.match("0|-179.9"));
+    ASSERT_FALSE(filter.match("0|-179.6"));
+}
+
+TEST(geo_distance_filter_test, limit)
+{
+    geo_distance_filter unlimited(make_filter(39.9, 116.4, 1000, 5, 4, -1));
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_FALSE(unlimited.add_matched());
+    }
+
+    geo_distance_filter limited(make_filter(39.9, 116.4, 1000, 5, 4, 3));
+    ASSERT_FALSE(limited.add_matched());
+    ASSERT_FALSE(limited.add_matched());
+    ASSERT_TRUE(limited.add_matched());
+}
+
+} // namespace server
+} // namespace pegasus
@@ -0,0 +1,95 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "server/pegasus_scan_context.h"
+
+#include <gtest/gtest.h>
+
+namespace pegasus {
+namespace server {
+
+static std::unique_ptr<pegasus_scan_context> create_scan_context(int32_t batch_size)
+{
+    return dsn::make_unique<pegasus_scan_context>(nullptr,
+                                                  std::string("stop"),
+                                                  false,
+                                                  ::dsn::apps::filter_type::FT_NO_FILTER,
+                                                  std::string(),
+                                                  ::dsn::apps::filter_type::FT_NO_FILTER,
+                                                  std::string(),
+                                                  batch_size,
+                                                  false,
+                                                  true,
+                                                  false);
+}
+
+TEST(pegasus_context_cache_test, put_and_fetch)
+{
+    pegasus_context_cache cache;
+    int64_t handle1 = cache.put(create_scan_context(1));
+    int64_t handle2 = cache.put(create_scan_context(2));
+    ASSERT_NE(handle1, handle2);
+    ASSERT_EQ(2, cache.size());
+
+    auto context = cache.fetch(handle2);
+    ASSERT_NE(nullptr, context);
+    ASSERT_EQ(2, context->batch_size);
+    ASSERT_EQ(nullptr, cache.fetch(handle2));
+    ASSERT_EQ(1, cache.size());
+
+    cache.clear();
+    ASSERT_EQ(0, cache.size());
+    ASSERT_EQ(nullptr, cache.fetch(handle1));
+}
+
+TEST(pegasus_context_cache_test, evict_by_count)
+{
+    pegasus_context_cache cache;
+    std::vector<int64_t> handles;
+    for (int i = 0; i < 5; ++i) {
+        handles.push_back(cache.put(create_scan_context(i)));
+    }
+
+    // refreshing a context makes it the most recently used one
+    handles[0] = cache.put(cache.fetch(handles[0]));
+
+    ASSERT_EQ(2, cache.evict(3600 * 1000, 3));
+    ASSERT_EQ(3, cache.size());
+    ASSERT_EQ(nullptr, cache.fetch(handles[1]));
+    ASSERT_EQ(nullptr, cache.fetch(handles[2]));
+    ASSERT_NE(nullptr, cache.fetch(handles[0]));
+    ASSERT_NE(nullptr, cache.fetch(handles[3]));
+    ASSERT_NE(nullptr, cache.fetch(handles[4]));
+}
+
+TEST(pegasus_context_cache_test, evict_by_ttl)
+{
+    pegasus_context_cache cache;
+    cache.put(create_scan_context(1));
+    cache.put(create_scan_context(2));
+
+    ASSERT_EQ(0, cache.evict(3600 * 1000, 100));
+    ASSERT_EQ(2, cache.size());
+
+    ASSERT_EQ(2, cache.evict(0, 100));
+    ASSERT_EQ(0, cache.size());
+}
+
+} // namespace server
+} // namespace pegasus
@@ -109,6 +109,40 @@ public:
         dsn::fail::teardown();
     }
 
+    void test_batch_put_and_incr()
+    {
+        RPC_MOCKING(put_rpc) RPC_MOCKING(incr_rpc)
+        {
+            dsn::blob key;
+            pegasus_generate_key(key, std::string("hash"), std::string("incr"));
+            dsn::apps::update_request put_req;
+            put_req.key = key;
+            put_req.value.assign("1", 0, 1);
+            dsn::apps::incr_request incr_req;
+            incr_req.key = key;
+            incr_req.increment = 2;
+
+            // the incr must see the put ahead of it in the same batch.
+            dsn::message_ex *writes[3];
+            writes[0] = pegasus::create_put_request(put_req);
+            writes[1] = pegasus::create_incr_request(incr_req);
+            writes[2] = pegasus::create_incr_request(incr_req);
+
+            int err = _server_write->on_batched_write_requests(writes, 3, 1, 0);
+            ASSERT_EQ(err, 0);
+            ASSERT_TRUE(_server_write->_incr_rpc_batch.empty());
+            ASSERT_EQ(_server_write->_write_svc->_impl->_read_modify_write_errors.size(), 0);
+
+            ASSERT_EQ(put_rpc::mail_box().size(), 1);
+            verify_response(put_rpc::mail_box()[0].response(), 0, 1);
+            ASSERT_EQ(incr_rpc::mail_box().size(), 2);
+            ASSERT_EQ(incr_rpc::mail_box()[0].response().error, 0);
+            ASSERT_EQ(incr_rpc::mail_box()[0].response().new_value, 3);
+            ASSERT_EQ(incr_rpc::mail_box()[1].response().error, 0);
+            ASSERT_EQ(incr_rpc::mail_box()[1].response().new_value, 5);
+        }
+    }
+
     void verify_response(const dsn::apps::update_response &response, int err, int64_t decree)
     {
         ASSERT_EQ(response.error, err);
@@ -121,5 +155,7 @@ public:
 
 TEST_F(pegasus_server_write_test, batch_writes) { test_batch_writes(); }
 
+TEST_F(pegasus_server_write_test, batch_put_and_incr) { test_batch_put_and_incr(); }
+
 } // namespace server
 } // namespace pegasus
@@ -18,6 +18,7 @@
  */
 
 #include "base/pegasus_value_schema.h"
+#include "base/pegasus_utils.h"
 
 #include <gtest/gtest.h>
 
@@ -64,3 +65,28 @@ TEST(value_schema, generate_and_extract_v1_v0)
         ASSERT_EQ(t.user_data, user_data.to_string());
     }
 }
+
+TEST(value_schema, extract_user_data_from_pinned_value)
+{
+    for (int version : {0, 1}) {
+        std::string user_data_str = "pegasus";
+        pegasus_value_generator gen;
+        rocksdb::SliceParts sparts = gen.generate_value(version, user_data_str, 1000, 10001);
+
+        std::string raw_value;
+        for (int i = 0; i < sparts.num_parts; i++) {
+            raw_value += sparts.parts[i].ToString();
+        }
+
+        auto pinned = std::make_shared<rocksdb::PinnableSlice>();
+        pinned->PinSelf(raw_value);
+
+        dsn::blob user_data;
+        pegasus_extract_user_data(version, pinned, utils::to_string_view(*pinned), user_data);
+        ASSERT_EQ(pinned->data() + pinned->size() - user_data_str.size(), user_data.data());
+
+        // user_data keeps the pinned value alive after the holder is released
+        pinned.reset();
+        ASSERT_EQ(user_data_str, user_data.to_string());
+    }
+}
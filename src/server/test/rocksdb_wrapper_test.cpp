@@ -19,6 +19,7 @@
 
 #include "server/pegasus_server_write.h"
 #include "server/pegasus_write_service_impl.h"
+#include "server/write_row_cache.h"
 #include "pegasus_server_test_base.h"
 
 namespace pegasus {
@@ -109,6 +110,53 @@ TEST_F(rocksdb_wrapper_test, get)
     ASSERT_EQ(user_value, value);
 }
 
+TEST_F(rocksdb_wrapper_test, get_from_row_cache)
+{
+    _rocksdb_wrapper->_row_cache->clear();
+
+    // not found, and cached
+    db_get_context get_ctx1;
+    ASSERT_EQ(0, _rocksdb_wrapper->get(_raw_key, &get_ctx1));
+    ASSERT_FALSE(get_ctx1.found);
+    ASSERT_EQ(1, _rocksdb_wrapper->_row_cache->size());
+
+    // the cached record is updated once the write batch is committed
+    db_write_context write_ctx;
+    std::string value = "abc";
+    single_set(write_ctx, _raw_key, value, INT32_MAX);
+    const auto *cached = _rocksdb_wrapper->_row_cache->find(_raw_key);
+    ASSERT_NE(nullptr, cached);
+    ASSERT_TRUE(cached->found);
+
+    db_get_context get_ctx2;
+    ASSERT_EQ(0, _rocksdb_wrapper->get(_raw_key, &get_ctx2));
+    ASSERT_TRUE(get_ctx2.found);
+    ASSERT_FALSE(get_ctx2.expired);
+    ASSERT_EQ(INT32_MAX, get_ctx2.expire_ts);
+    dsn::blob user_value;
+    pegasus_extract_user_data(
+        _rocksdb_wrapper->_pegasus_data_version, std::move(get_ctx2.raw_value), user_value);
+    ASSERT_EQ(user_value, value);
+
+    // an aborted write batch doesn't change the cached record
+    ASSERT_EQ(0, _rocksdb_wrapper->write_batch_delete(0, _raw_key));
+    _rocksdb_wrapper->clear_up_write_batch();
+    db_get_context get_ctx3;
+    ASSERT_EQ(0, _rocksdb_wrapper->get(_raw_key, &get_ctx3));
+    ASSERT_TRUE(get_ctx3.found);
+
+    // the cached record is marked as not found by a committed delete
+    ASSERT_EQ(0, _rocksdb_wrapper->write_batch_delete(0, _raw_key));
+    ASSERT_EQ(0, _rocksdb_wrapper->write(0));
+    _rocksdb_wrapper->clear_up_write_batch();
+    cached = _rocksdb_wrapper->_row_cache->find(_raw_key);
+    ASSERT_NE(nullptr, cached);
+    ASSERT_FALSE(cached->found);
+    db_get_context get_ctx4;
+    ASSERT_EQ(0, _rocksdb_wrapper->get(_raw_key, &get_ctx4));
+    ASSERT_FALSE(get_ctx4.found);
+}
+
 TEST_F(rocksdb_wrapper_test, put_verify_timetag)
 {
     set_app_duplicating();
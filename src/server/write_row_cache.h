@@ -0,0 +1,125 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include <dsn/utility/string_view.h>
+
+namespace pegasus {
+namespace server {
+
+/// A bounded LRU cache of the latest committed rocksdb values of recently read-modify-written
+/// keys (INCR, CHECK_AND_SET, CHECK_AND_MUTATE).
+///
+/// It's only accessed from the replica's write thread, so it's not thread-safe. The cached
+/// values are raw rocksdb values, i.e. with the value header, and a key which doesn't exist
+/// in rocksdb is cached as well, with `found = false`.
+class write_row_cache
+{
+public:
+    struct entry
+    {
+        std::string raw_key;
+        bool found;
+        std::string raw_value;
+    };
+
+    write_row_cache(size_t capacity, size_t max_value_bytes)
+        : _capacity(capacity), _max_value_bytes(max_value_bytes)
+    {
+    }
+
+    bool enabled() const { return _capacity > 0; }
+
+    /// \return nullptr if `raw_key` is not cached.
+    const entry *find(dsn::string_view raw_key)
+    {
+        auto iter = _index.find(std::string(raw_key.data(), raw_key.size()));
+        if (iter == _index.end()) {
+            return nullptr;
+        }
+        // move to the most recently used position
+        _lru.splice(_lru.end(), _lru, iter->second);
+        return &(*iter->second);
+    }
+
+    /// Caches the value of `raw_key`, evicting the least recently used one if full.
+    void insert(dsn::string_view raw_key, bool found, dsn::string_view raw_value)
+    {
+        if (!enabled()) {
+            return;
+        }
+        if (update(raw_key, found, raw_value)) {
+            return;
+        }
+        if (raw_value.size() > _max_value_bytes) {
+            return;
+        }
+        if (_lru.size() >= _capacity) {
+            _index.erase(_lru.front().raw_key);
+            _lru.pop_front();
+        }
+        _lru.push_back(entry{std::string(raw_key.data(), raw_key.size()),
+                             found,
+                             std::string(raw_value.data(), raw_value.size())});
+        _index.emplace(_lru.back().raw_key, std::prev(_lru.end()));
+    }
+
+    /// Updates the value of `raw_key` only if it's cached.
+    /// \return true if `raw_key` is cached.
+    bool update(dsn::string_view raw_key, bool found, dsn::string_view raw_value)
+    {
+        auto iter = _index.find(std::string(raw_key.data(), raw_key.size()));
+        if (iter == _index.end()) {
+            return false;
+        }
+        if (raw_value.size() > _max_value_bytes) {
+            // too large to be kept, the stale value must not be kept either
+            _lru.erase(iter->second);
+            _index.erase(iter);
+            return true;
+        }
+        iter->second->found = found;
+        iter->second->raw_value.assign(raw_value.data(), raw_value.size());
+        return true;
+    }
+
+    void clear()
+    {
+        _index.clear();
+        _lru.clear();
+    }
+
+    size_t size() const { return _lru.size(); }
+
+private:
+    const size_t _capacity;
+    const size_t _max_value_bytes;
+
+    // the least recently used entry is at the front
+    std::list<entry> _lru;
+    std::unordered_map<std::string, std::list<entry>::iterator> _index;
+};
+
+} // namespace server
+} // namespace pegasus
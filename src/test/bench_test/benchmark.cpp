@@ -17,10 +17,12 @@
  * under the License.
  */
 
+#include <future>
 #include <sstream>
 #include <pegasus/client.h>
 #include <dsn/dist/fmt_logging.h>
 #include <dsn/c/app_model.h>
+#include <dsn/utility/smart_pointers.h>
 
 #include "benchmark.h"
 #include "rand.h"
@@ -33,11 +35,20 @@ benchmark::benchmark()
                                                  config::instance().pegasus_app_name.c_str());
     assert(nullptr != _client);
 
-    // init operation method map
-    _operation_method = {{kUnknown, nullptr},
-                         {kRead, &benchmark::read_random},
-                         {kWrite, &benchmark::write_random},
-                         {kDelete, &benchmark::delete_random}};
+    _key_generator = dsn::make_unique<key_generator>(
+        string_to_key_distribution(config::instance().key_distribution), config::instance().num);
+
+    // init benchmark map
+    _benchmarks = {{"fillrandom_pegasus", {kWrite, &benchmark::write_random}},
+                   {"readrandom_pegasus", {kRead, &benchmark::read_random}},
+                   {"deleterandom_pegasus", {kDelete, &benchmark::delete_random}},
+                   {"fillseq_pegasus", {kWrite, &benchmark::write_seq}},
+                   {"mixed_pegasus", {kMixed, &benchmark::mixed_random}},
+                   {"multiget_pegasus", {kMultiGet, &benchmark::multi_get_random}},
+                   {"batchget_pegasus", {kBatchGet, &benchmark::batch_get_random}},
+                   {"scan_pegasus", {kScan, &benchmark::scan_random}},
+                   {"incr_pegasus", {kIncr, &benchmark::incr_random}},
+                   {"checkandset_pegasus", {kCheckAndSet, &benchmark::check_and_set_random}}};
 }
 
 void benchmark::run()
@@ -48,17 +59,25 @@ void benchmark::run()
     std::stringstream benchmark_stream(config::instance().benchmarks);
     std::string name;
     while (std::getline(benchmark_stream, name, ',')) {
+        // No error message for empty name
+        if (name.empty()) {
+            continue;
+        }
+
         // run the specified benchmark
-        operation_type op_type = get_operation_type(name);
-        run_benchmark(config::instance().threads, op_type);
+        run_benchmark(config::instance().threads, name);
     }
 }
 
-void benchmark::run_benchmark(int thread_count, operation_type op_type)
+void benchmark::run_benchmark(int thread_count, const std::string &name)
 {
-    // get method by operation type
-    bench_method method = _operation_method[op_type];
-    assert(method != nullptr);
+    // get method by benchmark name
+    auto iter = _benchmarks.find(name);
+    if (iter == _benchmarks.end()) {
+        fmt::print(stderr, "unknown benchmark '{}'\n", name);
+        dsn_exit(1);
+    }
+    const benchmark_entry &entry = iter->second;
 
     // create histogram statistic
     std::shared_ptr<rocksdb::Statistics> hist_stats = rocksdb::CreateDBStatistics();
@@ -66,8 +85,8 @@ void benchmark::run_benchmark(int thread_count, operation_type op_type)
     // create thread args for each thread, and run them
     std::vector<std::shared_ptr<thread_arg>> args;
     for (int i = 0; i < thread_count; i++) {
-        args.push_back(
-            std::make_shared<thread_arg>(i + config::instance().seed, hist_stats, method, this));
+        args.push_back(std::make_shared<thread_arg>(
+            i + config::instance().seed, hist_stats, entry.method, this));
         config::instance().env->StartThread(thread_body, args[i].get());
     }
 
@@ -79,7 +98,7 @@ void benchmark::run_benchmark(int thread_count, operation_type op_type)
     for (int i = 0; i < thread_count; i++) {
         merge_stats.merge(args[i]->stats);
     }
-    merge_stats.report(op_type);
+    merge_stats.report(name, entry.op_type);
 }
 
 void benchmark::thread_body(void *v)
@@ -91,6 +110,8 @@ void benchmark::thread_body(void *v)
 
     // progress the method
     arg->stats.start();
+    arg->schedule_start_micros = config::instance().env->NowMicros();
+    arg->scheduled_ops = 0;
     (arg->bm->*(arg->method))(arg);
     arg->stats.stop();
 }
@@ -98,128 +119,366 @@ void benchmark::thread_body(void *v)
 void benchmark::write_random(thread_arg *thread)
 {
     // do write operation num times
+    for (int i = 0; i < config::instance().num; i++) {
+        wait_for_next_op(thread);
+        write_one(thread, false);
+    }
+}
+
+void benchmark::write_seq(thread_arg *thread)
+{
+    // write num new keys, whose ids are allocated in order
+    for (int i = 0; i < config::instance().num; i++) {
+        wait_for_next_op(thread);
+        write_one(thread, true);
+    }
+}
+
+void benchmark::write_one(thread_arg *thread, bool is_insert)
+{
+    // generate hash key and sort key
+    std::string hashkey, sortkey, value;
+    generate_kv_pair(hashkey, sortkey, value, is_insert);
+
+    // write to pegasus
+    int ret = call_with_retry("Set", [&]() {
+        return _client->set(hashkey, sortkey, value, config::instance().pegasus_timeout_ms);
+    });
+    if (ret != ::pegasus::PERR_OK) {
+        exit_on_error("Set", ret);
+    }
+
+    // count this operation and the written bytes
+    thread->stats.add_bytes(hashkey.size() + sortkey.size() + value.size());
+    thread->stats.finished_ops(1, kWrite);
+}
+
+void benchmark::read_random(thread_arg *thread)
+{
     uint64_t bytes = 0;
-    int count = 0;
+    uint64_t found = 0;
+    for (int i = 0; i < config::instance().num; i++) {
+        wait_for_next_op(thread);
+        read_one(thread, found, bytes);
+    }
+
+    // count total read bytes and hit rate
+    std::string msg = fmt::format("({} of {} found)", found, config::instance().num);
+    thread->stats.add_bytes(bytes);
+    thread->stats.add_message(msg);
+}
+
+void benchmark::read_one(thread_arg *thread, uint64_t &found, uint64_t &bytes)
+{
+    // generate hash key and sort key
+    // generate value for random to keep in peace with write
+    std::string hashkey, sortkey, value;
+    generate_kv_pair(hashkey, sortkey, value);
+
+    // read from pegasus
+    int ret = call_with_retry("Get", [&]() {
+        return _client->get(hashkey, sortkey, value, config::instance().pegasus_timeout_ms);
+    });
+    if (ret == ::pegasus::PERR_OK) {
+        found++;
+        bytes += hashkey.size() + sortkey.size() + value.size();
+    } else if (ret != ::pegasus::PERR_NOT_FOUND) {
+        exit_on_error("Get", ret);
+    }
+
+    // count this operation
+    thread->stats.finished_ops(1, kRead);
+}
+
+void benchmark::delete_random(thread_arg *thread)
+{
+    // do delete operation num times
     for (int i = 0; i < config::instance().num; i++) {
+        wait_for_next_op(thread);
+
         // generate hash key and sort key
+        // generate value for random to keep in peace with write
         std::string hashkey, sortkey, value;
         generate_kv_pair(hashkey, sortkey, value);
 
-        // write to pegasus
-        int try_count = 0;
-        while (true) {
-            try_count++;
-            int ret = _client->set(hashkey, sortkey, value, config::instance().pegasus_timeout_ms);
-            if (ret == ::pegasus::PERR_OK) {
-                bytes += config::instance().value_size + config::instance().hashkey_size +
-                         config::instance().sortkey_size;
-                count++;
-                break;
-            } else if (ret != ::pegasus::PERR_TIMEOUT || try_count > 3) {
-                fmt::print(stderr, "Set returned an error: {}\n", _client->get_error_string(ret));
-                dsn_exit(1);
-            } else {
-                fmt::print(stderr, "Set timeout, retry({})\n", try_count);
-            }
+        int ret = call_with_retry("Del", [&]() {
+            return _client->del(hashkey, sortkey, config::instance().pegasus_timeout_ms);
+        });
+        if (ret != ::pegasus::PERR_OK) {
+            exit_on_error("Del", ret);
         }
 
         // count this operation
-        thread->stats.finished_ops(1, kWrite);
+        thread->stats.finished_ops(1, kDelete);
+    }
+}
+
+void benchmark::mixed_random(thread_arg *thread)
+{
+    uint64_t bytes = 0;
+    uint64_t found = 0;
+    uint64_t reads = 0;
+    bool insert = config::instance().key_distribution == "latest";
+    for (int i = 0; i < config::instance().num; i++) {
+        wait_for_next_op(thread);
+        if (next_u64() % 100 < config::instance().read_percent) {
+            reads++;
+            read_one(thread, found, bytes);
+        } else {
+            // the writes of the latest distribution insert new keys, which are the hottest
+            write_one(thread, insert);
+        }
     }
 
-    // count total write bytes
+    std::string msg = fmt::format("({} of {} reads found)", found, reads);
     thread->stats.add_bytes(bytes);
+    thread->stats.add_message(msg);
 }
 
-void benchmark::read_random(thread_arg *thread)
+void benchmark::multi_get_random(thread_arg *thread)
 {
     uint64_t bytes = 0;
     uint64_t found = 0;
     for (int i = 0; i < config::instance().num; i++) {
-        // generate hash key and sort key
-        // generate value for random to keep in peace with write
+        wait_for_next_op(thread);
+
         std::string hashkey, sortkey, value;
         generate_kv_pair(hashkey, sortkey, value);
 
-        // read from pegasus
-        int try_count = 0;
-        while (true) {
-            try_count++;
-            int ret = _client->get(hashkey, sortkey, value, config::instance().pegasus_timeout_ms);
+        // get at most batch_size sortkeys of the hashkey
+        std::map<std::string, std::string> values;
+        int ret = call_with_retry("MultiGet", [&]() {
+            values.clear();
+            return _client->multi_get(hashkey,
+                                      std::set<std::string>(),
+                                      values,
+                                      config::instance().batch_size,
+                                      -1,
+                                      config::instance().pegasus_timeout_ms);
+        });
+        if (ret != ::pegasus::PERR_OK && ret != ::pegasus::PERR_INCOMPLETE) {
+            exit_on_error("MultiGet", ret);
+        }
+        found += values.size();
+        for (const auto &kv : values) {
+            bytes += hashkey.size() + kv.first.size() + kv.second.size();
+        }
+
+        thread->stats.finished_ops(1, kMultiGet);
+    }
+
+    std::string msg = fmt::format("({} values found)", found);
+    thread->stats.add_bytes(bytes);
+    thread->stats.add_message(msg);
+}
+
+void benchmark::batch_get_random(thread_arg *thread)
+{
+    uint64_t bytes = 0;
+    uint64_t found = 0;
+    uint32_t batch_size = std::max<uint32_t>(config::instance().batch_size, 1);
+    for (int i = 0; i < config::instance().num; i++) {
+        wait_for_next_op(thread);
+
+        // issue batch_size gets concurrently, then wait for all of them
+        std::vector<std::promise<int>> results(batch_size);
+        std::vector<std::string> values(batch_size);
+        for (uint32_t j = 0; j < batch_size; j++) {
+            std::string hashkey, sortkey, value;
+            generate_kv_pair(hashkey, sortkey, value);
+            _client->async_get(
+                hashkey,
+                sortkey,
+                [&results, &values, j](
+                    int err, std::string &&v, pegasus_client::internal_info &&info) {
+                    values[j] = std::move(v);
+                    results[j].set_value(err);
+                },
+                config::instance().pegasus_timeout_ms);
+        }
+
+        int error = ::pegasus::PERR_OK;
+        for (uint32_t j = 0; j < batch_size; j++) {
+            int ret = results[j].get_future().get();
             if (ret == ::pegasus::PERR_OK) {
                 found++;
-                bytes += hashkey.size() + sortkey.size() + value.size();
-                break;
-            } else if (ret == ::pegasus::PERR_NOT_FOUND) {
-                break;
-            } else if (ret != ::pegasus::PERR_TIMEOUT || try_count > 3) {
-                fmt::print(stderr, "Get returned an error: {}\n", _client->get_error_string(ret));
-                dsn_exit(1);
-            } else {
-                fmt::print(stderr, "Get timeout, retry({})\n", try_count);
+                bytes += values[j].size();
+            } else if (ret != ::pegasus::PERR_NOT_FOUND) {
+                error = ret;
             }
         }
+        if (error != ::pegasus::PERR_OK) {
+            exit_on_error("BatchGet", error);
+        }
 
-        // count this operation
-        thread->stats.finished_ops(1, kRead);
+        thread->stats.finished_ops(1, kBatchGet);
     }
 
-    // count total read bytes and hit rate
-    std::string msg = fmt::format("({} of {} found)", found, config::instance().num);
+    std::string msg =
+        fmt::format("({} of {} found)", found, uint64_t(batch_size) * config::instance().num);
     thread->stats.add_bytes(bytes);
     thread->stats.add_message(msg);
 }
 
-void benchmark::delete_random(thread_arg *thread)
+void benchmark::scan_random(thread_arg *thread)
 {
-    // do delete operation num times
+    uint64_t bytes = 0;
+    uint64_t found = 0;
+    pegasus_client::scan_options options;
+    options.timeout_ms = config::instance().pegasus_timeout_ms;
+    options.batch_size = config::instance().batch_size;
     for (int i = 0; i < config::instance().num; i++) {
-        // generate hash key and sort key
-        // generate value for random to keep in peace with write
+        wait_for_next_op(thread);
+
         std::string hashkey, sortkey, value;
         generate_kv_pair(hashkey, sortkey, value);
 
-        int try_count = 0;
-        while (true) {
-            try_count++;
-            int ret = _client->del(hashkey, sortkey, config::instance().pegasus_timeout_ms);
-            if (ret == ::pegasus::PERR_OK) {
+        // scan at most batch_size sortkeys of the hashkey
+        pegasus_client::pegasus_scanner *scanner = nullptr;
+        int ret = call_with_retry(
+            "Scan", [&]() { return _client->get_scanner(hashkey, "", "", options, scanner); });
+        if (ret != ::pegasus::PERR_OK) {
+            exit_on_error("Scan", ret);
+        }
+        std::unique_ptr<pegasus_client::pegasus_scanner> scanner_holder(scanner);
+        for (uint32_t j = 0; j < config::instance().batch_size; j++) {
+            std::string h, s, v;
+            ret = scanner->next(h, s, v);
+            if (ret == ::pegasus::PERR_SCAN_COMPLETE) {
                 break;
-            } else if (ret != ::pegasus::PERR_TIMEOUT || try_count > 3) {
-                fmt::print(stderr, "Del returned an error: {}\n", _client->get_error_string(ret));
-                dsn_exit(1);
-            } else {
-                fmt::print(stderr, "Get timeout, retry({})\n", try_count);
+            } else if (ret != ::pegasus::PERR_OK) {
+                exit_on_error("Scan", ret);
             }
+            found++;
+            bytes += h.size() + s.size() + v.size();
         }
 
-        // count this operation
-        thread->stats.finished_ops(1, kDelete);
+        thread->stats.finished_ops(1, kScan);
     }
+
+    std::string msg = fmt::format("({} values found)", found);
+    thread->stats.add_bytes(bytes);
+    thread->stats.add_message(msg);
 }
 
-void benchmark::generate_kv_pair(std::string &hashkey, std::string &sortkey, std::string &value)
+void benchmark::incr_random(thread_arg *thread)
 {
-    hashkey = generate_string(config::instance().hashkey_size);
-    sortkey = generate_string(config::instance().sortkey_size);
+    for (int i = 0; i < config::instance().num; i++) {
+        wait_for_next_op(thread);
+
+        // use a sortkey different from the written ones, whose values are not integers
+        std::string hashkey, sortkey, value;
+        generate_kv_pair(hashkey, sortkey, value);
+        sortkey = "incr";
+
+        int64_t new_value = 0;
+        int ret = call_with_retry("Incr", [&]() {
+            return _client->incr(
+                hashkey, sortkey, 1, new_value, config::instance().pegasus_timeout_ms);
+        });
+        if (ret != ::pegasus::PERR_OK) {
+            exit_on_error("Incr", ret);
+        }
+
+        thread->stats.finished_ops(1, kIncr);
+    }
+}
+
+void benchmark::check_and_set_random(thread_arg *thread)
+{
+    uint64_t succeed = 0;
+    pegasus_client::check_and_set_options options;
+    for (int i = 0; i < config::instance().num; i++) {
+        wait_for_next_op(thread);
+
+        // update the value only if the key exists
+        std::string hashkey, sortkey, value;
+        generate_kv_pair(hashkey, sortkey, value);
+        pegasus_client::check_and_set_results results;
+        int ret = call_with_retry("CheckAndSet", [&]() {
+            return _client->check_and_set(hashkey,
+                                          sortkey,
+                                          pegasus_client::cas_check_type::CT_VALUE_EXIST,
+                                          "",
+                                          sortkey,
+                                          value,
+                                          options,
+                                          results,
+                                          config::instance().pegasus_timeout_ms);
+        });
+        if (ret != ::pegasus::PERR_OK) {
+            exit_on_error("CheckAndSet", ret);
+        }
+        if (results.set_succeed) {
+            succeed++;
+        }
+
+        thread->stats.finished_ops(1, kCheckAndSet);
+    }
+
+    std::string msg = fmt::format("({} of {} set)", succeed, config::instance().num);
+    thread->stats.add_message(msg);
+}
+
+void benchmark::generate_kv_pair(std::string &hashkey,
+                                 std::string &sortkey,
+                                 std::string &value,
+                                 bool is_insert)
+{
+    if (config::instance().key_distribution == "uniform" && !is_insert) {
+        hashkey = generate_string(config::instance().hashkey_size);
+        sortkey = generate_string(config::instance().sortkey_size);
+    } else {
+        uint64_t id = is_insert ? _key_generator->next_insert() : _key_generator->next();
+        hashkey = generate_string(config::instance().hashkey_size, id);
+        sortkey = generate_string(config::instance().sortkey_size, id);
+    }
     value = generate_string(config::instance().value_size);
 }
 
-operation_type benchmark::get_operation_type(const std::string &name)
+void benchmark::wait_for_next_op(thread_arg *thread)
 {
-    operation_type op_type = kUnknown;
-    if (name == "fillrandom_pegasus") {
-        op_type = kWrite;
-    } else if (name == "readrandom_pegasus") {
-        op_type = kRead;
-    } else if (name == "deleterandom_pegasus") {
-        op_type = kDelete;
-    } else if (!name.empty()) { // No error message for empty name
-        fmt::print(stderr, "unknown benchmark '{}'\n", name);
-        dsn_exit(1);
+    if (config::instance().ops_per_sec == 0) {
+        return;
+    }
+
+    // the operations are issued on schedule even if the earlier ones are slow, and the latency
+    // is measured from the scheduled time, so that queueing delay is not hidden.
+    // the schedule is computed from the count of operations rather than by adding up the
+    // interval, which would be truncated to whole micros each time.
+    uint64_t next_op_micros =
+        thread->schedule_start_micros +
+        static_cast<uint64_t>(thread->scheduled_ops * 1e6 * config::instance().threads /
+                              config::instance().ops_per_sec);
+    ++thread->scheduled_ops;
+
+    uint64_t now = config::instance().env->NowMicros();
+    if (next_op_micros > now) {
+        config::instance().env->SleepForMicroseconds(next_op_micros - now);
     }
+    thread->stats.set_op_start(next_op_micros);
+}
+
+int benchmark::call_with_retry(const char *op_name, const std::function<int()> &op)
+{
+    int try_count = 0;
+    while (true) {
+        try_count++;
+        int ret = op();
+        if (ret != ::pegasus::PERR_TIMEOUT) {
+            return ret;
+        } else if (try_count > 3) {
+            exit_on_error(op_name, ret);
+        } else {
+            fmt::print(stderr, "{} timeout, retry({})\n", op_name, try_count);
+        }
+    }
+}
 
-    return op_type;
+void benchmark::exit_on_error(const char *op_name, int ret)
+{
+    fmt::print(stderr, "{} returned an error: {}\n", op_name, _client->get_error_string(ret));
+    dsn_exit(1);
 }
 
 void benchmark::print_header()
@@ -233,6 +492,10 @@ void benchmark::print_header()
                "FileSize:       {} MB (estimated)\n",
                ((config_.hashkey_size + config_.sortkey_size + config_.value_size) * config_.num) >>
                    20);
+    fmt::print(stdout, "Distribution:   {}\n", config_.key_distribution);
+    if (config_.ops_per_sec > 0) {
+        fmt::print(stdout, "Rate limit:     {} ops/sec\n", config_.ops_per_sec);
+    }
 
     print_warnings();
     fmt::print(stdout, "------------------------------------------------\n");
@@ -19,10 +19,13 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <unordered_map>
 
 #include "statistics.h"
 #include "config.h"
+#include "key_generator.h"
 
 namespace pegasus {
 namespace test {
@@ -37,16 +40,31 @@ struct thread_arg
     statistics stats;
     bench_method method;
     benchmark *bm;
+    // if ops_per_sec is set, the n-th operation is scheduled to start at
+    // `schedule_start_micros + n * 1000000 * threads / ops_per_sec`
+    uint64_t schedule_start_micros;
+    uint64_t scheduled_ops;
 
     thread_arg(uint64_t seed_,
                std::shared_ptr<rocksdb::Statistics> hist_stats_,
                bench_method bench_method_,
                benchmark *benchmark_)
-        : seed(seed_), stats(hist_stats_), method(bench_method_), bm(benchmark_)
+        : seed(seed_),
+          stats(hist_stats_),
+          method(bench_method_),
+          bm(benchmark_),
+          schedule_start_micros(0),
+          scheduled_ops(0)
     {
     }
 };
 
+struct benchmark_entry
+{
+    operation_type op_type;
+    bench_method method;
+};
+
 class benchmark
 {
 public:
@@ -59,24 +77,45 @@ private:
     static void thread_body(void *v);
 
     /** benchmark operations **/
-    void run_benchmark(int thread_count, operation_type op_type);
+    void run_benchmark(int thread_count, const std::string &name);
     void write_random(thread_arg *thread);
     void read_random(thread_arg *thread);
     void delete_random(thread_arg *thread);
+    void write_seq(thread_arg *thread);
+    void mixed_random(thread_arg *thread);
+    void multi_get_random(thread_arg *thread);
+    void batch_get_random(thread_arg *thread);
+    void scan_random(thread_arg *thread);
+    void incr_random(thread_arg *thread);
+    void check_and_set_random(thread_arg *thread);
+
+    /** single operations, shared by the benchmarks above */
+    void write_one(thread_arg *thread, bool is_insert);
+    void read_one(thread_arg *thread, uint64_t &found, uint64_t &bytes);
 
-    /**  generate hash/sort key and value */
-    void generate_kv_pair(std::string &hashkey, std::string &sortkey, std::string &value);
+    /**  generate hash/sort key and value, the key is chosen by the key generator */
+    void generate_kv_pair(std::string &hashkey,
+                          std::string &sortkey,
+                          std::string &value,
+                          bool is_insert = false);
 
     /** some auxiliary functions */
-    operation_type get_operation_type(const std::string &name);
+    // Sleeps until the scheduled start time of the next operation if ops_per_sec is set.
+    void wait_for_next_op(thread_arg *thread);
+    // Calls `op` until it does not time out, exits if it keeps timing out.
+    int call_with_retry(const char *op_name, const std::function<int()> &op);
+    // Exits with the error message of `ret`.
+    void exit_on_error(const char *op_name, int ret);
     void print_header();
     void print_warnings();
 
 private:
     // the pegasus client to do read/write/delete operations
     pegasus_client *_client;
-    // the map of operation type and the process method
-    std::unordered_map<operation_type, bench_method, std::hash<unsigned char>> _operation_method;
+    // the map of benchmark name and the operation type/process method
+    std::unordered_map<std::string, benchmark_entry> _benchmarks;
+    // chooses the keys to access, shared by all the benchmarks to know the inserted keys
+    std::unique_ptr<key_generator> _key_generator;
 };
 } // namespace test
 } // namespace pegasus
@@ -41,7 +41,14 @@ config::config()
         "Comma-separated list of operations to run in the specified order. Available benchmarks:\n"
         "\tfillrandom_pegasus       -- pegasus write N values in random key order\n"
         "\treadrandom_pegasus       -- pegasus read N times in random order\n"
-        "\tdeleterandom_pegasus     -- pegasus delete N keys in random order\n");
+        "\tdeleterandom_pegasus     -- pegasus delete N keys in random order\n"
+        "\tfillseq_pegasus          -- pegasus write N new keys in key id order\n"
+        "\tmixed_pegasus            -- pegasus read or write N times by read_percent\n"
+        "\tmultiget_pegasus         -- pegasus multi_get N hashkeys\n"
+        "\tbatchget_pegasus         -- pegasus get batch_size keys concurrently N times\n"
+        "\tscan_pegasus             -- pegasus scan N hashkeys\n"
+        "\tincr_pegasus             -- pegasus incr N times\n"
+        "\tcheckandset_pegasus      -- pegasus check_and_set N times\n");
     num = dsn_config_get_value_uint64(
         "pegasus.benchmark", "num", 10000, "Number of key/values to place in database");
     threads = (int32_t)dsn_config_get_value_uint64(
@@ -58,6 +65,40 @@ config::config()
         1000,
         "Seed base for random number generators. When 0 it is deterministic");
     seed = seed ? seed : 1000;
+    key_distribution = dsn_config_get_value_string(
+        "pegasus.benchmark",
+        "key_distribution",
+        "uniform",
+        "Distribution of the accessed keys: uniform, zipfian, latest or hotspot. uniform uses "
+        "random keys as fillrandom_pegasus does, the others use the keys written by "
+        "fillseq_pegasus");
+    zipfian_constant = dsn_config_get_value_double(
+        "pegasus.benchmark", "zipfian_constant", 0.99, "skewness of zipfian/latest, in (0, 1)");
+    hotspot_data_fraction = dsn_config_get_value_double(
+        "pegasus.benchmark", "hotspot_data_fraction", 0.2, "fraction of the keys which are hot");
+    hotspot_op_fraction =
+        dsn_config_get_value_double("pegasus.benchmark",
+                                    "hotspot_op_fraction",
+                                    0.8,
+                                    "fraction of the operations which access the hot keys");
+    read_percent = (int32_t)dsn_config_get_value_uint64(
+        "pegasus.benchmark", "read_percent", 50, "percentage of reads in mixed_pegasus");
+    batch_size = (int32_t)dsn_config_get_value_uint64(
+        "pegasus.benchmark", "batch_size", 10, "number of keys read by multiget/batchget/scan");
+    ops_per_sec = dsn_config_get_value_uint64(
+        "pegasus.benchmark",
+        "ops_per_sec",
+        0,
+        "Total operations per second of all threads. When 0 each thread issues the next "
+        "operation as soon as the last one returns, otherwise operations are issued on schedule "
+        "and the latency is measured from the scheduled time");
+    histogram_output_file =
+        dsn_config_get_value_string("pegasus.benchmark",
+                                    "histogram_output_file",
+                                    "",
+                                    "file to which the latency percentiles are appended");
+    histogram_output_format = dsn_config_get_value_string(
+        "pegasus.benchmark", "histogram_output_format", "csv", "csv or json");
     env = rocksdb::Env::Default();
 }
 } // namespace test
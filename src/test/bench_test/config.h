@@ -46,6 +46,24 @@ struct config : public dsn::utils::singleton<config>
     uint32_t sortkey_size;
     // Seed base for random number generators
     uint64_t seed;
+    // Distribution of the accessed keys: uniform, zipfian, latest or hotspot
+    std::string key_distribution;
+    // Skewness of the zipfian and latest distributions, in (0, 1)
+    double zipfian_constant;
+    // Fraction of the keys which are hot, for the hotspot distribution
+    double hotspot_data_fraction;
+    // Fraction of the operations which access the hot keys, for the hotspot distribution
+    double hotspot_op_fraction;
+    // Percentage of reads in mixed_pegasus, the others are writes
+    uint32_t read_percent;
+    // Number of keys read by each multi_get/batch_get/scan
+    uint32_t batch_size;
+    // Total operations per second of all the threads, 0 means as fast as possible
+    uint64_t ops_per_sec;
+    // File to which the latency percentiles of each benchmark are appended, empty means none
+    std::string histogram_output_file;
+    // Format of histogram_output_file: csv or json
+    std::string histogram_output_format;
     // Default environment suitable for the current operating system
     rocksdb::Env *env;
 
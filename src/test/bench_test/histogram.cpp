@@ -0,0 +1,104 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "histogram.h"
+
+namespace pegasus {
+namespace test {
+// each power of 2 is divided into 2^kSubBucketBits buckets
+static const uint32_t kSubBucketBits = 7;
+static const uint32_t kSubBucketCount = 1U << kSubBucketBits;
+static const uint32_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBucketCount;
+
+latency_histogram::latency_histogram()
+    : _buckets(kBucketCount, 0),
+      _count(0),
+      _sum(0),
+      _min(std::numeric_limits<uint64_t>::max()),
+      _max(0)
+{
+}
+
+void latency_histogram::record(uint64_t value)
+{
+    _buckets[bucket_index(value)]++;
+    _count++;
+    _sum += value;
+    _min = std::min(_min, value);
+    _max = std::max(_max, value);
+}
+
+void latency_histogram::merge(const latency_histogram &other)
+{
+    for (uint32_t i = 0; i < kBucketCount; ++i) {
+        _buckets[i] += other._buckets[i];
+    }
+    _count += other._count;
+    _sum += other._sum;
+    _min = std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+}
+
+uint64_t latency_histogram::value_at_percentile(double percentile) const
+{
+    if (_count == 0) {
+        return 0;
+    }
+
+    auto target = static_cast<uint64_t>(std::ceil(percentile / 100 * _count));
+    target = std::min(std::max<uint64_t>(target, 1), _count);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < kBucketCount; ++i) {
+        seen += _buckets[i];
+        if (seen >= target) {
+            return std::min(bucket_highest_value(i), _max);
+        }
+    }
+    return _max;
+}
+
+uint32_t latency_histogram::bucket_index(uint64_t value)
+{
+    // values below 2 * kSubBucketCount are counted exactly
+    if (value < 2 * kSubBucketCount) {
+        return static_cast<uint32_t>(value);
+    }
+
+    uint32_t shift = 63 - __builtin_clzll(value) - kSubBucketBits;
+    return ((shift + 1) << kSubBucketBits) + static_cast<uint32_t>(value >> shift) -
+           kSubBucketCount;
+}
+
+uint64_t latency_histogram::bucket_highest_value(uint32_t index)
+{
+    if (index < 2 * kSubBucketCount) {
+        return index;
+    }
+
+    uint32_t shift = (index >> kSubBucketBits) - 1;
+    uint64_t lowest = static_cast<uint64_t>(kSubBucketCount + (index & (kSubBucketCount - 1)))
+                      << shift;
+    return lowest + (1ULL << shift) - 1;
+}
+} // namespace test
+} // namespace pegasus
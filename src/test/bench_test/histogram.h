@@ -0,0 +1,58 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace pegasus {
+namespace test {
+/// A log-linear latency histogram in the spirit of HdrHistogram: values are counted in buckets
+/// whose width is 1/128 of their magnitude, so any recorded percentile is within 1% of the
+/// actual value, while recording costs only a few bit operations.
+/// Not thread safe, each thread records into its own histogram and they are merged at the end.
+class latency_histogram
+{
+public:
+    latency_histogram();
+
+    void record(uint64_t value);
+    void merge(const latency_histogram &other);
+
+    uint64_t count() const { return _count; }
+    uint64_t min() const { return _count == 0 ? 0 : _min; }
+    uint64_t max() const { return _max; }
+    double mean() const { return _count == 0 ? 0 : static_cast<double>(_sum) / _count; }
+    // Returns the value below which `percentile`% of the recorded values fall.
+    uint64_t value_at_percentile(double percentile) const;
+
+private:
+    static uint32_t bucket_index(uint64_t value);
+    // the largest value which is counted in the bucket
+    static uint64_t bucket_highest_value(uint32_t index);
+
+    std::vector<uint64_t> _buckets;
+    uint64_t _count;
+    uint64_t _sum;
+    uint64_t _min;
+    uint64_t _max;
+};
+} // namespace test
+} // namespace pegasus
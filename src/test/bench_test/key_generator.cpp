@@ -0,0 +1,142 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cmath>
+#include <dsn/dist/fmt_logging.h>
+#include <dsn/c/app_model.h>
+
+#include "key_generator.h"
+#include "config.h"
+#include "rand.h"
+
+namespace pegasus {
+namespace test {
+key_distribution string_to_key_distribution(const std::string &name)
+{
+    if (name == "uniform") {
+        return key_distribution::kUniform;
+    } else if (name == "zipfian") {
+        return key_distribution::kZipfian;
+    } else if (name == "latest") {
+        return key_distribution::kLatest;
+    } else if (name == "hotspot") {
+        return key_distribution::kHotspot;
+    }
+
+    fmt::print(stderr, "unknown key distribution '{}'\n", name);
+    dsn_exit(1);
+}
+
+key_generator::key_generator(key_distribution distribution, uint64_t num)
+    : _distribution(distribution),
+      _num(std::max<uint64_t>(num, 1)),
+      _insert_count(0),
+      _theta(config::instance().zipfian_constant),
+      _zetan(0),
+      _alpha(0),
+      _eta(0),
+      _hotspot_count(0),
+      _hotspot_op_fraction(config::instance().hotspot_op_fraction)
+{
+    if (_distribution == key_distribution::kZipfian || _distribution == key_distribution::kLatest) {
+        if (_theta <= 0 || _theta >= 1) {
+            fmt::print(stderr, "zipfian_constant should be in (0, 1), but is {}\n", _theta);
+            dsn_exit(1);
+        }
+        _zetan = zeta(_num, _theta);
+        _alpha = 1.0 / (1.0 - _theta);
+        _eta = (1 - std::pow(2.0 / _num, 1 - _theta)) / (1 - zeta(2, _theta) / _zetan);
+    }
+
+    if (_distribution == key_distribution::kHotspot) {
+        double data_fraction = config::instance().hotspot_data_fraction;
+        if (data_fraction <= 0 || data_fraction > 1 || _hotspot_op_fraction < 0 ||
+            _hotspot_op_fraction > 1) {
+            fmt::print(stderr,
+                       "hotspot_data_fraction should be in (0, 1] and hotspot_op_fraction should "
+                       "be in [0, 1], but are {} and {}\n",
+                       data_fraction,
+                       _hotspot_op_fraction);
+            dsn_exit(1);
+        }
+        _hotspot_count = std::max<uint64_t>(static_cast<uint64_t>(_num * data_fraction), 1);
+    }
+}
+
+uint64_t key_generator::next()
+{
+    switch (_distribution) {
+    case key_distribution::kUniform:
+        return next_u64();
+    case key_distribution::kZipfian:
+        return scramble(next_zipfian(_num));
+    case key_distribution::kLatest: {
+        // count back from the latest inserted key, fall back to the keys written by fillseq
+        uint64_t inserted = _insert_count.load(std::memory_order_relaxed);
+        uint64_t n = inserted > 0 ? inserted : _num;
+        return scramble(n - 1 - next_zipfian(n));
+    }
+    case key_distribution::kHotspot:
+        if (_hotspot_count == _num || next_double() < _hotspot_op_fraction) {
+            return scramble(next_u64() % _hotspot_count);
+        }
+        return scramble(_hotspot_count + next_u64() % (_num - _hotspot_count));
+    }
+
+    return next_u64();
+}
+
+uint64_t key_generator::next_zipfian(uint64_t n) const
+{
+    double u = next_double();
+    double uz = u * _zetan;
+    uint64_t rank = 0;
+    if (uz < 1.0) {
+        rank = 0;
+    } else if (uz < 1.0 + std::pow(0.5, _theta)) {
+        rank = 1;
+    } else {
+        rank = static_cast<uint64_t>(_num * std::pow(_eta * u - _eta + 1, _alpha));
+    }
+
+    // the parameters are computed for _num keys, rescale the rank when there are only n keys
+    return rank < n ? rank : rank % n;
+}
+
+uint64_t key_generator::scramble(uint64_t rank)
+{
+    // 64-bit FNV-1a hash of the rank
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (rank >> (i * 8)) & 0xff;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+double key_generator::zeta(uint64_t n, double theta)
+{
+    double sum = 0;
+    for (uint64_t i = 1; i <= n; ++i) {
+        sum += 1.0 / std::pow(i, theta);
+    }
+    return sum;
+}
+} // namespace test
+} // namespace pegasus
@@ -0,0 +1,82 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+
+namespace pegasus {
+namespace test {
+enum class key_distribution
+{
+    // random 64-bit key ids, the legacy behaviour of fillrandom/readrandom/deleterandom
+    kUniform,
+    // key ids in [0, num), the popularity of which follows a zipfian distribution
+    kZipfian,
+    // like kZipfian, but the most popular keys are the most recently inserted ones
+    kLatest,
+    // `hotspot_op_fraction` of operations access `hotspot_data_fraction` of key ids in [0, num)
+    kHotspot
+};
+
+extern key_distribution string_to_key_distribution(const std::string &name);
+
+/// Generates the ids of keys to be accessed. The id is turned into hashkey/sortkey by
+/// generate_string(), so the same id always maps to the same key.
+/// Thread safety: next() and next_insert() can be called concurrently, the random numbers are
+/// drawn from the thread local generator in rand.h.
+class key_generator
+{
+public:
+    key_generator(key_distribution distribution, uint64_t num);
+
+    // Returns the id of the next key to be read or updated.
+    uint64_t next();
+
+    // Returns the id of the next key to be inserted, which grows from 0.
+    uint64_t next_insert() { return scramble(_insert_count.fetch_add(1)); }
+
+private:
+    // Returns a rank in [0, n) which follows the zipfian distribution over [0, _num).
+    uint64_t next_zipfian(uint64_t n) const;
+
+    // Spreads the consecutive ranks over the key space, so that popular keys are not
+    // clustered in the same partition.
+    static uint64_t scramble(uint64_t rank);
+
+    static double zeta(uint64_t n, double theta);
+
+private:
+    key_distribution _distribution;
+    uint64_t _num;
+    std::atomic<uint64_t> _insert_count;
+
+    // parameters of the zipfian distribution, see "Quickly Generating Billion-Record
+    // Synthetic Databases" by Jim Gray et al.
+    double _theta;
+    double _zetan;
+    double _alpha;
+    double _eta;
+
+    uint64_t _hotspot_count;
+    double _hotspot_op_fraction;
+};
+} // namespace test
+} // namespace pegasus
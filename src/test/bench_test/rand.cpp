@@ -20,6 +20,8 @@
 #include <algorithm>
 #include <random>
 
+#include "rand.h"
+
 namespace pegasus {
 namespace test {
 thread_local std::ranlux48_base thread_local_rng(std::random_device{}());
@@ -32,13 +34,16 @@ uint64_t next_u64()
         thread_local_rng);
 }
 
-std::string generate_string(uint64_t len)
+double next_double() { return std::uniform_real_distribution<double>(0, 1)(thread_local_rng); }
+
+std::string generate_string(uint64_t len) { return generate_string(len, next_u64()); }
+
+std::string generate_string(uint64_t len, uint64_t id)
 {
     std::string key;
 
-    // fill with random int
-    uint64_t random_int = next_u64();
-    key.append(reinterpret_cast<char *>(&random_int), std::min<uint64_t>(len, 8UL));
+    // fill with the id
+    key.append(reinterpret_cast<char *>(&id), std::min<uint64_t>(len, 8UL));
 
     // append with '0'
     key.resize(len, '0');
@@ -24,6 +24,10 @@ namespace test {
 // Reseeds the RNG of current thread.
 extern void reseed_thread_local_rng(uint64_t seed);
 extern uint64_t next_u64();
+// Returns a uniformly distributed double in [0, 1).
+extern double next_double();
 extern std::string generate_string(uint64_t len);
+// Returns a string of `len` bytes, which is determined only by `id`.
+extern std::string generate_string(uint64_t len, uint64_t id);
 } // namespace test
 } // namespace pegasus
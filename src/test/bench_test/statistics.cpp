@@ -17,6 +17,7 @@
  * under the License.
  */
 
+#include <fstream>
 #include <unordered_map>
 #include <dsn/dist/fmt_logging.h>
 
@@ -26,7 +27,16 @@
 namespace pegasus {
 namespace test {
 std::unordered_map<operation_type, std::string, std::hash<unsigned char>> operation_type_string = {
-    {kUnknown, "unKnown"}, {kRead, "read"}, {kWrite, "write"}, {kDelete, "delete"}};
+    {kUnknown, "unKnown"},
+    {kRead, "read"},
+    {kWrite, "write"},
+    {kDelete, "delete"},
+    {kMultiGet, "multi_get"},
+    {kBatchGet, "batch_get"},
+    {kScan, "scan"},
+    {kIncr, "incr"},
+    {kCheckAndSet, "check_and_set"},
+    {kMixed, "mixed"}};
 
 statistics::statistics(std::shared_ptr<rocksdb::Statistics> hist_stats)
 {
@@ -54,6 +64,9 @@ void statistics::merge(const statistics &other)
     _start = std::min(other._start, _start);
     _finish = std::max(other._finish, _finish);
     this->add_message(other._message);
+    for (const auto &kv : other._latencies) {
+        _latencies[kv.first].merge(kv.second);
+    }
 }
 
 void statistics::stop() { _finish = config::instance().env->NowMicros(); }
@@ -80,9 +93,10 @@ void statistics::finished_ops(int64_t num_ops, enum operation_type op_type)
     if (_hist_stats) {
         _hist_stats->measureTime(op_type, micros);
     }
+    _latencies[op_type].record(micros);
 }
 
-void statistics::report(operation_type op_type)
+void statistics::report(const std::string &name, operation_type op_type)
 {
     // Pretend at least one op was done in case we are running a benchmark
     // that does not call finished_ops().
@@ -109,9 +123,57 @@ void statistics::report(operation_type op_type)
                static_cast<long>(_done / elapsed),
                extra);
 
-    // print histogram if _hist_stats is not NULL
+    // print histogram of each operation type if _hist_stats is not NULL
     if (_hist_stats) {
-        fmt::print(stdout, "{}\n", _hist_stats->getHistogramString(op_type));
+        for (const auto &kv : _latencies) {
+            if (_latencies.size() > 1) {
+                fmt::print(stdout, "{}:\n", operation_type_string[kv.first]);
+            }
+            fmt::print(stdout, "{}\n", _hist_stats->getHistogramString(kv.first));
+        }
+    }
+
+    if (!config::instance().histogram_output_file.empty()) {
+        write_histograms(name, elapsed);
+    }
+}
+
+void statistics::write_histograms(const std::string &name, double elapsed) const
+{
+    const std::string &path = config::instance().histogram_output_file;
+    bool json = config::instance().histogram_output_format == "json";
+    bool new_file = !std::ifstream(path).good();
+    std::ofstream out(path, std::ios::app);
+    if (!out) {
+        fmt::print(stderr, "open {} failed, skip writing histograms\n", path);
+        return;
+    }
+
+    // csv gets a header line, json is written as one object per line
+    if (new_file && !json) {
+        out << "benchmark,operation,count,ops_per_sec,min_us,mean_us,p50_us,p90_us,p99_us,"
+               "p999_us,p9999_us,max_us\n";
+    }
+    for (const auto &kv : _latencies) {
+        const latency_histogram &h = kv.second;
+        const char *fmt_str = json ? "{{\"benchmark\":\"{}\",\"operation\":\"{}\",\"count\":{},"
+                                     "\"ops_per_sec\":{:.1f},\"min_us\":{},\"mean_us\":{:.1f},"
+                                     "\"p50_us\":{},\"p90_us\":{},\"p99_us\":{},\"p999_us\":{},"
+                                     "\"p9999_us\":{},\"max_us\":{}}}\n"
+                                   : "{},{},{},{:.1f},{},{:.1f},{},{},{},{},{},{}\n";
+        out << fmt::format(fmt_str,
+                           name,
+                           operation_type_string[kv.first],
+                           h.count(),
+                           h.count() / elapsed,
+                           h.min(),
+                           h.mean(),
+                           h.value_at_percentile(50),
+                           h.value_at_percentile(90),
+                           h.value_at_percentile(99),
+                           h.value_at_percentile(99.9),
+                           h.value_at_percentile(99.99),
+                           h.max());
     }
 }
 
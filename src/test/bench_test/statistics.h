@@ -19,8 +19,10 @@
 
 #pragma once
 
+#include <map>
 #include <rocksdb/statistics.h>
 
+#include "histogram.h"
 #include "utils.h"
 
 namespace pegasus {
@@ -30,15 +32,20 @@ class statistics
 public:
     statistics(std::shared_ptr<rocksdb::Statistics> hist_stats);
     void start();
+    // Sets the time from which the latency of the next operation is measured, which is the
+    // finish time of the last operation by default.
+    void set_op_start(uint64_t start_micros) { _last_op_finish = start_micros; }
     void finished_ops(int64_t num_ops, enum operation_type op_type);
     void stop();
     void merge(const statistics &other);
-    void report(operation_type op_type);
+    void report(const std::string &name, operation_type op_type);
     void add_bytes(int64_t n);
     void add_message(const std::string &msg);
 
 private:
     uint32_t report_step(uint64_t current_report) const;
+    // Appends the latency percentiles of each operation type to histogram_output_file.
+    void write_histograms(const std::string &name, double elapsed) const;
 
     // the start time of benchmark
     uint64_t _start;
@@ -56,6 +63,8 @@ private:
     std::string _message;
     // histogram performance analyzer
     std::shared_ptr<rocksdb::Statistics> _hist_stats;
+    // latency histogram of each operation type, in micros
+    std::map<operation_type, latency_histogram> _latencies;
 };
 } // namespace test
 } // namespace pegasus
@@ -26,7 +26,14 @@ enum operation_type
     kUnknown = 0,
     kRead,
     kWrite,
-    kDelete
+    kDelete,
+    kMultiGet,
+    kBatchGet,
+    kScan,
+    kIncr,
+    kCheckAndSet,
+    // a mix of kRead and kWrite, only used to name the report
+    kMixed
 };
 } // namespace test
 } // namespace pegasus